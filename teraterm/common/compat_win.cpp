@@ -69,6 +69,7 @@ BOOL (WINAPI *pSetDefaultDllDirectories)(DWORD DirectoryFlags);
 BOOL (WINAPI *pSetDllDirectoryA)(LPCSTR lpPathName);
 static BOOL (WINAPI *pGetVersionExA)(LPOSVERSIONINFOA lpVersionInformation);
 LANGID (WINAPI *pGetUserDefaultUILanguage)(void);
+void (WINAPI *pGetSystemTimePreciseAsFileTime)(LPFILETIME lpSystemTimeAsFileTime);
 
 // gdi32
 int (WINAPI *pAddFontResourceExW)(LPCWSTR name, DWORD fl, PVOID res);
@@ -219,6 +220,7 @@ static const APIInfo Lists_kernel32[] = {
 	{ "SetDefaultDllDirectories", (void **)&pSetDefaultDllDirectories },
 	{ "SetDllDirectoryA", (void **)&pSetDllDirectoryA },
 	{ "GetUserDefaultUILanguage", (void **)&pGetUserDefaultUILanguage },
+	{ "GetSystemTimePreciseAsFileTime", (void **)&pGetSystemTimePreciseAsFileTime },
 	{},
 };
 
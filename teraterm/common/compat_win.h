@@ -172,6 +172,7 @@ BOOL _VerifyVersionInfoA(LPOSVERSIONINFOEXA lpVersionInformation, DWORD dwTypeMa
 extern BOOL (WINAPI *pSetDefaultDllDirectories)(DWORD DirectoryFlags);
 extern BOOL (WINAPI *pSetDllDirectoryA)(LPCSTR lpPathName);
 extern LANGID (WINAPI *pGetUserDefaultUILanguage)(void);
+extern void (WINAPI *pGetSystemTimePreciseAsFileTime)(LPFILETIME lpSystemTimeAsFileTime);
 
 #if !defined(LOAD_LIBRARY_SEARCH_SYSTEM32)
 #define LOAD_LIBRARY_SEARCH_SYSTEM32        0x00000800
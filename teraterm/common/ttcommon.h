@@ -60,6 +60,8 @@ DllExport void PASCAL UndoAllWin(void);
 
 DllExport int PASCAL CommReadRawByte(PComVar cv, LPBYTE b);
 DllExport int PASCAL CommRead1Byte(PComVar cv, LPBYTE b);
+DllExport int PASCAL CommPeekSpan(PComVar cv, const BYTE **ptr);
+DllExport void PASCAL CommSkipSpan(PComVar cv, int len);
 DllExport void PASCAL CommInsert1Byte(PComVar cv, BYTE b);
 DllExport int PASCAL CommRawOut(PComVar cv, PCHAR B, int C);
 DllExport int PASCAL CommBinaryOut(PComVar cv, PCHAR B, int C);
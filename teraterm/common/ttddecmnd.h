@@ -28,6 +28,12 @@
 
 #pragma once
 
+// }N(ttpmacro)̎MOobt@̃TCY
+#define DdeMacroRingBufSize (4096*4)
+// 񓯊[h Tera Term {̂1 DDE ]ő
+// }N̓Oobt@ȏ󂢂ĂΎ̃f[^󂯕t
+#define DdeMacroRCountLimit (DdeMacroRingBufSize/2)
+
 #define CmdSetHWnd          ' '
 #define CmdSetFile          '!'
 #define CmdSetBinary        '"'
@@ -617,6 +617,10 @@ struct tttset {
 	wchar_t *ViewlogEditorW;
 	wchar_t *ViewlogEditorArg;
 	WORD MessageBoxPosParentRelative;
+	int RecvBuffSize;
+	WORD LogRotateNaming;
+	WORD LogRotateCompress;
+	DWORD LogRotateMaxTotalSize;
 
 	// Experimental
 	BYTE ExperimentalTreeProprtySheetEnable;
@@ -789,8 +793,13 @@ typedef struct tttset TTTSet, *PTTSet;
 #define InBuffSize  1024
 #define OutBuffSize (1024*16)
 
+/* Mobt@TCY(RecvBuffSize)͈̔ */
+#define RecvBuffSizeMin     InBuffSize
+#define RecvBuffSizeMax     (1024*1024)
+#define RecvBuffSizeDefault (64*1024)
+
 typedef struct {
-	BYTE InBuff[InBuffSize];
+	BYTE reserve_InBuff[InBuffSize];	// InBuff ֈڍs
 	int InBuffCount, InPtr;
 	BYTE OutBuff[OutBuffSize];
 	int OutBuffCount, OutPtr;
@@ -883,6 +892,14 @@ typedef struct {
 
 	void *StateSend;
 	void *StateEcho;
+
+	void (*LogBin)(const BYTE *b, int len);
+
+	/* Mobt@(Oobt@)
+	 *	InBuff[InPtr]  InBuffCount oCg̃f[^
+	 *	InBuffMax 𒴂擪ɖ߂ */
+	BYTE *InBuff;
+	int InBuffMax;
 } TComVar;
 typedef TComVar *PComVar;
 
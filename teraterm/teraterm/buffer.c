@@ -49,35 +49,49 @@
 #include "buffer.h"
 #include "asprintf.h"
 #include "ttcstd.h"
+#include "ttlib.h"
 
 #define	ENABLE_CELL_INDEX	0
 
 // obt@̔p1̏
+//	XN[obt@ s x  mۂ邽߁A1Z͏ۂ
+//	(64bit ł 12byte)
+//	Rrl[V͏opxႢ̂ŃZ̊O(CombTable)ɒu
 typedef struct {
-	char32_t u32;
-	char32_t u32_last;
-	char WidthProperty;				// 'W' or 'F' or 'H' or 'A' or 'n'(Narrow) or 'N'(Neutual) (̑)
-	char cell;			// cell 1/2/3+=p,Sp,3ȏ
-						// 2ȏ̂ƂǍ̕paddingcell-1
-	char Padding;					// TRUE = Sp̎̋lߕ or s̋lߕ
-	char Emoji;						// TRUE = G
-	unsigned char CombinationCharCount16;	// charactor count
-	unsigned char CombinationCharSize16;		// buffer size
-	unsigned char CombinationCharCount32;
-	unsigned char CombinationCharSize32;
-	wchar_t *pCombinationChars16;
-	char32_t *pCombinationChars32;
-	wchar_t	wc2[2];
+	unsigned int u32 : 21;			//  (U+0000 - U+10FFFF)
+	unsigned int cell : 8;			// cell 1/2/3+=p,Sp,3ȏ
+									// 2ȏ̂ƂǍ̕paddingcell-1
+	unsigned int Padding : 1;		// TRUE = Sp̎̋lߕ or s̋lߕ
+	unsigned int Emoji : 1;			// TRUE = G
+	unsigned int Combination : 1;	// TRUE = CombTable ɃRrl[V
 	unsigned char fg;
 	unsigned char bg;
 	unsigned char attr;
 	unsigned char attr2;
 	unsigned short ansi_char;
+	char WidthProperty;				// 'W' or 'F' or 'H' or 'A' or 'n'(Narrow) or 'N'(Neutual) (̑)
 #if ENABLE_CELL_INDEX
 	int idx;	// Zʂԍ
 #endif
 } buff_char_t;
 
+// Rrl[V
+//	Z̃AhXL[ƂnbVe[uŊǗ
+typedef struct combination_tag {
+	const buff_char_t *key;
+	struct combination_tag *next;
+	unsigned char CombinationCharCount16;	// charactor count
+	unsigned char CombinationCharSize16;		// buffer size
+	unsigned char CombinationCharCount32;
+	unsigned char CombinationCharSize32;
+	wchar_t *pCombinationChars16;
+	char32_t *pCombinationChars32;
+} combination_t;
+
+static combination_t **CombTable;
+static size_t CombTableSize;	// 2ׂ̂
+static size_t CombCount;
+
 #define BuffXMax TermWidthMax
 //#define BuffYMax 100000
 //#define BuffSizeMax 8000000
@@ -103,6 +117,8 @@ static buff_char_t *CodeBuffW;
 static LONG LinePtr;
 static LONG BufferSize;
 static int NumOfLinesInBuff;
+static int NumOfColumnsInBuff;	// 1s̊mۃZ(>=NumOfColumns)
+								// NumOfColumns ȍ~̃Z͏ɋ
 static int BuffStartAbs, BuffEndAbs;
 
 // I
@@ -160,43 +176,106 @@ static buff_char_t *GetPtrRel(buff_char_t *CodeBuffW_, size_t BufferSize_, buff_
 	return p;
 }
 
-static void FreeCombinationBuf(buff_char_t *b)
+static size_t CombHash(const buff_char_t *b)
+{
+	return ((size_t)b / sizeof(buff_char_t)) & (CombTableSize - 1);
+}
+
+/**
+ *	Z̃Rrl[V擾
+ *	@retval	NULL	Rrl[VȂ
+ */
+static combination_t *GetCombination(const buff_char_t *b)
 {
-	if (b->pCombinationChars16 != NULL) {
-		free(b->pCombinationChars16);
-		b->pCombinationChars16 = NULL;
+	combination_t *c;
+	if (!b->Combination) {
+		return NULL;
+	}
+	for (c = CombTable[CombHash(b)]; c != NULL; c = c->next) {
+		if (c->key == b) {
+			return c;
+		}
 	}
-	b->CombinationCharSize16 = 0;
-	b->CombinationCharCount16 = 0;
+	assert(FALSE);
+	return NULL;
+}
+
+/**
+ *	Z̃Rrl[Vmۂ
+ *	łɂƂ͂Ԃ
+ */
+static combination_t *AllocCombination(buff_char_t *b)
+{
+	combination_t *c;
+	size_t h;
 
-	if (b->pCombinationChars32 != NULL) {
-		free(b->pCombinationChars32);
-		b->pCombinationChars32 = NULL;
+	if (b->Combination) {
+		return GetCombination(b);
 	}
-	b->CombinationCharSize32 = 0;
-	b->CombinationCharCount32 = 0;
+
+	if (CombCount >= CombTableSize) {
+		// e[ug傷
+		size_t new_size = CombTableSize == 0 ? 256 : CombTableSize * 2;
+		combination_t **new_table = calloc(new_size, sizeof(combination_t *));
+		size_t i;
+		if (new_table == NULL) {
+			return NULL;
+		}
+		for (i = 0; i < CombTableSize; i++) {
+			c = CombTable[i];
+			while (c != NULL) {
+				combination_t *next = c->next;
+				h = ((size_t)c->key / sizeof(buff_char_t)) & (new_size - 1);
+				c->next = new_table[h];
+				new_table[h] = c;
+				c = next;
+			}
+		}
+		free(CombTable);
+		CombTable = new_table;
+		CombTableSize = new_size;
+	}
+
+	c = calloc(1, sizeof(*c));
+	if (c == NULL) {
+		return NULL;
+	}
+	c->key = b;
+	h = CombHash(b);
+	c->next = CombTable[h];
+	CombTable[h] = c;
+	CombCount++;
+	b->Combination = TRUE;
+	return c;
 }
 
-static void DupCombinationBuf(buff_char_t *b)
+static void FreeCombinationBuf(buff_char_t *b)
 {
-	size_t size;
+	combination_t **pp;
 
-	size = b->CombinationCharSize16;
-	if (size > 0) {
-		wchar_t *new_buf = malloc(sizeof(wchar_t) * size);
-		memcpy(new_buf, b->pCombinationChars16, sizeof(wchar_t) * size);
-		b->pCombinationChars16 = new_buf;
+	if (!b->Combination) {
+		return;
 	}
-	size = b->CombinationCharSize32;
-	if (size > 0) {
-		char32_t *new_buf = malloc(sizeof(char32_t) * size);
-		memcpy(new_buf, b->pCombinationChars32, sizeof(char32_t) * size);
-		b->pCombinationChars32 = new_buf;
+	b->Combination = FALSE;
+
+	for (pp = &CombTable[CombHash(b)]; *pp != NULL; pp = &(*pp)->next) {
+		combination_t *c = *pp;
+		if (c->key == b) {
+			*pp = c->next;
+			free(c->pCombinationChars16);
+			free(c->pCombinationChars32);
+			free(c);
+			CombCount--;
+			return;
+		}
 	}
+	assert(FALSE);
 }
 
 static void CopyCombinationBuf(buff_char_t *dest, const buff_char_t *src)
 {
+	const combination_t *src_c;
+
 	FreeCombinationBuf(dest);
 
 	// \̂Rs[
@@ -207,39 +286,108 @@ static void CopyCombinationBuf(buff_char_t *dest, const buff_char_t *src)
 #if ENABLE_CELL_INDEX
 	dest->idx = idx;
 #endif
+	dest->Combination = FALSE;
+
+	src_c = GetCombination(src);
+	if (src_c != NULL) {
+		combination_t *c = AllocCombination(dest);
+		if (c != NULL) {
+			size_t size;
+
+			size = src_c->CombinationCharSize16;
+			if (size > 0) {
+				c->pCombinationChars16 = malloc(sizeof(wchar_t) * size);
+				memcpy(c->pCombinationChars16, src_c->pCombinationChars16, sizeof(wchar_t) * size);
+				c->CombinationCharSize16 = src_c->CombinationCharSize16;
+				c->CombinationCharCount16 = src_c->CombinationCharCount16;
+			}
+			size = src_c->CombinationCharSize32;
+			if (size > 0) {
+				c->pCombinationChars32 = malloc(sizeof(char32_t) * size);
+				memcpy(c->pCombinationChars32, src_c->pCombinationChars32, sizeof(char32_t) * size);
+				c->CombinationCharSize32 = src_c->CombinationCharSize32;
+				c->CombinationCharCount32 = src_c->CombinationCharCount32;
+			}
+		}
+	}
+}
 
-	DupCombinationBuf(dest);
+/**
+ *	Rrl[V(UTF-16)擾
+ *	@param[out]	count	
+ *	@retval		Rrl[V, count==0 ̂Ƃ NULL
+ */
+static const wchar_t *GetCombinationChars16(const buff_char_t *b, size_t *count)
+{
+	const combination_t *c = GetCombination(b);
+	if (c == NULL || c->CombinationCharCount16 == 0) {
+		*count = 0;
+		return NULL;
+	}
+	*count = c->CombinationCharCount16;
+	return c->pCombinationChars16;
 }
 
-static void BuffSetChar2(buff_char_t *buff, char32_t u32, char property, BOOL half_width, char emoji)
+/**
+ *	Rrl[V(UTF-32)擾
+ */
+static const char32_t *GetCombinationChars32(const buff_char_t *b, size_t *count)
 {
-	size_t wstr_len;
-	buff_char_t *p = buff;
+	const combination_t *c = GetCombination(b);
+	if (c == NULL || c->CombinationCharCount32 == 0) {
+		*count = 0;
+		return NULL;
+	}
+	*count = c->CombinationCharCount32;
+	return c->pCombinationChars32;
+}
 
-	FreeCombinationBuf(p);
-	p->WidthProperty = property;
-	p->cell = half_width ? 1 : 2;
-	p->u32 = u32;
-	p->u32_last = u32;
-	p->Padding = FALSE;
-	p->Emoji = emoji;
-	p->fg = AttrDefaultFG;
-	p->bg = AttrDefaultBG;
+/**
+ *	Z̍Ō̕(Rrl[VƂ͍Ō̌)
+ */
+static char32_t GetU32Last(const buff_char_t *b)
+{
+	size_t count;
+	const char32_t *p32 = GetCombinationChars32(b, &count);
+	if (count == 0) {
+		return b->u32;
+	}
+	return p32[count - 1];
+}
 
-	//
-	wstr_len = UTF32ToUTF16(u32, &p->wc2[0], 2);
+/**
+ *	ꕶUTF-16ɂ
+ *	@param[out]	wc2		wc2[1] ̓TQ[gyAłȂƂ 0
+ */
+static void GetWC2(const buff_char_t *b, wchar_t *wc2)
+{
+	size_t wstr_len = UTF32ToUTF16(b->u32, &wc2[0], 2);
 	switch (wstr_len) {
 	case 0:
 	default:
-		p->wc2[0] = 0;
-		p->wc2[1] = 0;
+		wc2[0] = 0;
+		wc2[1] = 0;
 		break;
 	case 1:
-		p->wc2[1] = 0;
+		wc2[1] = 0;
 		break;
 	case 2:
 		break;
 	}
+}
+
+static void BuffSetChar2(buff_char_t *buff, char32_t u32, char property, BOOL half_width, char emoji)
+{
+	buff_char_t *p = buff;
+
+	FreeCombinationBuf(p);
+	p->WidthProperty = property;
+	p->cell = half_width ? 1 : 2;
+	p->u32 = u32;
+	p->Padding = FALSE;
+	p->Emoji = emoji;
+	p->fg = AttrDefaultFG;
+	p->bg = AttrDefaultBG;
 
 	if (u32 < 0x80) {
 		p->ansi_char = (unsigned short)u32;
@@ -290,8 +438,12 @@ static void BuffSetChar(buff_char_t *buff, char32_t u32, char property)
  */
 static void BuffAddChar(buff_char_t *buff, char32_t u32)
 {
-	buff_char_t *p = buff;
-	assert(p->u32 != 0);
+	combination_t *p;
+	assert(buff->u32 != 0);
+	p = AllocCombination(buff);
+	if (p == NULL) {
+		return;
+	}
 	// ɑ̈g傷
 	if (p->CombinationCharSize16 < p->CombinationCharCount16 + 2) {
 		size_t new_size = p->CombinationCharSize16;
@@ -318,7 +470,6 @@ static void BuffAddChar(buff_char_t *buff, char32_t u32)
 
 	// UTF-32
 	if (p->CombinationCharCount32 < p->CombinationCharSize32) {
-		p->u32_last = u32;
 		p->pCombinationChars32[(size_t)p->CombinationCharCount32] = u32;
 		p->CombinationCharCount32++;
 	}
@@ -412,7 +563,7 @@ static LONG GetLinePtr(int Line)
 {
 	LONG Ptr;
 
-	Ptr = (LONG)(BuffStartAbs + Line) * (LONG)(NumOfColumns);
+	Ptr = (LONG)(BuffStartAbs + Line) * (LONG)(NumOfColumnsInBuff);
 	while (Ptr>=BufferSize) {
 		Ptr = Ptr - BufferSize;
 	}
@@ -421,7 +572,7 @@ static LONG GetLinePtr(int Line)
 
 static LONG NextLinePtr(LONG Ptr)
 {
-	Ptr = Ptr + (LONG)NumOfColumns;
+	Ptr = Ptr + (LONG)NumOfColumnsInBuff;
 	if (Ptr >= BufferSize) {
 		Ptr = Ptr - BufferSize;
 	}
@@ -430,7 +581,7 @@ static LONG NextLinePtr(LONG Ptr)
 
 static LONG PrevLinePtr(LONG Ptr)
 {
-	Ptr = Ptr - (LONG)NumOfColumns;
+	Ptr = Ptr - (LONG)NumOfColumnsInBuff;
 	if (Ptr < 0) {
 		Ptr = Ptr + BufferSize;
 	}
@@ -443,8 +594,8 @@ static LONG PrevLinePtr(LONG Ptr)
 static void GetPosFromPtr(const buff_char_t *b, int *bx, int *by)
 {
 	size_t index = b - CodeBuffW;
-	int x = (int)(index % NumOfColumns);
-	int y = (int)(index / NumOfColumns);
+	int x = (int)(index % NumOfColumnsInBuff);
+	int y = (int)(index / NumOfColumnsInBuff);
 	if (y >= BuffStartAbs) {
 		y -= BuffStartAbs;
 	}
@@ -455,10 +606,35 @@ static void GetPosFromPtr(const buff_char_t *b, int *bx, int *by)
 	*by = y;
 }
 
+/**
+ *	mۍς݂̍s͈͓̔ŌύX
+ *	obt@̍蒼As̃Rs[͍sȂ
+ */
+static void ChangeBufferWidth(int Nx)
+{
+	int i;
+	LONG Ptr;
+
+	if (Nx < NumOfColumns) {
+		// ȂȂZ󔒂ɂ
+		Ptr = 0;
+		for (i = 0; i < NumOfLinesInBuff; i++) {
+			memsetW(&CodeBuffW[Ptr + Nx], 0x20, AttrDefaultFG, AttrDefaultBG, AttrDefault, AttrDefault, NumOfColumns - Nx);
+			if (CodeBuffW[Ptr + Nx - 1].attr & AttrKanji) {
+				BuffSetChar(&CodeBuffW[Ptr + Nx - 1], ' ', 'H');
+				CodeBuffW[Ptr + Nx - 1].attr ^= AttrKanji;
+			}
+			Ptr += NumOfColumnsInBuff;
+		}
+	}
+	// LƂ́ANumOfColumns ȍ~̃Z͋󔒂Ȃ̂ł̂܂
+}
+
 static BOOL ChangeBuffer(int Nx, int Ny)
 {
 	LONG NewSize;
 	int NxCopy, NyCopy, i;
+	int NxAlloc;
 	LONG SrcPtr, DestPtr;
 	WORD LockOld;
 	buff_char_t *CodeDestW;
@@ -477,7 +653,25 @@ static BOOL ChangeBuffer(int Nx, int Ny)
 		Ny = BuffSizeMax / Nx;
 	}
 
-	NewSize = (LONG)Nx * (LONG)Ny;
+	if (CodeBuffW != NULL && Ny == NumOfLinesInBuff && Nx <= NumOfColumnsInBuff) {
+		// sŊmۍς݂̍sɎ܂
+		ChangeBufferWidth(Nx);
+		return TRUE;
+	}
+
+	NxAlloc = Nx;
+	if (CodeBuffW != NULL && Nx > NumOfColumnsInBuff) {
+		// LƂAčL悤]Ɋmۂ
+		NxAlloc = Nx + Nx / 4;
+		if (NxAlloc > BuffXMax) {
+			NxAlloc = BuffXMax;
+		}
+		if ((LONG)NxAlloc * (LONG)Ny > BuffSizeMax) {
+			NxAlloc = Nx;
+		}
+	}
+
+	NewSize = (LONG)NxAlloc * (LONG)Ny;
 
 	CodeDestW = NULL;
 	CodeDestW = malloc(NewSize * sizeof(buff_char_t));
@@ -520,7 +714,7 @@ static BOOL ChangeBuffer(int Nx, int Ny)
 				CodeDestW[DestPtr+NxCopy-1].attr ^= AttrKanji;
 			}
 			SrcPtr = NextLinePtr(SrcPtr);
-			DestPtr = DestPtr + (LONG)Nx;
+			DestPtr = DestPtr + (LONG)NxAlloc;
 		}
 		FreeBuffer();
 	}
@@ -550,6 +744,7 @@ static BOOL ChangeBuffer(int Nx, int Ny)
 	CodeBuffW = CodeDestW;
 	BufferSize = NewSize;
 	NumOfLinesInBuff = Ny;
+	NumOfColumnsInBuff = NxAlloc;
 	BuffStartAbs = 0;
 	BuffEnd = NyCopy;
 
@@ -648,7 +843,7 @@ void FreeBuffer(void)
 {
 	int i;
 
-	for (i = 0; i < NumOfColumns * NumOfLinesInBuff; i++) {
+	for (i = 0; i < BufferSize; i++) {
 		FreeCombinationBuf(&CodeBuffW[i]);
 	}
 
@@ -1765,9 +1960,11 @@ static wchar_t *BuffGetStringForCB(int sx, int sy, int ex, int ey, BOOL box_sele
 		while (x < IEnd) {
 			const buff_char_t *b = &CodeBuffW[TmpPtr + x];
 			if (b->u32 != 0) {
-				str_w[k++] = b->wc2[0];
-				if (b->wc2[1] != 0) {
-					str_w[k++] = b->wc2[1];
+				wchar_t wc2[2];
+				GetWC2(b, wc2);
+				str_w[k++] = wc2[0];
+				if (wc2[1] != 0) {
+					str_w[k++] = wc2[1];
 				}
 				if (k + 2 >= str_size) {
 					str_size *= 2;
@@ -1776,12 +1973,14 @@ static wchar_t *BuffGetStringForCB(int sx, int sy, int ex, int ey, BOOL box_sele
 				{
 					int i;
 					// Rrl[V
-					if (k + b->CombinationCharCount16 >= str_size) {
-						str_size += + b->CombinationCharCount16;
+					size_t count16;
+					const wchar_t *comb16 = GetCombinationChars16(b, &count16);
+					if (k + count16 >= str_size) {
+						str_size += + count16;
 						str_w = realloc(str_w, sizeof(wchar_t) * str_size);
 					}
-					for (i = 0 ; i < (int)b->CombinationCharCount16; i++) {
-						str_w[k++] = b->pCombinationChars16[i];
+					for (i = 0 ; i < (int)count16; i++) {
+						str_w[k++] = comb16[i];
 					}
 				}
 			}
@@ -1826,6 +2025,9 @@ static wchar_t *BuffGetStringForCB(int sx, int sy, int ex, int ey, BOOL box_sele
 static size_t expand_wchar(const buff_char_t *b, wchar_t *buf, size_t buf_size, BOOL *too_samll)
 {
 	size_t len;
+	wchar_t wc2[2];
+	size_t count16;
+	const wchar_t *comb16;
 
 	if (IsBuffPadding(b)) {
 		if (too_samll != NULL) {
@@ -1835,8 +2037,10 @@ static size_t expand_wchar(const buff_char_t *b, wchar_t *buf, size_t buf_size,
 	}
 
 	// 𑪂
+	GetWC2(b, wc2);
+	comb16 = GetCombinationChars16(b, &count16);
 	len = 0;
-	if (b->wc2[1] == 0) {
+	if (wc2[1] == 0) {
 		// TQ[gyAł͂Ȃ
 		len++;
 	} else {
@@ -1844,7 +2048,7 @@ static size_t expand_wchar(const buff_char_t *b, wchar_t *buf, size_t buf_size,
 		len += 2;
 	}
 	// Rrl[V
-	len += b->CombinationCharCount16;
+	len += count16;
 
 	if (buf == NULL) {
 		// Ԃ
@@ -1864,12 +2068,12 @@ static size_t expand_wchar(const buff_char_t *b, wchar_t *buf, size_t buf_size,
 	}
 
 	// WJĂ
-	*buf++ = b->wc2[0];
-	if (b->wc2[1] != 0) {
-		*buf++ = b->wc2[1];
+	*buf++ = wc2[0];
+	if (wc2[1] != 0) {
+		*buf++ = wc2[1];
 	}
-	if (b->CombinationCharCount16 != 0) {
-		memcpy(buf, b->pCombinationChars16, b->CombinationCharCount16 * sizeof(wchar_t));
+	if (count16 != 0) {
+		memcpy(buf, comb16, count16 * sizeof(wchar_t));
 	}
 
 	return len;
@@ -1888,12 +2092,16 @@ static size_t expand_wchar(const buff_char_t *b, wchar_t *buf, size_t buf_size,
 static size_t MatchOneStringPtr(const buff_char_t *b, const wchar_t *str, size_t len)
 {
 	int match_pos = 0;
+	wchar_t wc2[2];
+	size_t count16;
+	const wchar_t *comb16;
 	if (len == 0) {
 		return 0;
 	}
-	if (b->wc2[1] == 0) {
+	GetWC2(b, wc2);
+	if (wc2[1] == 0) {
 		// TQ[gyAł͂Ȃ
-		if (str[match_pos] != b->wc2[0]) {
+		if (str[match_pos] != wc2[0]) {
 			return 0;
 		}
 		match_pos++;
@@ -1903,25 +2111,26 @@ static size_t MatchOneStringPtr(const buff_char_t *b, const wchar_t *str, size_t
 		if (len < 2) {
 			return 0;
 		}
-		if (str[match_pos+0] != b->wc2[0] ||
-			str[match_pos+1] != b->wc2[1]) {
+		if (str[match_pos+0] != wc2[0] ||
+			str[match_pos+1] != wc2[1]) {
 			return 0;
 		}
 		match_pos+=2;
 		len-=2;
 	}
-	if (b->CombinationCharCount16 > 0) {
+	comb16 = GetCombinationChars16(b, &count16);
+	if (count16 > 0) {
 		// Rrl[V
 		int i;
-		if (len < b->CombinationCharCount16) {
+		if (len < count16) {
 			return 0;
 		}
-		for (i = 0 ; i < (int)b->CombinationCharCount16; i++) {
-			if (str[match_pos++] != b->pCombinationChars16[i]) {
+		for (i = 0 ; i < (int)count16; i++) {
+			if (str[match_pos++] != comb16[i]) {
 				return 0;
 			}
 		}
-		len -= b->CombinationCharCount16;
+		len -= count16;
 	}
 	return match_pos;
 }
@@ -2335,8 +2544,9 @@ static BOOL BuffIsHalfWidthFromPropery(const TTTSet *ts_, char width_property)
 
 static BOOL BuffIsHalfWidthFromCode(const TTTSet *ts_, unsigned int u32, char *width_property, char *emoji)
 {
-	*width_property = UnicodeGetWidthProperty(u32);
-	*emoji = (char)UnicodeIsEmoji(u32);
+	const unsigned char prop = UnicodeGetProperty(u32);
+	*width_property = UnicodeWidthPropertyFromProperty(prop);
+	*emoji = (prop & UNICODE_PROP_EMOJI) != 0 ? 1 : 0;
 	if (ts_->UnicodeEmojiOverride) {
 		if (*emoji) {
 			// Gꍇ
@@ -2472,23 +2682,38 @@ static void mark_url_line_w(int cur_x, int cur_y)
 	const buff_char_t *b;
 
 	// URL̐擪T
-	TmpPtr = GetLinePtr(PageStart + cur_y) + cur_x - 1;	// J[\ʒu|C^
-	while ((CodeBuffW[TmpPtr].attr & AttrURL) != 0) {
-		if (TmpPtr == 0) {
+	//	s̊mە NumOfColumns 傫Ƃ̂ŁAsƂɂǂ
+	sx = cur_x - 1;
+	sy = PageStart + cur_y;
+	if (sx < 0) {
+		if (sy > 0) {
+			sx = NumOfColumns - 1;
+			sy--;
+		}
+		else {
+			sx = 0;
+		}
+	}
+	TmpPtr = GetLinePtr(sy);
+	while ((CodeBuffW[TmpPtr + sx].attr & AttrURL) != 0) {
+		if (sx > 0) {
+			sx--;
+		}
+		else if (sy > 0) {
+			sx = NumOfColumns - 1;
+			sy--;
+			TmpPtr = PrevLinePtr(TmpPtr);
+		}
+		else {
 			break;
 		}
-		TmpPtr--;
 	}
-	TmpPtr++;
-
-	// |C^J[\ʒu
-	GetPosFromPtr(&CodeBuffW[TmpPtr], &sx, &sy);
-	if (sy >= PageStart) {
-		sy = sy - PageStart;
-	} else {
-		sy = sy - PageStart;
-		sy = sy + NumOfLinesInBuff;
+	sx++;
+	if (sx == NumOfColumns) {
+		sx = 0;
+		sy++;
 	}
+	sy = sy - PageStart;
 
 	// sT
 	ex = NumOfColumns - 1;
@@ -2746,20 +2971,25 @@ static void mark_url_w(int cur_x, int cur_y)
  */
 static wchar_t *GetWCS(const buff_char_t *b)
 {
-	size_t len = (b->wc2[1] == 0) ? 2 : 3;
+	size_t len;
 	wchar_t *strW;
 	wchar_t *p;
 	int i;
+	wchar_t wc2[2];
+	size_t count16;
+	const wchar_t *comb16 = GetCombinationChars16(b, &count16);
 
-	len += b->CombinationCharCount16;
+	GetWC2(b, wc2);
+	len = (wc2[1] == 0) ? 2 : 3;
+	len += count16;
 	strW = malloc(sizeof(wchar_t) * len);
 	p = strW;
-	*p++ = b->wc2[0];
-	if (b->wc2[1] != 0) {
-		*p++ = b->wc2[1];
+	*p++ = wc2[0];
+	if (wc2[1] != 0) {
+		*p++ = wc2[1];
 	}
-	for (i=0; i<b->CombinationCharCount16; i++) {
-		*p++ = b->pCombinationChars16[i];
+	for (i=0; i<(int)count16; i++) {
+		*p++ = comb16[i];
 	}
 	*p = L'\0';
 	return strW;
@@ -2784,6 +3014,7 @@ static buff_char_t *IsCombiningChar(int x, int y, BOOL wrap, unsigned int u32, i
 	LONG LinePtr_ = GetLinePtr(PageStart+y);
 	buff_char_t *CodeLineW = &CodeBuffW[LinePtr_];
 	int combine_type;	// 0 or 1 or 2
+	char32_t u32_last;
 
 	combine_type = (u32 == 0x200d) ? 1 : 0;		// U+200d = [ڍq,ZERO WIDTH JOINER(ZWJ)
 	if (combine_type == 0) {
@@ -2826,17 +3057,18 @@ static buff_char_t *IsCombiningChar(int x, int y, BOOL wrap, unsigned int u32, i
 
 	// ?
 	// 		1O ZWJ
-	if (combine_type != 0 || (p->u32_last == 0x200d)) {
+	u32_last = GetU32Last(p);
+	if (combine_type != 0 || (u32_last == 0x200d)) {
 		return p;
 	}
 
 	// B[}
-	if (UnicodeIsVirama(p->u32_last) != 0) {
+	if (UnicodeIsVirama(u32_last) != 0) {
 		// 1ÕB[}Ɠ block ̕ł
-		int block_index_last = UnicodeBlockIndex(p->u32_last);
+		int block_index_last = UnicodeBlockIndex(u32_last);
 		int block_index = UnicodeBlockIndex(u32);
 #if 0
-		OutputDebugPrintf("U+%06x, %d, %s\n", p->u32_last, block_index_last, UnicodeBlockName(block_index_last));
+		OutputDebugPrintf("U+%06x, %d, %s\n", u32_last, block_index_last, UnicodeBlockName(block_index_last));
 		OutputDebugPrintf("U+%06x, %d, %s\n", u32, block_index, UnicodeBlockName(block_index));
 #endif
 		if (block_index_last == block_index) {
@@ -2954,7 +3186,7 @@ int BuffPutUnicode(unsigned int u32, TCharAttr Attr, BOOL Insert)
 
 		// ͕́ANonspacing mark ȊO?
 		//		J[\+1, +1
-		if (p->u32_last != 0x200d && combining_type != 1) {
+		if (GetU32Last(p) != 0x200d && combining_type != 1) {
 			// J[\ړʂ1
 			move_x = 1;
 
@@ -3356,30 +3588,35 @@ void BuffGetDrawInfoW(int SY, int IStart, int IEnd,
 		}
 
 		if (SetString) {
+			wchar_t wc2[2];
+			size_t count16;
+			const wchar_t *comb16;
+			GetWC2(b, wc2);
 			if (b->u32 < 0x10000) {
-				bufW[lenW] = b->wc2[0];
+				bufW[lenW] = wc2[0];
 				bufWW[lenW] = b->cell;
 				lenW++;
 			} else {
 				// UTF-16ŃTQ[gyA
-				bufW[lenW] = b->wc2[0];
+				bufW[lenW] = wc2[0];
 				bufWW[lenW] = 0;
 				lenW++;
-				bufW[lenW] = b->wc2[1];
+				bufW[lenW] = wc2[1];
 				bufWW[lenW] = b->cell;
 				lenW++;
 			}
-			if (b->CombinationCharCount16 != 0) {
+			comb16 = GetCombinationChars16(b, &count16);
+			if (count16 != 0) {
 				// Rrl[V
 				int i;
 				const char cell_tmp = bufWW[lenW - 1];
 				bufWW[lenW - 1] = 0;
-				for (i = 0; i < (int)b->CombinationCharCount16; i++) {
-					bufW[lenW + i] = b->pCombinationChars16[i];
+				for (i = 0; i < (int)count16; i++) {
+					bufW[lenW + i] = comb16[i];
 					bufWW[lenW + i] = 0;
 				}
-				bufWW[lenW + b->CombinationCharCount16 - 1] = cell_tmp;
-				lenW += b->CombinationCharCount16;
+				bufWW[lenW + count16 - 1] = cell_tmp;
+				lenW += (int)count16;
 				DrawFlag = TRUE;  // Rrl[Vꍇ͂`
 			}
 
@@ -5806,21 +6043,25 @@ wchar_t *BuffGetCharInfo(int Xw, int Yw)
 		wchar_t *codes_ptr = NULL;
 		wchar_t *code_str;
 		int i;
+		wchar_t wc2[2];
+		size_t count16;
+		const wchar_t *comb16 = GetCombinationChars16(b, &count16);
 
+		GetWC2(b, wc2);
 		aswprintf(&code_str,
 				  L"Unicode UTF-16:\n"
 				  L" 0x%04x\n",
-				  b->wc2[0]);
+				  wc2[0]);
 		awcscat(&codes_ptr, code_str);
 		free(code_str);
-		if (b->wc2[1] != 0 ) {
+		if (wc2[1] != 0 ) {
 			wchar_t buf[32];
-			swprintf(buf, _countof(buf), L" 0x%04x\n", b->wc2[1]);
+			swprintf(buf, _countof(buf), L" 0x%04x\n", wc2[1]);
 			awcscat(&codes_ptr, buf);
 		}
-		for (i=0; i<b->CombinationCharCount16; i++) {
+		for (i=0; i<(int)count16; i++) {
 			wchar_t buf[32];
-			swprintf(buf, _countof(buf), L" 0x%04x\n", b->pCombinationChars16[i]);
+			swprintf(buf, _countof(buf), L" 0x%04x\n", comb16[i]);
 			awcscat(&codes_ptr, buf);
 		}
 		unicode_utf16_str = codes_ptr;
@@ -5831,13 +6072,15 @@ wchar_t *BuffGetCharInfo(int Xw, int Yw)
 		wchar_t *codes_ptr = NULL;
 		wchar_t *code_str;
 		int i;
+		size_t count32;
+		const char32_t *comb32 = GetCombinationChars32(b, &count32);
 
 		awcscat(&codes_ptr, L"Unicode UTF-32:\n");
 		code_str = UnicodeCodePointStr(b->u32);
 		awcscats(&codes_ptr, L" ", code_str, L"\n", NULL);
 		free(code_str);
-		for (i=0; i<b->CombinationCharCount32; i++) {
-			code_str = UnicodeCodePointStr(b->pCombinationChars32[i]);
+		for (i=0; i<(int)count32; i++) {
+			code_str = UnicodeCodePointStr(comb32[i]);
 			awcscats(&codes_ptr, L" ", code_str, L"\n", NULL);
 			free(code_str);
 		}
@@ -903,6 +903,61 @@ void ParseFirst(CharSetData *w, BYTE b)
 		w->Op.PutU32(b, w->ClientData);
 }
 
+/**
+ *	ParseFirst() ̕oCg
+ *	UTF-8 ̂ƂA䕶̎O܂ł̕܂Ƃ߂ď
+ *
+ *	@param	ptr		Mf[^
+ *	@param	len		Mf[^
+ *	@return	oCg
+ *			0 ̂Ƃ ParseFirst() 1byte邱
+ */
+size_t ParseFirstSpan(CharSetData *w, const BYTE *ptr, size_t len)
+{
+	size_t i;
+
+	if (w->DebugFlag != DEBUG_FLAG_NONE || w->SSflag || w->Fallbacked) {
+		return 0;
+	}
+
+	switch (ts.Language) {
+	case IdUtf8:
+		break;
+	case IdJapanese:
+	case IdKorean:
+	case IdChinese:
+		if (ts.KanjiCode == IdUTF8) {
+			break;
+		}
+		return 0;
+	default:
+		return 0;
+	}
+
+	for (i = 0; i < len; i++) {
+		const BYTE b = ptr[i];
+		if (IsC0(b)) {
+			// 䕶 ParseFirst() ŏ
+			break;
+		}
+		if (w->count == 0 && b <= 0x7f) {
+			w->Op.PutU32(b, w->ClientData);
+			continue;
+		}
+		if (w->count == 1 && w->buf[0] == 0xc2 && IsC1(b)) {
+			// C1䕶ɂȂ̂ ParseFirst() ŏ
+			break;
+		}
+		ParseFirstUTF8(w, b);
+		if (w->Fallbacked) {
+			// Shift_JIS  fallback 
+			i++;
+			break;
+		}
+	}
+	return i;
+}
+
 /**
  *	w(Designate)
  *
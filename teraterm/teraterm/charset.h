@@ -48,6 +48,7 @@ typedef struct CharSetOpTag {
 
 // input
 void ParseFirst(CharSetData *w, BYTE b);
+size_t ParseFirstSpan(CharSetData *w, const BYTE *ptr, size_t len);
 
 // control
 typedef enum {
@@ -32,6 +32,7 @@
 #include <winsock2.h>
 #include <ws2tcpip.h>
 #include <stdio.h> /* for _snprintf() */
+#include <stdlib.h>
 #include <time.h>
 #include <process.h>
 
@@ -120,6 +121,11 @@ static HANDLE HAsync=0;
 
 BOOL TCPIPClosed = TRUE;
 
+/* M̓v */
+static DWORD RecvCallCount;		// recv(),ReadFile()̌Ăяo
+static unsigned __int64 RecvByteCount;
+static BOOL RecvStatReport;		// ؒfɓvo͂ (ts.Debug)
+
 /* Printer port handle for
    direct pass-thru printing */
 static HANDLE PrnID = INVALID_HANDLE_VALUE;
@@ -144,6 +150,69 @@ void CommInit(PComVar cv)
 	cv->ConnectedTime = 0;
 }
 
+/**
+ *	Mobt@mۂ
+ *	TCYςĂȂƂ͍ėp
+ */
+static void CommAllocInBuff(PTTSet ts, PComVar cv)
+{
+	int size = ts->RecvBuffSize;
+	if (size < RecvBuffSizeMin || size > RecvBuffSizeMax) {
+		size = RecvBuffSizeDefault;
+	}
+
+	cv->InBuffCount = 0;
+	cv->InPtr = 0;
+	if (cv->InBuff != NULL && cv->InBuffMax == size) {
+		return;
+	}
+
+	free(cv->InBuff);
+	cv->InBuff = (BYTE *)malloc(size);
+	if (cv->InBuff == NULL) {
+		size = InBuffSize;
+		cv->InBuff = (BYTE *)malloc(size);
+	}
+	cv->InBuffMax = cv->InBuff != NULL ? size : 0;
+}
+
+static void CommFreeInBuff(PComVar cv)
+{
+	free(cv->InBuff);
+	cv->InBuff = NULL;
+	cv->InBuffMax = 0;
+	cv->InBuffCount = 0;
+	cv->InPtr = 0;
+}
+
+/**
+ *	Mobt@̋󂫗̈̂AAĂ镔Ԃ
+ *
+ *	@param	ptr		󂫗̈̐擪
+ *	@return	A󂫗̈̃oCg
+ */
+static int InBuffFreeSpan(PComVar cv, BYTE **ptr)
+{
+	int tail = cv->InPtr + cv->InBuffCount;
+	int len;
+	if (tail >= cv->InBuffMax) {
+		// ̃f[^܂ԂĂ
+		tail -= cv->InBuffMax;
+		len = cv->InPtr - tail;
+	}
+	else {
+		len = cv->InBuffMax - tail;
+	}
+	*ptr = &cv->InBuff[tail];
+	return len;
+}
+
+static void CommRecvStat(DWORD C)
+{
+	RecvCallCount++;
+	RecvByteCount += C;
+}
+
 /* reset a serial port which is already open */
 void CommResetSerial(PTTSet ts, PComVar cv, BOOL ClearBuff)
 {
@@ -292,8 +361,10 @@ void CommOpen(HWND HW, PTTSet ts, PComVar cv)
 	}
 
 	/* initialize ComVar */
-	cv->InBuffCount = 0;
-	cv->InPtr = 0;
+	CommAllocInBuff(ts, cv);
+	RecvCallCount = 0;
+	RecvByteCount = 0;
+	RecvStatReport = ts->Debug;
 	cv->OutBuffCount = 0;
 	cv->OutPtr = 0;
 	cv->HWin = HW;
@@ -830,8 +901,7 @@ void CommClose(PComVar cv)
 	/* disable event message posting & flush buffer */
 	cv->RRQ = FALSE;
 	cv->Ready = FALSE;
-	cv->InPtr = 0;
-	cv->InBuffCount = 0;
+	CommFreeInBuff(cv);
 	cv->OutPtr = 0;
 	cv->OutBuffCount = 0;
 	cv->LineModeBuffCount = 0;
@@ -886,6 +956,12 @@ void CommClose(PComVar cv)
 	}
 	cv->ComID = INVALID_HANDLE_VALUE;
 	cv->PortType = 0;
+
+	if (RecvStatReport && RecvByteCount > 0) {
+		const double mb = (double)RecvByteCount / (1024.0 * 1024.0);
+		OutputDebugPrintf("%s: recv %.1f MB, %lu calls (%.1f calls/MB)\n", __FUNCTION__,
+						  mb, RecvCallCount, RecvCallCount / mb);
+	}
 }
 
 void CommProcRRQ(PComVar cv)
@@ -911,34 +987,32 @@ void CommReceive(PComVar cv)
 {
 	DWORD C;
 	DWORD DErr;
+	BYTE *ptr;
+	int len;
 
 	if (! cv->Ready || ! cv->RRQ ||
-	    (cv->InBuffCount>=InBuffSize)) {
+	    (cv->InBuffCount>=cv->InBuffMax)) {
 		return;
 	}
 
-	/* Compact buffer */
-	if ((cv->InBuffCount>0) && (cv->InPtr>0)) {
-		memmove(cv->InBuff,&(cv->InBuff[cv->InPtr]),cv->InBuffCount);
-		cv->InPtr = 0;
-	}
-
-	if (cv->InBuffCount<InBuffSize) {
+	/* Oobt@̘A󂫗̈֓ǂݍ */
+	len = InBuffFreeSpan(cv, &ptr);
+	if (len > 0) {
 		switch (cv->PortType) {
 			case IdTCPIP:
-				C = Precv(cv->s, &(cv->InBuff[cv->InBuffCount]),
-				          InBuffSize-cv->InBuffCount, 0);
+				C = Precv(cv->s, ptr, len, 0);
 				if (C == SOCKET_ERROR) {
 					C = 0;
 					PWSAGetLastError();
 				}
+				CommRecvStat(C);
 				cv->InBuffCount = cv->InBuffCount + C;
 				break;
 			case IdSerial:
 				do {
 					ClearCommError(cv->ComID,&DErr,NULL);
-					if (! PReadFile(cv->ComID,&(cv->InBuff[cv->InBuffCount]),
-					                InBuffSize-cv->InBuffCount,&C,&rol)) {
+					len = InBuffFreeSpan(cv, &ptr);
+					if (! PReadFile(cv->ComID,ptr,len,&C,&rol)) {
 						if (GetLastError() == ERROR_IO_PENDING) {
 							if (WaitForSingleObject(rol.hEvent, 1000) != WAIT_OBJECT_0) {
 								C = 0;
@@ -951,13 +1025,14 @@ void CommReceive(PComVar cv)
 							C = 0;
 						}
 					}
+					CommRecvStat(C);
 					cv->InBuffCount = cv->InBuffCount + C;
-				} while ((C!=0) && (cv->InBuffCount<InBuffSize));
+				} while ((C!=0) && (cv->InBuffCount<cv->InBuffMax));
 				ClearCommError(cv->ComID,&DErr,NULL);
 				break;
 			case IdFile:
-				if (PReadFile(cv->ComID,&(cv->InBuff[cv->InBuffCount]),
-				              InBuffSize-cv->InBuffCount,&C,NULL)) {
+				if (PReadFile(cv->ComID,ptr,len,&C,NULL)) {
+					CommRecvStat(C);
 					if (C == 0) {
 						DErr = ERROR_HANDLE_EOF;
 					}
@@ -973,8 +1048,8 @@ void CommReceive(PComVar cv)
 			case IdNamedPipe:
 				// L[̒ɍŒ1oCgȏ̃f[^Ă邱ƂmFłĂ邽߁A
 				// ReadFile() ̓ubN邱Ƃ͂Ȃ߁AꊇēǂށB
-				if (PReadFile(cv->ComID,&(cv->InBuff[cv->InBuffCount]),
-				              InBuffSize-cv->InBuffCount,&C,NULL)) {
+				if (PReadFile(cv->ComID,ptr,len,&C,NULL)) {
+					CommRecvStat(C);
 					if (C == 0) {
 						DErr = ERROR_HANDLE_EOF;
 					}
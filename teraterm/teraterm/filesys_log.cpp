@@ -28,6 +28,7 @@
 
 /* TERATERM.EXE, log routines */
 #include <stdio.h>
+#include <string.h>
 #if !defined(_CRTDBG_MAP_ALLOC)
 #define _CRTDBG_MAP_ALLOC
 #endif
@@ -51,7 +52,9 @@
 #include "codeconv.h"
 #include "asprintf.h"
 #include "win32helper.h"
+#include "compat_win.h"
 
+#include "logarchive.h"
 #include "filesys_log_res.h"
 #include "filesys_log.h"
 #include "filesys.h"  // for ProtoGetProtoFlag()
@@ -68,6 +71,26 @@ enum enumLineEnd {
 	Line_FileHead = 2,
 };
 
+/*
+   ^CX^ṽLbV
+   bςƂAb̌(%N, %f)͂̈ʒu
+*/
+#define TIMESTAMP_MAX		128
+#define TIMESTAMP_FRAC_MAX	4
+typedef struct {
+	int type;							// ts.LogTimestampType, -1 ̂Ƃ쐬
+	ULONGLONG sec;						// (b)
+	char format[sizeof(ts.LogTimestampFormat)];	// Ɏg LogTimestampFormat
+	char str[TIMESTAMP_MAX];			// "[<>] "
+	size_t len;
+	BOOL ascii;							// str  ASCII ݂̂
+	struct {
+		unsigned char pos;				// str ̈ʒu
+		unsigned char digits;			// 3(~b) ܂ 6(}CNb)
+	} frac[TIMESTAMP_FRAC_MAX];
+	int frac_count;
+} TimeStampCache;
+
 typedef struct {
 	wchar_t *FullName;
 
@@ -82,10 +105,23 @@ typedef struct {
 	int RotateMode;  //  enum rotate_mode RotateMode;
 	LONG RotateSize;
 	int RotateStep;
+	LONG FileBytes;					// ݂̃t@C̃TCY, t@C֏ރXbhXV
+	int RotateSeq;					// LogRotateNaming=1 ̍Ō̘A, -1 ̂Ƃ擾
+	LogArchive_t *Archive;			// k,폜p[J[
+	volatile LONG ReopenError;		// [e[gɃt@CJȂ
 
+	// x
 	HANDLE LogThread;
-	DWORD LogThreadId;
-	HANDLE LogThreadEvent;
+	HANDLE LogThreadEvent;			// ݃XbhN(Zbg)
+	volatile LONG LogThreadQuit;
+	char *WriteRing;				// ݃Xbh֓nOobt@
+	volatile LONG WriteHead;		// i[ʒu, [Xbĥ݂XV
+	volatile LONG WriteTail;		// oʒu, ݃Xbĥ݂XV
+
+	// v
+	DWORD DropCount;				// Oobt@ӂŎ̂ĂoCg
+	DWORD StallCount;				// Oobt@ɓ肫Ȃ
+	DWORD WriteCount;				// ݃Xbh WriteFile() 
 
 	BOOL IsPause;
 
@@ -96,28 +132,35 @@ typedef struct {
 
 	BOOL FileLog;
 	BOOL BinLog;
+
+	TimeStampCache TimeStamp;
 } TFileVar;
 typedef TFileVar *PFileVar;
 
 static PFileVar LogVar = NULL;
 
+static int cv_LogBufSize;			// cv_LogBuf, cv_BinBuf ̃TCY
 static PCHAR cv_LogBuf;
 static int cv_LogPtr, cv_LStart, cv_LCount;
 static PCHAR cv_BinBuf;
 static int cv_BinPtr, cv_BStart, cv_BCount;
 static int cv_BinSkip;
 
-// xݗpXbh̃bZ[W
-#define WM_DPC_LOGTHREAD_SEND (WM_APP + 1)
+// xݗpOobt@
+#define LOG_WRITE_RING_SIZE	(1024*1024)		// 2ׂ̂
+#define LOG_WRITE_BATCH		(64*1024)		// ꂾ܂珑݃XbhN
+#define LOG_WRITE_INTERVAL	100				// ܂ȂĂ̎(ms)ŏ
 
 static void Log1Bin(BYTE b);
+static void LogBin(const BYTE *b, int len);
 static void LogBinSkip(int add);
 static BOOL CreateLogBuf(void);
 static BOOL CreateBinBuf(void);
 void LogPut1(BYTE b);
 static void OutputStr(const wchar_t *str);
 static void LogToFile(PFileVar fv);
-static void FLogOutputBOM(PFileVar fv);
+static DWORD FLogOutputBOM(PFileVar fv);
+static void LogRotate(PFileVar fv);
 
 static BOOL OpenFTDlg_(PFileVar fv)
 {
@@ -254,84 +297,114 @@ static void FixLogOption(void)
 // Xbh̏Iƃt@C̃N[Y
 static void CloseFileSync(PFileVar fv)
 {
-	BOOL ret;
-
-	if (fv->FileHandle == INVALID_HANDLE_VALUE) {
-		return;
-	}
-
+	// [e[g̎sŃt@CĂĂAXbh͎~߂
 	if (fv->LogThread != INVALID_HANDLE_VALUE) {
-		// Xbh̏I҂
-		ret = PostThreadMessage(fv->LogThreadId, WM_QUIT, 0, 0);
-		if (ret != 0) {
-			// XbhL[ɃGL[łꍇ̂ݑ҂킹sB
-			WaitForSingleObject(fv->LogThread, INFINITE);
-		}
-		else {
-			//DWORD code = GetLastError();
-		}
+		// Oobt@ɎcĂ镪oĂXbhI
+		InterlockedExchange(&fv->LogThreadQuit, 1);
+		SetEvent(fv->LogThreadEvent);
+		WaitForSingleObject(fv->LogThread, INFINITE);
 		CloseHandle(fv->LogThread);
 		fv->LogThread = INVALID_HANDLE_VALUE;
+		CloseHandle(fv->LogThreadEvent);
+		fv->LogThreadEvent = NULL;
 	}
-	CloseHandle(fv->FileHandle);
-	fv->FileHandle = INVALID_HANDLE_VALUE;
+	if (fv->FileHandle != INVALID_HANDLE_VALUE) {
+		CloseHandle(fv->FileHandle);
+		fv->FileHandle = INVALID_HANDLE_VALUE;
+	}
+}
+
+/**
+ *	XbhԂŋLʒu̓ǂݏo
+ *	Xbh InterlockedExchange() ŏlǂ
+ */
+static inline DWORD RingLoad(volatile LONG *p)
+{
+	return (DWORD)InterlockedCompareExchange(p, 0, 0);
 }
 
-// xݗpXbh
+/**
+ *	xݗpXbh
+ *
+ *	[Xbh WriteRing ֊i[f[^A܂Ƃ߂ăt@C֏
+ *	(҂ LOG_WRITE_BATCH, LOG_WRITE_INTERVAL Q)
+ *	- 񂾌̃O[e[g̃Xbhōs
+ *	- WriteHead ͒[XbhAWriteTail ͂̃XbhXV̂
+ *	  bN͕sv
+ */
 static unsigned _stdcall DeferredLogWriteThread(void *arg)
 {
-	MSG msg;
 	PFileVar fv = (PFileVar)arg;
-	PCHAR buf;
-	DWORD buflen;
-	DWORD wrote;
-
-	PeekMessage(&msg, NULL, 0, 0, PM_NOREMOVE);
+	DWORD tail = RingLoad(&fv->WriteTail);
+
+	for (;;) {
+		// IvOɊi[ꂽf[^͕Ko߁A
+		// quit ɓǂł head ǂ
+		BOOL quit = RingLoad(&fv->LogThreadQuit) != 0;
+		DWORD head = RingLoad(&fv->WriteHead);
+		if (!quit && head - tail < LOG_WRITE_BATCH) {
+			WaitForSingleObject(fv->LogThreadEvent, LOG_WRITE_INTERVAL);
+			quit = RingLoad(&fv->LogThreadQuit) != 0;
+			head = RingLoad(&fv->WriteHead);
+		}
 
-	// XbhL[̍쐬IƂXbh֒ʒmB
-	if (fv->LogThreadEvent != NULL) {
-		SetEvent(fv->LogThreadEvent);
-	}
+		while (head != tail) {
+			DWORD ofs = tail & (LOG_WRITE_RING_SIZE - 1);
+			DWORD len = head - tail;
+			if (len > LOG_WRITE_RING_SIZE - ofs) {
+				len = LOG_WRITE_RING_SIZE - ofs;
+			}
+			if (fv->FileHandle != INVALID_HANDLE_VALUE) {
+				DWORD wrote;
+				WriteFile(fv->FileHandle, &fv->WriteRing[ofs], len, &wrote, NULL);
+			}
+			fv->WriteCount++;
+			tail += len;
+			InterlockedExchange(&fv->WriteTail, (LONG)tail);
 
-	while (GetMessage(&msg, NULL, 0, 0) > 0) {
-		switch (msg.message) {
-			case WM_DPC_LOGTHREAD_SEND:
-				buf = (PCHAR)msg.wParam;
-				buflen = (DWORD)msg.lParam;
-				WriteFile(fv->FileHandle, buf, buflen, &wrote, NULL);
-				free(buf);   // Ń
-				break;
+			fv->FileBytes += len;
+			LogRotate(fv);
+		}
 
-			case WM_QUIT:
-				goto end;
-				break;
+		if (quit) {
+			break;
 		}
 	}
 
-end:
 	_endthreadex(0);
 	return (0);
 }
 
-// xݗpXbhNB
-// (2013.4.19 yutaka)
-// DeferredLogWriteThread XbhNāAXbhL[쐬OɁA
-// Ot@C̃N[Y(CloseFileSync)sƁAGL[sAfbhbN
-// ƂCB
-// XbhԂ̓s߁AOȂCxgIuWFNggāAXbhL[
-// 쐬܂ő҂킹悤ɂBOtCxgIuWFNggꍇ́A
-// VXe(Windows OS)Ńj[NȖOɂKvB
-// (2016.9.23 yutaka)
+/**
+ *	xݗpXbhN
+ *	Xbh쐬łȂƂ LogThread  INVALID_HANDLE_VALUE ̂܂܂ƂȂA
+ *	[XbhŒڏ
+ */
 static void StartThread(PFileVar fv)
 {
 	unsigned tid;
-	fv->LogThreadEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
-	fv->LogThread = (HANDLE)_beginthreadex(NULL, 0, DeferredLogWriteThread, fv, 0, &tid);
-	fv->LogThreadId = tid;
-	if (fv->LogThreadEvent != NULL) {
-		WaitForSingleObject(fv->LogThreadEvent, INFINITE);
+	HANDLE thread;
+
+	if (fv->WriteRing == NULL) {
+		fv->WriteRing = (char *)malloc(LOG_WRITE_RING_SIZE);
+		if (fv->WriteRing == NULL) {
+			return;
+		}
+	}
+	fv->WriteHead = 0;
+	fv->WriteTail = 0;
+	fv->LogThreadQuit = 0;
+	fv->LogThreadEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+	if (fv->LogThreadEvent == NULL) {
+		return;
+	}
+	thread = (HANDLE)_beginthreadex(NULL, 0, DeferredLogWriteThread, fv, 0, &tid);
+	if (thread == 0) {
 		CloseHandle(fv->LogThreadEvent);
+		fv->LogThreadEvent = NULL;
+		return;
 	}
+	fv->LogThread = thread;
 }
 
 static void OpenLogFile(PFileVar fv)
@@ -412,6 +485,9 @@ static BOOL LogStart(PFileVar fv, const wchar_t *fname)
 	else {
 		fv->ByteCount = 0;
 	}
+	fv->FileBytes = fv->ByteCount;
+	fv->RotateSeq = -1;
+	fv->TimeStamp.type = -1;
 
 	if (! OpenFTDlg_(fv)) {
 		return FALSE;
@@ -429,6 +505,7 @@ static BOOL LogStart(PFileVar fv, const wchar_t *fname)
 	}
 	if (fv->BinLog) {
 		cv.Log1Bin = Log1Bin;
+		cv.LogBin = LogBin;
 		cv.LogBinSkip = LogBinSkip;
 	}
 
@@ -471,14 +548,16 @@ void LogPut1(BYTE b)
 
 	cv_LogBuf[cv_LogPtr] = b;
 	cv_LogPtr++;
-	if (cv_LogPtr>=InBuffSize)
-		cv_LogPtr = cv_LogPtr-InBuffSize;
+	if (cv_LogPtr>=cv_LogBufSize)
+		cv_LogPtr = cv_LogPtr-cv_LogBufSize;
 
 	if (fv->FileLog)
 	{
-		if (cv_LCount>=InBuffSize)
+		if (cv_LCount>=cv_LogBufSize)
 		{
-			cv_LCount = InBuffSize;
+			// łÂf[^㏑
+			fv->DropCount++;
+			cv_LCount = cv_LogBufSize;
 			cv_LStart = cv_LogPtr;
 		}
 		else
@@ -488,19 +567,6 @@ void LogPut1(BYTE b)
 		cv_LCount = 0;
 }
 
-static BOOL Get1(PCHAR Buf, int *Start, int *Count, PBYTE b)
-{
-	if (*Count<=0) return FALSE;
-	*b = Buf[*Start];
-	(*Start)++;
-	if (*Start>=InBuffSize)
-		*Start = *Start-InBuffSize;
-	(*Count)--;
-	return TRUE;
-}
-
-
-
 static CRITICAL_SECTION g_filelog_lock;   /* bNpϐ */
 
 void logfile_lock_initialize(void)
@@ -518,31 +584,14 @@ static inline void logfile_unlock(void)
 	LeaveCriticalSection(&g_filelog_lock);
 }
 
-// O[e[gB
+// ゲƂɃl[ (LogRotateNaming=0)
+// name.1 ŐVAname.<RotateStep> ŌÂƂȂ
 // (2013.3.21 yutaka)
-static void LogRotate(PFileVar fv)
+static void RotateRename(PFileVar fv)
 {
 	int loopmax = 10000;  // XXX
 	int i, k;
 
-	if (fv->RotateMode == ROTATE_NONE)
-		return;
-
-	if (fv->RotateMode == ROTATE_SIZE) {
-		if (fv->ByteCount <= fv->RotateSize)
-			return;
-		//OutputDebugPrintf("%s: mode %d size %ld\n", __FUNCTION__, fv->RotateMode, fv->ByteCount);
-	} else {
-		return;
-	}
-
-	logfile_lock();
-	// OTCYďB
-	fv->ByteCount = 0;
-
-	// 񍡂̃t@CN[YāAʖ̃t@CI[vB
-	CloseFileSync(fv);
-
 	// ネ[e[ṼXebv̎w肪邩
 	if (fv->RotateStep > 0)
 		loopmax = fv->RotateStep;
@@ -576,46 +625,351 @@ static void LogRotate(PFileVar fv)
 		free(oldfile);
 		free(newfile);
 	}
+}
+
+// AԂtăl[ (LogRotateNaming=1)
+// ȑÕt@C̓l[ȂBkƌÂt@C̍폜̓[J[ōs
+static void RotateSequence(PFileVar fv)
+{
+	if (fv->RotateSeq < 0) {
+		fv->RotateSeq = LogArchiveGetLastSeq(fv->FullName);
+	}
+	fv->RotateSeq++;
 
-	// ăI[v
+	wchar_t *newfile = LogArchiveGetSegmentName(fv->FullName, fv->RotateSeq);
+	BOOL r = MoveFileExW(fv->FullName, newfile, MOVEFILE_REPLACE_EXISTING);
+	free(newfile);
+	if (r == 0) {
+		OutputDebugPrintf("%s: rename %lu\n", __FUNCTION__, GetLastError());
+		return;
+	}
+
+	if (fv->Archive == NULL) {
+		fv->Archive = LogArchiveCreate(fv->FullName, ts.LogRotateCompress, ts.LogRotateMaxTotalSize);
+	}
+	if (fv->Archive != NULL) {
+		LogArchiveAdd(fv->Archive, fv->RotateSeq, fv->RotateStep);
+	}
+}
+
+// O[e[gB
+// t@C֏ރXbh(xݎ͏݃Xbh)
+// ݂̂тɌĂ΂̂ŁA[Xbh~߂Ȃ
+static void LogRotate(PFileVar fv)
+{
+	if (fv->RotateMode != ROTATE_SIZE) {
+		return;
+	}
+	if (fv->FileBytes <= fv->RotateSize) {
+		return;
+	}
+
+	// 񍡂̃t@CN[YāAʖɂĂăI[vB
+	CloseHandle(fv->FileHandle);
+	if (ts.LogRotateNaming == 0) {
+		RotateRename(fv);
+	}
+	else {
+		RotateSequence(fv);
+	}
 	OpenLogFile(fv);
-	if (fv->bom) {
-		FLogOutputBOM(fv);
+	if (fv->FileHandle == INVALID_HANDLE_VALUE) {
+		// O~߂̂͒[Xbhōs (FLogWriteFile())
+		fv->RotateMode = ROTATE_NONE;
+		InterlockedExchange(&fv->ReopenError, 1);
+		return;
 	}
-	if (ts.DeferredLogWriteMode) {
-		StartThread(fv);
+
+	// l[łȂƂ͏㏑ǋL
+	DWORD pos = SetFilePointer(fv->FileHandle, 0, NULL, FILE_END);
+	fv->FileBytes = (pos == INVALID_SET_FILE_POINTER) ? 0 : (LONG)pos;
+	if (fv->FileBytes == 0 && fv->bom) {
+		fv->FileBytes = FLogOutputBOM(fv);
 	}
+}
 
-	logfile_unlock();
+/**
+ *	^CX^v1ڒǉ
+ */
+static void TimeStampAdd(TimeStampCache *c, const char *s)
+{
+	while (*s != 0 && c->len < TIMESTAMP_MAX - 3) {	// "] "  NUL ̕c
+		c->str[c->len++] = *s++;
+	}
+}
+
+/**
+ *	b̌̏ꏊmۂ
+ *	l TimeStampStr() Ŗ񏑂
+ */
+static void TimeStampAddFrac(TimeStampCache *c, int digits)
+{
+	if (c->frac_count >= TIMESTAMP_FRAC_MAX || c->len + digits > TIMESTAMP_MAX - 3) {
+		return;
+	}
+	c->frac[c->frac_count].pos = (unsigned char)c->len;
+	c->frac[c->frac_count].digits = (unsigned char)digits;
+	c->frac_count++;
+	TimeStampAdd(c, digits == 3 ? "000" : "000000");
+}
+
+/**
+ *	LogTimestampFormat ɏ]ĕb܂ł
+ *	mctimelocal() ƓɉA%f Ń}CNbo͂
+ */
+static void TimeStampFormatTime(TimeStampCache *c, const SYSTEMTIME *st)
+{
+	static const char week[][4] = {
+		"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"
+	};
+	static const char month[][4] = {
+		"Jan", "Feb", "Mar", "Apr", "May", "Jun",
+		"Jul", "Aug", "Sep", "Oct", "Nov", "Dec"
+	};
+	const char *format = c->format;
+	char tmp[8];
+
+	for (size_t i = 0; format[i] != 0; i++) {
+		if (format[i] != '%' || format[i + 1] == 0) {
+			tmp[0] = format[i];
+			tmp[1] = 0;
+			TimeStampAdd(c, tmp);
+			continue;
+		}
+		i++;
+		switch (format[i]) {
+		case 'a':
+			TimeStampAdd(c, week[st->wDayOfWeek]);
+			break;
+		case 'b':
+			TimeStampAdd(c, month[st->wMonth - 1]);
+			break;
+		case 'd':
+			_snprintf_s(tmp, sizeof(tmp), _TRUNCATE, "%02d", st->wDay);
+			TimeStampAdd(c, tmp);
+			break;
+		case 'e':
+			_snprintf_s(tmp, sizeof(tmp), _TRUNCATE, "%2d", st->wDay);
+			TimeStampAdd(c, tmp);
+			break;
+		case 'H':
+			_snprintf_s(tmp, sizeof(tmp), _TRUNCATE, "%02d", st->wHour);
+			TimeStampAdd(c, tmp);
+			break;
+		case 'N':
+			TimeStampAddFrac(c, 3);
+			break;
+		case 'f':
+			TimeStampAddFrac(c, 6);
+			break;
+		case 'm':
+			_snprintf_s(tmp, sizeof(tmp), _TRUNCATE, "%02d", st->wMonth);
+			TimeStampAdd(c, tmp);
+			break;
+		case 'M':
+			_snprintf_s(tmp, sizeof(tmp), _TRUNCATE, "%02d", st->wMinute);
+			TimeStampAdd(c, tmp);
+			break;
+		case 'S':
+			_snprintf_s(tmp, sizeof(tmp), _TRUNCATE, "%02d", st->wSecond);
+			TimeStampAdd(c, tmp);
+			break;
+		case 'w':
+			_snprintf_s(tmp, sizeof(tmp), _TRUNCATE, "%d", st->wDayOfWeek);
+			TimeStampAdd(c, tmp);
+			break;
+		case 'Y':
+			_snprintf_s(tmp, sizeof(tmp), _TRUNCATE, "%04d", st->wYear);
+			TimeStampAdd(c, tmp);
+			break;
+		case '%':
+			TimeStampAdd(c, "%");
+			break;
+		default:
+			// sȎw͂̂܂܏o͂
+			tmp[0] = '%';
+			tmp[1] = format[i];
+			tmp[2] = 0;
+			TimeStampAdd(c, tmp);
+			break;
+		}
+	}
 }
 
-static wchar_t *TimeStampStr(PFileVar fv)
+/**
+ *	LbV蒼
+ *	@param	sec		local/UTC ̂Ƃ FILETIME ̕b, oߎԂ̂Ƃ͌oߕb
+ */
+static void TimeStampUpdate(TimeStampCache *c, int type, ULONGLONG sec)
 {
-	char *strtime = NULL;
-	switch (ts.LogTimestampType) {
+	c->type = type;
+	c->sec = sec;
+	strncpy_s(c->format, sizeof(c->format), ts.LogTimestampFormat, _TRUNCATE);
+	c->len = 0;
+	c->frac_count = 0;
+
+	TimeStampAdd(c, "[");
+	switch (type) {
 	case TIMESTAMP_LOCAL:
-	default:
-		strtime = mctimelocal(ts.LogTimestampFormat, FALSE);
-		break;
 	case TIMESTAMP_UTC:
-		strtime = mctimelocal(ts.LogTimestampFormat, TRUE);
+	default: {
+		ULONGLONG t = sec * 10000000;
+		FILETIME ft;
+		SYSTEMTIME utc, local;
+		ft.dwLowDateTime = (DWORD)t;
+		ft.dwHighDateTime = (DWORD)(t >> 32);
+		FileTimeToSystemTime(&ft, &utc);
+		if (type == TIMESTAMP_UTC) {
+			TimeStampFormatTime(c, &utc);
+		}
+		else {
+			SystemTimeToTzSpecificLocalTime(NULL, &utc, &local);
+			TimeStampFormatTime(c, &local);
+		}
 		break;
+	}
 	case TIMESTAMP_ELAPSED_LOGSTART:
-		strtime = strelapsed(fv->StartTime);
+	case TIMESTAMP_ELAPSED_CONNECTED: {
+		// strelapsed() Ɠ
+		char tmp[32];
+		_snprintf_s(tmp, sizeof(tmp), _TRUNCATE, "%d %02d:%02d:%02d.",
+					(int)(sec / (24 * 60 * 60)), (int)(sec / (60 * 60) % 24), (int)(sec / 60 % 60), (int)(sec % 60));
+		TimeStampAdd(c, tmp);
+		TimeStampAddFrac(c, 3);
 		break;
-	case TIMESTAMP_ELAPSED_CONNECTED:
-		strtime = strelapsed(cv.ConnectedTime);
+	}
+	}
+	c->str[c->len++] = ']';
+	c->str[c->len++] = ' ';
+	c->str[c->len] = 0;
+
+	c->ascii = TRUE;
+	for (size_t i = 0; i < c->len; i++) {
+		if ((BYTE)c->str[i] >= 0x80) {
+			c->ascii = FALSE;
+			break;
+		}
+	}
+}
+
+/**
+ *	^CX^vԂ
+ *	̓LbVɂǍĂяo܂ŗL
+ */
+static const char *TimeStampStr(PFileVar fv, size_t *len)
+{
+	TimeStampCache *c = &fv->TimeStamp;
+	int type = ts.LogTimestampType;
+	ULONGLONG sec;
+	DWORD sub;		// b, 100nsP
+
+	switch (type) {
+	case TIMESTAMP_LOCAL:
+	case TIMESTAMP_UTC:
+	default: {
+		FILETIME ft;
+		if (pGetSystemTimePreciseAsFileTime != NULL) {
+			pGetSystemTimePreciseAsFileTime(&ft);
+		}
+		else {
+			GetSystemTimeAsFileTime(&ft);
+		}
+		ULONGLONG t = ((ULONGLONG)ft.dwHighDateTime << 32) | ft.dwLowDateTime;
+		sec = t / 10000000;
+		sub = (DWORD)(t % 10000000);
 		break;
 	}
+	case TIMESTAMP_ELAPSED_LOGSTART:
+	case TIMESTAMP_ELAPSED_CONNECTED: {
+		DWORD start = (type == TIMESTAMP_ELAPSED_LOGSTART) ? fv->StartTime : cv.ConnectedTime;
+		DWORD delta = GetTickCount() - start;
+		sec = delta / 1000;
+		sub = (delta % 1000) * 10000;
+		break;
+	}
+	}
 
-	char tmp[128];
-	tmp[0] = 0;
-	strncat_s(tmp, sizeof(tmp), "[", _TRUNCATE);
-	strncat_s(tmp, sizeof(tmp), strtime, _TRUNCATE);
-	strncat_s(tmp, sizeof(tmp), "] ", _TRUNCATE);
-	free(strtime);
+	if (c->type != type || c->sec != sec || strcmp(c->format, ts.LogTimestampFormat) != 0) {
+		TimeStampUpdate(c, type, sec);
+	}
+
+	for (int i = 0; i < c->frac_count; i++) {
+		int digits = c->frac[i].digits;
+		DWORD v = (digits == 3) ? sub / 10000 : sub / 10;
+		char *p = &c->str[c->frac[i].pos + digits];
+		while (digits-- > 0) {
+			*--p = (char)('0' + v % 10);
+			v /= 10;
+		}
+	}
+
+	*len = c->len;
+	return c->str;
+}
+
+/**
+ *	ASCIIOobt@֏
+ */
+static void LogPutAscii(PFileVar fv, const char *str, size_t len)
+{
+	for (size_t i = 0; i < len; i++) {
+		BYTE b = (BYTE)str[i];
+		switch (fv->log_code) {
+		case LOG_UTF8:
+		default:
+			LogPut1(b);
+			break;
+		case LOG_UTF16LE:
+			LogPut1(b);
+			LogPut1(0);
+			break;
+		case LOG_UTF16BE:
+			LogPut1(0);
+			LogPut1(b);
+			break;
+		}
+	}
+}
+
+/**
+ *	t@C֏
+ *	xݎ͏݃Xbh̃Oobt@֊i[
+ *
+ *	@return	(i[)oCg
+ *			Oobt@ɋ󂫂ȂƂ len 菬Ȃ
+ */
+static int LogWrite(PFileVar fv, const char *buf, int len)
+{
+	if (fv->LogThread == INVALID_HANDLE_VALUE) {
+		if (fv->FileHandle != INVALID_HANDLE_VALUE) {
+			DWORD wrote;
+			WriteFile(fv->FileHandle, buf, len, &wrote, NULL);
+		}
+		fv->FileBytes += len;
+		LogRotate(fv);
+		return len;
+	}
 
-	return ToWcharA(tmp);
+	DWORD head = fv->WriteHead;
+	DWORD used = head - RingLoad(&fv->WriteTail);
+	DWORD n = LOG_WRITE_RING_SIZE - used;
+	if (n > (DWORD)len) {
+		n = len;
+	}
+	DWORD ofs = head & (LOG_WRITE_RING_SIZE - 1);
+	DWORD n1 = LOG_WRITE_RING_SIZE - ofs;
+	if (n1 > n) {
+		n1 = n;
+	}
+	memcpy(&fv->WriteRing[ofs], buf, n1);
+	memcpy(&fv->WriteRing[0], buf + n1, n - n1);
+	InterlockedExchange(&fv->WriteHead, (LONG)(head + n));
+
+	if (used < LOG_WRITE_BATCH && used + n >= LOG_WRITE_BATCH) {
+		// ܂̂ŏ݃XbhN
+		SetEvent(fv->LogThreadEvent);
+	}
+	return (int)n;
 }
 
 /**
@@ -625,7 +979,6 @@ static void LogToFile(PFileVar fv)
 {
 	PCHAR Buf;
 	int Start, Count;
-	BYTE b;
 
 	if (fv->FileLog)
 	{
@@ -648,34 +1001,30 @@ static void LogToFile(PFileVar fv)
 	// bN(2004.8.6 yutaka)
 	logfile_lock();
 
-	// ݃f[^쐬
-	DWORD WriteBufMax = 8192;
-	DWORD WriteBufLen = 0;
-	PCHAR WriteBuf = (PCHAR)malloc(WriteBufMax);
-	while (Get1(Buf,&Start,&Count,&b)) {
-		if (FLogIsPause() || ProtoGetProtoFlag()) {
-			continue;
-		}
-
-		if (WriteBufLen >= (WriteBufMax*4/5)) {
-			WriteBufMax *= 2;
-			WriteBuf = (PCHAR)realloc(WriteBuf, WriteBufMax);
-		}
-
-		WriteBuf[WriteBufLen++] = b;
-
-		(fv->ByteCount)++;
+	if (FLogIsPause() || ProtoGetProtoFlag()) {
+		// ܂Ɏ̂Ă
+		Start = (Start + Count) % cv_LogBufSize;
+		Count = 0;
 	}
 
-	// 
-	if (WriteBufLen > 0) {
-		if (ts.DeferredLogWriteMode) {
-			PostThreadMessage(fv->LogThreadId, WM_DPC_LOGTHREAD_SEND, (WPARAM)WriteBuf, WriteBufLen);
+	// Oobt@ŘAĂ镔Ƃɏ
+	while (Count > 0) {
+		int len = cv_LogBufSize - Start;
+		if (len > Count) {
+			len = Count;
 		}
-		else {
-			DWORD wrote;
-			WriteFile(fv->FileHandle, WriteBuf, WriteBufLen, &wrote, NULL);
-			free(WriteBuf);
+		int wrote = LogWrite(fv, &Buf[Start], len);
+		Start += wrote;
+		if (Start >= cv_LogBufSize) {
+			Start -= cv_LogBufSize;
+		}
+		Count -= wrote;
+		fv->ByteCount += wrote;
+		if (wrote < len) {
+			// ݃XbhǂĂȂ
+			// c̓Oobt@ɎcA񏑂
+			fv->StallCount++;
+			break;
 		}
 	}
 
@@ -692,17 +1041,27 @@ static void LogToFile(PFileVar fv)
 	}
 	if (FLogIsPause() || ProtoGetProtoFlag()) return;
 	fv->FLogDlg->RefreshNum(fv->StartTime, fv->FileSize, fv->ByteCount);
+}
 
-
-	// OE[e[g
-	LogRotate(fv);
+/**
+ *	Oobt@̃TCY
+ *	Mobt@(RecvBuffSize)ƓTCYƂ
+ */
+static int GetLogBufSize(void)
+{
+	int size = ts.RecvBuffSize;
+	if (size < RecvBuffSizeMin || size > RecvBuffSizeMax) {
+		size = RecvBuffSizeDefault;
+	}
+	return size;
 }
 
 static BOOL CreateLogBuf(void)
 {
 	if (cv_LogBuf==NULL)
 	{
-		cv_LogBuf = (char *)malloc(InBuffSize);
+		cv_LogBufSize = GetLogBufSize();
+		cv_LogBuf = (char *)malloc(cv_LogBufSize);
 		cv_LogPtr = 0;
 		cv_LStart = 0;
 		cv_LCount = 0;
@@ -723,7 +1082,8 @@ static BOOL CreateBinBuf(void)
 {
 	if (cv_BinBuf==NULL)
 	{
-		cv_BinBuf = (PCHAR)malloc(InBuffSize);
+		cv_LogBufSize = GetLogBufSize();
+		cv_BinBuf = (PCHAR)malloc(cv_LogBufSize);
 		cv_BinPtr = 0;
 		cv_BStart = 0;
 		cv_BCount = 0;
@@ -746,6 +1106,7 @@ static void FileTransEnd_(PFileVar fv)
 	fv->BinLog = FALSE;
 	cv.Log1Byte = NULL;
 	cv.Log1Bin = NULL;
+	cv.LogBin = NULL;
 	cv.LogBinSkip = NULL;
 	PFileTransDlg FLogDlg = fv->FLogDlg;
 	if (FLogDlg != NULL) {
@@ -754,6 +1115,14 @@ static void FileTransEnd_(PFileVar fv)
 		fv->FLogDlg = NULL;
 	}
 	CloseFileSync(fv);
+	if (ts.Debug) {
+		OutputDebugPrintf("%s: %ld bytes, %lu writes, dropped %lu bytes, stalled %lu\n", __FUNCTION__,
+						  fv->ByteCount, fv->WriteCount, fv->DropCount, fv->StallCount);
+	}
+	free(fv->WriteRing);
+	fv->WriteRing = NULL;
+	LogArchiveDestroy(fv->Archive);
+	fv->Archive = NULL;
 	FreeLogBuf();
 	FreeBinBuf();
 	free(fv->FullName);
@@ -1134,11 +1503,12 @@ static void Log1Bin(BYTE b)
 	}
 	cv_BinBuf[cv_BinPtr] = b;
 	cv_BinPtr++;
-	if (cv_BinPtr>=InBuffSize) {
-		cv_BinPtr = cv_BinPtr-InBuffSize;
+	if (cv_BinPtr>=cv_LogBufSize) {
+		cv_BinPtr = cv_BinPtr-cv_LogBufSize;
 	}
-	if (cv_BCount>=InBuffSize) {
-		cv_BCount = InBuffSize;
+	if (cv_BCount>=cv_LogBufSize) {
+		LogVar->DropCount++;
+		cv_BCount = cv_LogBufSize;
 		cv_BStart = cv_BinPtr;
 	}
 	else {
@@ -1146,6 +1516,44 @@ static void Log1Bin(BYTE b)
 	}
 }
 
+/**
+ * O֕byte
+ *		Log1Bin() ܂Ƃ߂čs
+ */
+static void LogBin(const BYTE *b, int len)
+{
+	if (LogVar->IsPause || ProtoGetProtoFlag()) {
+		return;
+	}
+	if (cv_BinSkip > 0) {
+		int skip = cv_BinSkip < len ? cv_BinSkip : len;
+		cv_BinSkip -= skip;
+		b += skip;
+		len -= skip;
+	}
+	while (len > 0) {
+		int n = cv_LogBufSize - cv_BinPtr;
+		if (n > len) {
+			n = len;
+		}
+		memcpy(&cv_BinBuf[cv_BinPtr], b, n);
+		cv_BinPtr += n;
+		if (cv_BinPtr>=cv_LogBufSize) {
+			cv_BinPtr = cv_BinPtr-cv_LogBufSize;
+		}
+		cv_BCount += n;
+		b += n;
+		len -= n;
+	}
+	if (cv_BCount>cv_LogBufSize) {
+		LogVar->DropCount += cv_BCount - cv_LogBufSize;
+	}
+	if (cv_BCount>=cv_LogBufSize) {
+		cv_BCount = cv_LogBufSize;
+		cv_BStart = cv_BinPtr;
+	}
+}
+
 static void LogBinSkip(int add)
 {
 	if (cv_BinBuf != NULL) {
@@ -1171,6 +1579,48 @@ int FLogGetCount(void)
 	return 0;
 }
 
+/**
+ *	Oobt@ɋ󂫂
+ *	MĂ΂BM~߂Ȃ悤A҂
+ *	- obt@̓e݃Xbh֓n
+ *	- ł󂫂Ȃ(݃XbhǂĂȂ)Ƃ
+ *	  Âf[^̂āADropCount ɐ
+ *	@param	size	Kvȋ󂫃oCg
+ */
+void FLogMakeFreeSpace(int size)
+{
+	PFileVar fv = LogVar;
+	int *Start, *Count;
+	int drop;
+
+	if (fv == NULL) {
+		return;
+	}
+	if (fv->FileLog && cv_LogBuf != NULL) {
+		Start = &cv_LStart;
+		Count = &cv_LCount;
+	}
+	else if (fv->BinLog && cv_BinBuf != NULL) {
+		Start = &cv_BStart;
+		Count = &cv_BCount;
+	}
+	else {
+		return;
+	}
+
+	LogToFile(fv);
+
+	if (size > cv_LogBufSize) {
+		size = cv_LogBufSize;
+	}
+	drop = *Count - (cv_LogBufSize - size);
+	if (drop > 0) {
+		*Start = (*Start + drop) % cv_LogBufSize;
+		*Count -= drop;
+		fv->DropCount += drop;
+	}
+}
+
 /**
  *	Oobt@̋󂫃oCgԂ
  */
@@ -1181,10 +1631,10 @@ int FLogGetFreeCount(void)
 		return 0;
 	}
 	if (fv->FileLog) {
-		return InBuffSize - cv_LCount;
+		return cv_LogBufSize - cv_LCount;
 	}
 	if (fv->BinLog) {
-		return InBuffSize - cv_BCount;
+		return cv_LogBufSize - cv_BCount;
 	}
 	return 0;
 }
@@ -1198,6 +1648,19 @@ void FLogWriteFile(void)
 	if (fv == NULL) {
 		return;
 	}
+	if (RingLoad(&fv->ReopenError)) {
+		// [e[g̃t@CJȂ̂ŁAOI
+		wchar_t *filename = _wcsdup(fv->FullName);
+		FileTransEnd_(fv);
+		static const TTMessageBoxInfoW mbinfo = {
+			"Tera Term",
+			"MSG_TT_FILE_OPEN_ERROR", L"Tera Term: File open error",
+			"MSG_LOGFILE_WRITE_ERROR", L"Cannot write log file.\n%s",
+			MB_OK | MB_ICONERROR};
+		TTMessageBoxW(HVTWin, &mbinfo, ts.UILanguageFileW, filename);
+		free(filename);
+		return;
+	}
 	if (cv_LogBuf!=NULL)
 	{
 		if (fv->FileLog) {
@@ -1227,9 +1690,17 @@ void FLogPutUTF32(unsigned int u32)
 	if (ts.LogTimestamp && fv->eLineEnd) {
 		// ^CX^vo
 		fv->eLineEnd = Line_Other; /* clear endmark*/
-		wchar_t* strtime = TimeStampStr(fv);
-		FLogWriteStr(strtime);
-		free(strtime);
+		size_t len;
+		const char *strtime = TimeStampStr(fv, &len);
+		if (fv->TimeStamp.ascii) {
+			LogPutAscii(fv, strtime, len);
+		}
+		else {
+			//  ASCII ȊO̕܂܂Ă
+			wchar_t *strtimeW = ToWcharA(strtime);
+			FLogWriteStr(strtimeW);
+			free(strtimeW);
+		}
 	}
 
 	switch(fv->log_code) {
@@ -1268,7 +1739,11 @@ void FLogPutUTF32(unsigned int u32)
 	}
 }
 
-static void FLogOutputBOM(PFileVar fv)
+/**
+ *	BOMo͂
+ *	@return	o͂oCg
+ */
+static DWORD FLogOutputBOM(PFileVar fv)
 {
 	DWORD wrote;
 
@@ -1277,25 +1752,22 @@ static void FLogOutputBOM(PFileVar fv)
 		// UTF-8
 		const char *bom = "\xef\xbb\xbf";
 		WriteFile(fv->FileHandle, bom, 3, &wrote, NULL);
-		fv->ByteCount += 3;
-		break;
+		return 3;
 	}
 	case 1: {
 		// UTF-16LE
 		const char *bom = "\xff\xfe";
 		WriteFile(fv->FileHandle, bom, 2, &wrote, NULL);
-		fv->ByteCount += 2;
-		break;
+		return 2;
 	}
 	case 2: {
 		// UTF-16BE
 		const char *bom = "\xfe\xff";
 		WriteFile(fv->FileHandle, bom, 2, &wrote, NULL);
-		fv->ByteCount += 2;
-		break;
+		return 2;
 	}
 	default:
-		break;
+		return 0;
 	}
 }
 
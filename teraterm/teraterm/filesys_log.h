@@ -69,6 +69,7 @@ void FLogWindow(int nCmdShow);
 void FLogShowDlg(void);
 int FLogGetCount(void);
 int FLogGetFreeCount(void);
+void FLogMakeFreeSpace(int size);
 void FLogWriteFile(void);
 void FLogPutUTF32(unsigned int u32);
 void FLogOutputAllBuffer(void);
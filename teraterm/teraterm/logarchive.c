@@ -0,0 +1,408 @@
+/*
+ * Copyright (C) 2026- TeraTerm Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * [e[gOt@C̊Ǘ
+ *
+ *	LogRotateNaming=1 ̂ƂA[e[gt@C <Ot@C>.<A> ƂȂ
+ *	[e[g݂͌̃t@C1l[邾ŁAȑÕt@C̓l[Ȃ
+ *	t@C̈k(gzip)ƁA㐔/vTCY𒴂Ât@C̍폜
+ *	[J[Xbhōs
+ */
+
+#define _CRTDBG_MAP_ALLOC
+#include <stdlib.h>
+#include <crtdbg.h>
+#include <string.h>
+#include <wchar.h>
+#include <limits.h>
+#include <process.h>
+#include <windows.h>
+#include <zlib.h>
+
+#include "ttlib.h"
+#include "asprintf.h"
+
+#include "logarchive.h"
+
+#define WM_LOGARCHIVE_ADD	(WM_APP + 1)
+#define COPY_BUF_SIZE		(64*1024)
+
+struct LogArchive_st {
+	wchar_t *FullName;
+	BOOL Compress;
+	ULONGLONG MaxTotal;		// 0 ̂ƂȂ
+	HANDLE Thread;
+	DWORD ThreadId;
+	HANDLE Ready;
+	volatile LONG Quit;		// Iv, kł؂
+};
+
+typedef struct {
+	int seq;
+	BOOL gz;
+	ULONGLONG size;
+	wchar_t *path;			// t@C̃tpX
+} Segment;
+
+/**
+ *	[e[gt@C̃t@C
+ *	@return	t@C, svɂȂ free() 邱
+ */
+wchar_t *LogArchiveGetSegmentName(const wchar_t *fullname, int seq)
+{
+	wchar_t *name;
+	aswprintf(&name, L"%s.%06d", fullname, seq);
+	return name;
+}
+
+/**
+ *	"<base>.<>" ܂ "<base>.<>.gz" ȂAԂԂ
+ *	LogArchiveGetSegmentName() ̌`(6ȏA0)󂯕t
+ *	LogRotateNaming=0  "<base>.1" Ȃǂ͑ΏۊO
+ *	@return	A, [e[gt@Cł͂ȂƂ -1
+ */
+static int ParseSegmentName(const wchar_t *fname, const wchar_t *base, size_t base_len, BOOL *gz)
+{
+	const wchar_t *p;
+	const wchar_t *digits;
+	int seq = 0;
+
+	if (_wcsnicmp(fname, base, base_len) != 0 || fname[base_len] != L'.') {
+		return -1;
+	}
+	p = fname + base_len + 1;
+	digits = p;
+	while (*p >= L'0' && *p <= L'9') {
+		if (seq > (INT_MAX - 9) / 10) {
+			return -1;
+		}
+		seq = seq * 10 + (*p - L'0');
+		p++;
+	}
+	if (p - digits < 6 || (p - digits > 6 && *digits == L'0')) {
+		return -1;
+	}
+	if (*p == 0) {
+		*gz = FALSE;
+		return seq;
+	}
+	if (_wcsicmp(p, L".gz") == 0) {
+		*gz = TRUE;
+		return seq;
+	}
+	return -1;
+}
+
+static int CompareSegment(const void *a, const void *b)
+{
+	const Segment *sa = (const Segment *)a;
+	const Segment *sb = (const Segment *)b;
+	if (sa->seq != sb->seq) {
+		return sa->seq < sb->seq ? -1 : 1;
+	}
+	return sa->gz - sb->gz;
+}
+
+/**
+ *	[e[gt@C񋓂
+ *	@return	AԂ̏ɕׂz, svɂȂ FreeSegments() 邱
+ */
+static Segment *ListSegments(const wchar_t *fullname, size_t *count)
+{
+	const wchar_t *base;
+	size_t base_len;
+	wchar_t *pattern;
+	WIN32_FIND_DATAW fd;
+	HANDLE h;
+	Segment *list = NULL;
+	size_t n = 0;
+	size_t max = 0;
+	size_t dir_len;
+
+	base = wcsrchr(fullname, L'\\');
+	base = (base == NULL) ? fullname : base + 1;
+	base_len = wcslen(base);
+	dir_len = base - fullname;
+
+	aswprintf(&pattern, L"%s.*", fullname);
+	h = FindFirstFileW(pattern, &fd);
+	free(pattern);
+	if (h != INVALID_HANDLE_VALUE) {
+		do {
+			BOOL gz;
+			int seq;
+			wchar_t *path;
+			if (fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+				continue;
+			}
+			seq = ParseSegmentName(fd.cFileName, base, base_len, &gz);
+			if (seq < 0) {
+				continue;
+			}
+			path = (wchar_t *)malloc(sizeof(wchar_t) * (dir_len + wcslen(fd.cFileName) + 1));
+			if (path == NULL) {
+				break;
+			}
+			wmemcpy(path, fullname, dir_len);
+			wcscpy(path + dir_len, fd.cFileName);
+			if (n == max) {
+				size_t new_max = (max == 0) ? 16 : max * 2;
+				Segment *p = (Segment *)realloc(list, sizeof(Segment) * new_max);
+				if (p == NULL) {
+					free(path);
+					break;
+				}
+				list = p;
+				max = new_max;
+			}
+			list[n].seq = seq;
+			list[n].gz = gz;
+			list[n].size = ((ULONGLONG)fd.nFileSizeHigh << 32) | fd.nFileSizeLow;
+			list[n].path = path;
+			n++;
+		} while (FindNextFileW(h, &fd));
+		FindClose(h);
+	}
+
+	if (n > 1) {
+		qsort(list, n, sizeof(Segment), CompareSegment);
+	}
+	*count = n;
+	return list;
+}
+
+static void FreeSegments(Segment *list, size_t count)
+{
+	size_t i;
+	for (i = 0; i < count; i++) {
+		free(list[i].path);
+	}
+	free(list);
+}
+
+/**
+ *	[e[gt@C̍Ō̘AԂԂ
+ *	@return	A, t@CȂƂ 0
+ */
+int LogArchiveGetLastSeq(const wchar_t *fullname)
+{
+	size_t n;
+	Segment *list = ListSegments(fullname, &n);
+	int seq = (n == 0) ? 0 : list[n - 1].seq;
+	FreeSegments(list, n);
+	return seq;
+}
+
+/**
+ *	<name>.<A>  gzip k <name>.<A>.gz ɂ
+ *	ꎞt@C֏݁AĂ烊l[ƌt@C̍폜s
+ */
+static BOOL CompressSegment(LogArchive_t *self, const wchar_t *fullname, int seq)
+{
+	wchar_t *src = LogArchiveGetSegmentName(fullname, seq);
+	wchar_t *dst;
+	wchar_t *tmp;
+	HANDLE in;
+	BOOL ok = FALSE;
+
+	aswprintf(&dst, L"%s.gz", src);
+	aswprintf(&tmp, L"%s.gz.tmp", src);
+
+	in = CreateFileW(src, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+					 FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (in != INVALID_HANDLE_VALUE) {
+		gzFile out = gzopen_w(tmp, "wb");
+		if (out != NULL) {
+			char *buf = (char *)malloc(COPY_BUF_SIZE);
+			ok = (buf != NULL);
+			while (ok) {
+				DWORD len;
+				if (InterlockedCompareExchange(&self->Quit, 0, 0)) {
+					// Iv, ̃t@C͎c
+					ok = FALSE;
+					break;
+				}
+				if (!ReadFile(in, buf, COPY_BUF_SIZE, &len, NULL)) {
+					ok = FALSE;
+					break;
+				}
+				if (len == 0) {
+					break;
+				}
+				if (gzwrite(out, buf, len) != (int)len) {
+					ok = FALSE;
+				}
+			}
+			free(buf);
+			if (gzclose(out) != Z_OK) {
+				ok = FALSE;
+			}
+		}
+		CloseHandle(in);
+	}
+
+	if (ok) {
+		ok = MoveFileExW(tmp, dst, MOVEFILE_REPLACE_EXISTING);
+	}
+	if (ok) {
+		DeleteFileW(src);
+	}
+	else {
+		DeleteFileW(tmp);
+		OutputDebugPrintf("%s: seq %d error %lu\n", __FUNCTION__, seq, GetLastError());
+	}
+
+	free(src);
+	free(dst);
+	free(tmp);
+	return ok;
+}
+
+/**
+ *	㐔܂͍vTCY𒴂Â폜
+ *	ŐṼt@C͍폜Ȃ
+ */
+static void ApplyRetention(LogArchive_t *self, int keep_count)
+{
+	size_t n;
+	size_t i;
+	ULONGLONG total = 0;
+	Segment *list = ListSegments(self->FullName, &n);
+
+	for (i = 0; i < n; i++) {
+		total += list[i].size;
+	}
+	for (i = 0; i + 1 < n; i++) {
+		BOOL over_count = keep_count > 0 && n - i > (size_t)keep_count;
+		BOOL over_total = self->MaxTotal > 0 && total > self->MaxTotal;
+		if (!over_count && !over_total) {
+			break;
+		}
+		DeleteFileW(list[i].path);
+		total -= list[i].size;
+	}
+	FreeSegments(list, n);
+}
+
+static unsigned __stdcall LogArchiveThread(void *arg)
+{
+	LogArchive_t *self = (LogArchive_t *)arg;
+	MSG msg;
+
+	// XbhL[쐬Ă琶֒ʒm
+	PeekMessage(&msg, NULL, 0, 0, PM_NOREMOVE);
+	SetEvent(self->Ready);
+
+	while (GetMessage(&msg, NULL, 0, 0) > 0) {
+		if (msg.message == WM_LOGARCHIVE_ADD) {
+			// Iv̂Ƃ͈kA폜s
+			if (self->Compress && !InterlockedCompareExchange(&self->Quit, 0, 0)) {
+				CompressSegment(self, self->FullName, (int)msg.wParam);
+			}
+			ApplyRetention(self, (int)msg.lParam);
+		}
+	}
+
+	_endthreadex(0);
+	return 0;
+}
+
+/**
+ *	[J[XbhN
+ *
+ *	@param	fullname		Ot@C
+ *	@param	compress		TRUE ̂Ƃ gzip k
+ *	@param	max_total_mb	[e[gt@C̍vTCY(MB), 0 ̂ƂȂ
+ */
+LogArchive_t *LogArchiveCreate(const wchar_t *fullname, BOOL compress, DWORD max_total_mb)
+{
+	unsigned tid;
+	LogArchive_t *self = (LogArchive_t *)calloc(1, sizeof(LogArchive_t));
+	if (self == NULL) {
+		return NULL;
+	}
+	self->FullName = _wcsdup(fullname);
+	self->Compress = compress;
+	self->MaxTotal = (ULONGLONG)max_total_mb * 1024 * 1024;
+	self->Ready = CreateEvent(NULL, TRUE, FALSE, NULL);
+	if (self->FullName == NULL || self->Ready == NULL) {
+		goto error;
+	}
+	self->Thread = (HANDLE)_beginthreadex(NULL, 0, LogArchiveThread, self, 0, &tid);
+	if (self->Thread == 0) {
+		goto error;
+	}
+	self->ThreadId = tid;
+
+	// XbhL[쐬O PostThreadMessage() ͎s邽ߑ҂킹
+	WaitForSingleObject(self->Ready, INFINITE);
+	CloseHandle(self->Ready);
+	self->Ready = NULL;
+	return self;
+
+error:
+	if (self->Ready != NULL) {
+		CloseHandle(self->Ready);
+	}
+	free(self->FullName);
+	free(self);
+	return NULL;
+}
+
+/**
+ *	[J[XbhI
+ *	k̃t@C͑ł؂AL[ɎcĂt@C͈kȂ
+ *	(kȂt@C <name>.<A> ̂܂܎c)
+ *	Ât@C̍폜͍ŝŁA҂̂̓fBNg̗񋓂ƍ폜̕
+ */
+void LogArchiveDestroy(LogArchive_t *self)
+{
+	if (self == NULL) {
+		return;
+	}
+	InterlockedExchange(&self->Quit, 1);
+	if (PostThreadMessage(self->ThreadId, WM_QUIT, 0, 0)) {
+		WaitForSingleObject(self->Thread, INFINITE);
+	}
+	CloseHandle(self->Thread);
+	free(self->FullName);
+	free(self);
+}
+
+/**
+ *	[e[gŕt@Cn
+ *	kƌÂt@C̍폜̓[J[Xbhōs
+ *
+ *	@param	seq			t@C̘A
+ *	@param	keep_count	c㐔, 0 ̂ƂȂ
+ */
+void LogArchiveAdd(LogArchive_t *self, int seq, int keep_count)
+{
+	PostThreadMessage(self->ThreadId, WM_LOGARCHIVE_ADD, (WPARAM)seq, (LPARAM)keep_count);
+}
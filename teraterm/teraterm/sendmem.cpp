@@ -283,7 +283,7 @@ static void GetInBuffInfo(const TComVar *cv_, size_t *use, size_t *free)
 		*use = cv_->InBuffCount;
 	}
 	if (free != NULL) {
-		*free = InBuffSize - cv_->InBuffCount;
+		*free = cv_->InBuffMax - cv_->InBuffCount;
 	}
 }
 
@@ -98,6 +98,7 @@ static char ParamSecondFileName[MaxStrLen];
 static BOOL AutoLogClose = FALSE;
 
 static char *cv_LogBuf;
+static int cv_DBufSize;
 static int cv_LogPtr;
 static int cv_DStart;
 static int cv_DCount;
@@ -114,12 +115,12 @@ void DDEPut1(BYTE b)
 
 	cv_LogBuf[cv_LogPtr] = b;
 	cv_LogPtr++;
-	if (cv_LogPtr >= InBuffSize)
-		cv_LogPtr = cv_LogPtr - InBuffSize;
+	if (cv_LogPtr >= cv_DBufSize)
+		cv_LogPtr = cv_LogPtr - cv_DBufSize;
 
-	if (cv_DCount >= InBuffSize)
+	if (cv_DCount >= cv_DBufSize)
 	{
-		cv_DCount = InBuffSize;
+		cv_DCount = cv_DBufSize;
 		cv_DStart = cv_LogPtr;
 	}
 	else
@@ -128,7 +129,12 @@ void DDEPut1(BYTE b)
 
 static BOOL DDECreateBuf(void)
 {
-	cv_LogBuf = (char *)malloc(InBuffSize);
+	// Mobt@(RecvBuffSize)ƓTCYƂ
+	cv_DBufSize = ts.RecvBuffSize;
+	if (cv_DBufSize < RecvBuffSizeMin || cv_DBufSize > RecvBuffSizeMax) {
+		cv_DBufSize = RecvBuffSizeDefault;
+	}
+	cv_LogBuf = (char *)malloc(cv_DBufSize);
 	if (cv_LogBuf == NULL) {
 		return FALSE;
 	}
@@ -254,8 +260,8 @@ static BOOL DDEGet1(LPBYTE b)
 	if (cv_DCount <= 0) return FALSE;
 	*b = ((LPSTR)cv_LogBuf)[cv_DStart];
 	cv_DStart++;
-	if (cv_DStart>=InBuffSize)
-		cv_DStart = cv_DStart-InBuffSize;
+	if (cv_DStart>=cv_DBufSize)
+		cv_DStart = cv_DStart-cv_DBufSize;
 	cv_DCount--;
 	return TRUE;
 }
@@ -274,7 +280,7 @@ static LONG DDEGetDataLen()
 		b = ((LPSTR)cv_LogBuf)[Start];
 		if ((b==0x00) || (b==0x01)) Len++;
 		Start++;
-		if (Start>=InBuffSize) Start = Start-InBuffSize;
+		if (Start>=cv_DBufSize) Start = Start-cv_DBufSize;
 		Count--;
 	}
 
@@ -289,6 +295,14 @@ int DDEGetCount(void)
 	return cv_DCount;
 }
 
+/**
+ *	Mobt@̋󂫃oCgԂ
+ */
+int DDEGetFreeCount(void)
+{
+	return cv_DBufSize - cv_DCount;
+}
+
 static HDDEDATA AcceptRequest(HSZ ItemHSz)
 {
 	BYTE b;
@@ -309,6 +323,12 @@ static HDDEDATA AcceptRequest(HSZ ItemHSz)
 		if ((SyncMode) &&
 		    (SyncFreeSpace<Len))
 			Len = SyncFreeSpace;
+		// 񓯊[hł̓}ÑOobt@̋󂫂킩ȂB
+		// Mobt@̓Oobt@傫Ƃ̂ŁA1̓]
+		// }N󂯕t󂫂̉(Oobt@̔)܂łƂA
+		// ǂ̃f[^㏑Ȃ悤ɂBc͎񑗂
+		else if (Len > DdeMacroRCountLimit)
+			Len = DdeMacroRCountLimit;
 
 		DH = DdeCreateDataHandle(Inst,NULL,Len+2,0,
 		                         Item,CF_OEMTEXT,0);
@@ -51,6 +51,7 @@ extern BOOL CloseTT;
 extern BOOL DDELog;
 void DDEPut1(BYTE b);
 int DDEGetCount(void);
+int DDEGetFreeCount(void);
 
 #ifdef __cplusplus
 }
@@ -32,6 +32,42 @@
 
 #include "unicode.h"
 
+#include "unicode_property.tbl"
+
+/**
+ *	R[h|Cg̓܂Ƃ߂Ď擾
+ *
+ *	East_Asian_Width, , G, B[}  1byte ɂ܂Ƃ߂lԂ
+ *	e[u unicode/get_property_table.pl 
+ *	unicode_asian_width.tbl Ȃǂ쐬Ă
+ *
+ *	@return	UNICODE_PROP_* Q
+ */
+unsigned char UnicodeGetProperty(unsigned long u32)
+{
+	if (u32 < 0x100) {
+		// Latin-1  Stage2 ̐擪ɂ̂܂ܕł
+		return UnicodePropertyStage2[u32];
+	}
+	if (u32 >= 0x110000) {
+		return 0;
+	}
+	const unsigned int block = UnicodePropertyStage1[u32 >> UNICODE_PROPERTY_BLOCK_SHIFT];
+	const unsigned int mask = (1 << UNICODE_PROPERTY_BLOCK_SHIFT) - 1;
+	return UnicodePropertyStage2[(block << UNICODE_PROPERTY_BLOCK_SHIFT) | (u32 & mask)];
+}
+
+/**
+ *	UnicodeGetProperty() ̒l East_Asian_Width o
+ *
+ *	@return	UnicodeGetWidthProperty() Ɠ
+ */
+char UnicodeWidthPropertyFromProperty(unsigned char prop)
+{
+	static const char width[8] = { 'H', 'n', 'N', 'A', 'W', 'F', 'H', 'H' };
+	return width[prop & UNICODE_PROP_WIDTH_MASK];
+}
+
 /**
  *	East_Asian_Width Ql 擾
  *
@@ -49,57 +85,9 @@
  */
 char UnicodeGetWidthProperty(unsigned long u32)
 {
-	typedef struct {
-		unsigned long code_from;
-		unsigned long code_to;
-		char property;
-	} east_asian_width_map_t;
-	// e[uɓĂȂꍇ H
-	const static east_asian_width_map_t east_asian_width_map[] = {
-#include "unicode_asian_width.tbl"
-	};
-	const east_asian_width_map_t *table = east_asian_width_map;
-	const size_t table_size = _countof(east_asian_width_map);
-	char result;
-
-	// e[uO`FbN
-	if (u32 < east_asian_width_map[0].code_from) {
-		return 'H';
-	}
-	if (east_asian_width_map[table_size-1].code_to < u32) {
-		return 'H';
-	}
-
-	// e[u
-	result = 'H';
-	size_t low = 0;
-	size_t high = table_size - 1;
-	while (low < high) {
-		size_t mid = (low + high) / 2;
-		if (table[mid].code_from <= u32 && u32 <= table[mid].code_to) {
-			result = table[mid].property;
-			break;
-		} else if (table[mid].code_to < u32) {
-			low = mid + 1;
-		} else {
-			high = mid;
-		}
-	}
-
-	return result;
+	return UnicodeWidthPropertyFromProperty(UnicodeGetProperty(u32));
 }
 
-typedef struct {
-	unsigned long code_from;
-	unsigned long code_to;
-} UnicodeTable_t;
-
-typedef struct {
-	unsigned long code_from;
-	unsigned long code_to;
-	unsigned char category;
-} UnicodeTableCombine_t;
-
 typedef struct {
 	unsigned long code_from;
 	unsigned long code_to;
@@ -116,72 +104,6 @@ static const UnicodeTableBlock_t UnicodeBlockList[] = {
  *	@retval		e[uindex
  *	@retval		-1 e[uɑ݂Ȃ
  */
-static int SearchTableSimple(
-	const UnicodeTable_t *table, size_t table_size,
-	unsigned long u32)
-{
-	if (u32 < table[0].code_from) {
-		return -1;
-	}
-	if (u32 > table[table_size-1].code_to) {
-		return -1;
-	}
-	size_t low = 0;
-	size_t high = table_size - 1;
-	while (low <= high) {
-		size_t mid = (low + high) / 2;
-		if (table[mid].code_from <= u32 && u32 <= table[mid].code_to) {
-			return (int)mid;
-		} else if (table[mid].code_to < u32) {
-			low = mid + 1;
-		} else {
-			high = mid - 1;
-		}
-	}
-	// e[u͈̔͊O
-	return -1;
-}
-
-/**
- *	SearchTableSimple() Ɠ
- *	e[ǔ^قȂ
- *
- *	@retval		e[uindex
- *	@retval		-1 e[uɑ݂Ȃ
- */
-static int SearchTableCombine(
-	const UnicodeTableCombine_t *table, size_t table_size,
-	unsigned long u32)
-{
-	if (u32 < table[0].code_from) {
-		return -1;
-	}
-	if (u32 > table[table_size-1].code_to) {
-		return -1;
-	}
-	size_t low = 0;
-	size_t high = table_size - 1;
-	while (low <= high) {
-		size_t mid = (low + high) / 2;
-		if (table[mid].code_from <= u32 && u32 <= table[mid].code_to) {
-			return (int)mid;
-		} else if (table[mid].code_to < u32) {
-			low = mid + 1;
-		} else {
-			high = mid - 1;
-		}
-	}
-	// e[u͈̔͊O
-	return -1;
-}
-
-/**
- *	SearchTableSimple() Ɠ
- *	e[ǔ^قȂ
- *
- *	@retval		e[uindex
- *	@retval		-1 e[uɑ݂Ȃ
- */
 static int SearchTableBlock(
 	const UnicodeTableBlock_t *table, size_t table_size,
 	unsigned long u32)
@@ -222,18 +144,7 @@ static int SearchTableBlock(
  */
 int UnicodeIsCombiningCharacter(unsigned long u32)
 {
-#define Mn 1  // Nonspacing_Mark	a nonspacing combining mark (zero advance width)
-#define Mc 2  // Spacing_Mark		a spacing combining mark (positive advance width)
-#define Me 1  // Enclosing_Mark		an enclosing combining mark
-#define Sk 1  // Modifier_Symbol	a non-letterlike modifier symbol
-	const static UnicodeTableCombine_t CombiningCharacterList[] = {
-#include "unicode_combine.tbl"
-	};
-	const int index = SearchTableCombine(CombiningCharacterList, _countof(CombiningCharacterList), u32);
-	if (index == -1) {
-		return 0;
-	}
-	return (int)CombiningCharacterList[index].category;
+	return (UnicodeGetProperty(u32) & UNICODE_PROP_COMBINE_MASK) >> UNICODE_PROP_COMBINE_SHIFT;
 }
 
 /**
@@ -244,11 +155,7 @@ int UnicodeIsCombiningCharacter(unsigned long u32)
  */
 int UnicodeIsEmoji(unsigned long u32)
 {
-	const static UnicodeTable_t EmojiList[] = {
-#include "unicode_emoji.tbl"
-	};
-	const int index = SearchTableSimple(EmojiList, _countof(EmojiList), u32);
-	return index != -1 ? 1 : 0;
+	return (UnicodeGetProperty(u32) & UNICODE_PROP_EMOJI) != 0 ? 1 : 0;
 }
 
 /**
@@ -280,11 +187,7 @@ int UnicodeIsVariationSelector(unsigned long u32)
  */
 int UnicodeIsVirama(unsigned long u32)
 {
-	const static UnicodeTable_t ViramaList[] = {
-#include "unicode_virama.tbl"
-	};
-	const int index = SearchTableSimple(ViramaList, _countof(ViramaList), u32);
-	return index != -1 ? 1 : 0;
+	return (UnicodeGetProperty(u32) & UNICODE_PROP_VIRAMA) != 0 ? 1 : 0;
 }
 
 /**
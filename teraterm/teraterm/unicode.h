@@ -30,6 +30,15 @@
 extern "C" {
 #endif
 
+/* UnicodeGetProperty() ̒l */
+#define UNICODE_PROP_WIDTH_MASK		0x07	// East_Asian_Width, UnicodeWidthPropertyFromProperty() Ŏo
+#define UNICODE_PROP_COMBINE_MASK	0x18	// UnicodeIsCombiningCharacter() ̒l
+#define UNICODE_PROP_COMBINE_SHIFT	3
+#define UNICODE_PROP_EMOJI			0x20	// G
+#define UNICODE_PROP_VIRAMA			0x40	// B[}
+
+unsigned char UnicodeGetProperty(unsigned long u32);
+char UnicodeWidthPropertyFromProperty(unsigned char prop);
 char UnicodeGetWidthProperty(unsigned long u32);
 int UnicodeIsCombiningCharacter(unsigned long u32);
 #if 0
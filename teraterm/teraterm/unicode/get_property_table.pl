@@ -0,0 +1,92 @@
+#!/usr/bin/perl
+use strict;
+use warnings;
+use utf8;
+
+# unicode_asian_width.tbl, unicode_combine.tbl, unicode_emoji.tbl,
+# unicode_virama.tbl から 2段のルックアップテーブルを作成する
+#
+# 1コードポイントの特性を 1byte にまとめる
+#   bit0-2	East_Asian_Width  0=H 1=n 2=N 3=A 4=W 5=F
+#   bit3-4	結合文字  0=なし 1=Nonspacing 2=Spacing
+#   bit5	絵文字
+#   bit6	ヴィラーマ
+
+my $dir = "..";
+my $out_file = "$dir/unicode_property.tbl";
+my $block_shift = 7;
+my $block_size = 1 << $block_shift;
+my $code_max = 0x110000;
+
+my %width_value = ('H' => 0, 'n' => 1, 'N' => 2, 'A' => 3, 'W' => 4, 'F' => 5);
+my %combine_value = ('Mn' => 1, 'Mc' => 2, 'Me' => 1, 'Sk' => 1);
+
+my @prop = (0) x $code_max;
+
+sub read_table {
+	my ($file, $func) = @_;
+	my $IN;
+	open($IN, "<", "$dir/$file") || die "Cannot open $dir/$file.";
+	while (my $a = <$IN>) {
+		if ($a =~ /^\s*\{\s*0x([0-9a-fA-F]+),\s*0x([0-9a-fA-F]+)\s*(?:,\s*([^\s}]+))?\s*\}/) {
+			my $from = hex $1;
+			my $to = hex $2;
+			my $value = $func->($3);
+			for (my $code = $from; $code <= $to; $code++) {
+				$prop[$code] |= $value;
+			}
+		}
+	}
+	close($IN);
+}
+
+read_table("unicode_asian_width.tbl", sub {
+	my $w = $_[0];
+	$w =~ s/'//g;
+	defined $width_value{$w} || die "unknown width $w";
+	return $width_value{$w};
+});
+read_table("unicode_combine.tbl", sub {
+	defined $combine_value{$_[0]} || die "unknown category $_[0]";
+	return $combine_value{$_[0]} << 3;
+});
+read_table("unicode_emoji.tbl", sub { return 0x20; });
+read_table("unicode_virama.tbl", sub { return 0x40; });
+
+# 同じ内容のブロックはまとめる
+my %block_index;
+my @blocks;
+my @stage1;
+for (my $code = 0; $code < $code_max; $code += $block_size) {
+	my $key = join(",", @prop[$code .. $code + $block_size - 1]);
+	if (!defined $block_index{$key}) {
+		$block_index{$key} = scalar(@blocks);
+		push(@blocks, $key);
+	}
+	push(@stage1, $block_index{$key});
+}
+# U+0000-U+00FF は Stage2 の先頭にそのまま並んでいること (UnicodeGetProperty() の高速化)
+($stage1[0] == 0 && $stage1[1] == 1) || die "Latin-1 blocks are not at the top";
+
+my $OUT;
+open($OUT, ">:crlf", $out_file) || die "Cannot open $out_file.";
+print $OUT "// this file was generated by get_property_table.pl\n";
+printf $OUT "#define UNICODE_PROPERTY_BLOCK_SHIFT %d\n", $block_shift;
+my $stage1_type = @blocks <= 256 ? "unsigned char" : "unsigned short";
+printf $OUT "static const %s UnicodePropertyStage1[%d] = {\n", $stage1_type, scalar(@stage1);
+for (my $i = 0; $i < @stage1; $i += 16) {
+	my $last = $i + 15 < $#stage1 ? $i + 15 : $#stage1;
+	print $OUT "\t" . join(", ", @stage1[$i .. $last]) . ",\n";
+}
+print $OUT "};\n";
+printf $OUT "static const unsigned char UnicodePropertyStage2[%d] = {\n", scalar(@blocks) * $block_size;
+for (my $i = 0; $i < @blocks; $i++) {
+	my @v = split(/,/, $blocks[$i]);
+	printf $OUT "\t// %d\n", $i;
+	for (my $j = 0; $j < @v; $j += 32) {
+		print $OUT "\t" . join(",", map { sprintf("0x%02x", $_) } @v[$j .. $j + 31]) . ",\n";
+	}
+}
+print $OUT "};\n";
+close($OUT);
+printf("stage1 %d entries, stage2 %d blocks (%d bytes)\n", scalar(@stage1), scalar(@blocks), scalar(@blocks) * $block_size);
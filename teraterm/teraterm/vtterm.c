@@ -5274,18 +5274,26 @@ static void CANSeen(BYTE b)
  *	1byte݂
  *	̏ꍇAǂݏosȂ
  *		- macroMobt@ɗ]TȂ
- *		- Oobt@ɗ]TȂ
- *
+ *	Oobt@ɗ]TȂꍇ́Aǂݏo~߂ɋ󂫂
+ *	(݂ǂĂȂΌÂÔĂ)
  */
-static int CommRead1Byte_(PComVar cv, LPBYTE b)
+static BOOL CommReadable(void)
 {
-	if (DDELog && DDEGetCount() >= InBuffSize - 10) {
+	if (DDELog && DDEGetFreeCount() <= 10) {
 		/* obt@ɗ]TȂꍇ */
-		Sleep(1);
-		return 0;
+		return FALSE;
 	}
 
 	if (FLogIsOpend() && FLogGetFreeCount() < FILESYS_LOG_FREE_SPACE) {
+		FLogMakeFreeSpace(FILESYS_LOG_FREE_SPACE);
+	}
+
+	return TRUE;
+}
+
+static int CommRead1Byte_(PComVar cv, LPBYTE b)
+{
+	if (!CommReadable()) {
 		// ̃obt@ɗ]TȂꍇ́ACPUXPW[O𑼂ɉ񂵁A
 		// CPUXg[̖hB
 		// (2006.10.13 yutaka)
@@ -5296,6 +5304,122 @@ static int CommRead1Byte_(PComVar cv, LPBYTE b)
 	return CommRead1Byte(cv, b);
 }
 
+/**
+ *	1byte
+ */
+static void ParseByte(BYTE b)
+{
+#if defined(DEBUG_DUMP_INPUTCODE)
+	{
+		static DWORD prev_tick;
+		DWORD now = GetTickCount();
+		if (prev_tick == 0) prev_tick = now;
+		if (now - prev_tick > 1*1000) {
+			printf("\n");
+			prev_tick = now;
+		}
+		printf("%02x(%c) ", b, isprint(b) ? b : '.');
+	}
+#endif
+	switch (ParseMode) {
+	case ModeFirst:
+		ParseFirst(charset_data, b);
+		break;
+	case ModeESC:
+		EscapeSequence(b);
+		break;
+	case ModeDCS:
+		DeviceControl(b);
+		break;
+	case ModeDCUserKey:
+		DCUserKey(b);
+		break;
+	case ModeSOS:
+		IgnoreString(b);
+		break;
+	case ModeCSI:
+		ControlSequence(b);
+		break;
+	case ModeXS:
+		XSequence(b);
+		break;
+	case ModeDLE:
+		DLESeen(b);
+		break;
+	case ModeCAN:
+		CANSeen(b);
+		break;
+	case ModeIgnore:
+		IgnoreString(b);
+		break;
+	default:
+		ParseMode = ModeFirst;
+		ParseFirst(charset_data, b);
+	}
+
+	PrevCharacter = b;		// memorize previous character for AUTO CR/LF-receive mode
+
+	if ((ParseMode != ModeFirst) && (!(ParseMode == ModeESC || ParseMode == ModeCSI))) {
+		LastPutCharacter = 0;
+	}
+}
+
+/**
+ *	Mobt@̘Af[^܂Ƃ߂ď
+ *	- telnet ̏KvȃoCg̎O܂1xɎQƂ
+ *	- ModeFirst ̂Ƃ͐䕶̎O܂ ParseFirstSpan() ŏ
+ *	- oCiOւ݂̏͏f[^܂Ƃ߂čs
+ */
+static void ParseSpan(void)
+{
+	const BYTE *ptr;
+	int len;
+	int i;
+	BOOL check_free;
+
+	len = CommPeekSpan(&cv, &ptr);
+	if (len == 0) {
+		return;
+	}
+
+	check_free = DDELog || FLogIsOpend();
+	if (FLogIsOpendBin()) {
+		// oCiO CommSkipSpan() ł܂Ƃ߂ď܂
+		int free_count = FLogGetFreeCount() - FILESYS_LOG_FREE_SPACE;
+		if (len > free_count) {
+			FLogMakeFreeSpace(len + FILESYS_LOG_FREE_SPACE);
+			free_count = FLogGetFreeCount() - FILESYS_LOG_FREE_SPACE;
+			if (len > free_count) {
+				len = free_count;
+			}
+		}
+	}
+
+	i = 0;
+	while ((i < len) && (ChangeEmu == 0)) {
+		if (check_free) {
+			// 1ƂɃO,}Ñobt@֏o͂邽ߖ`FbN
+			if (!CommReadable()) {
+				break;
+			}
+		}
+#if !defined(DEBUG_DUMP_INPUTCODE)
+		else if (ParseMode == ModeFirst) {
+			size_t n = ParseFirstSpan(charset_data, &ptr[i], len - i);
+			if (n > 0) {
+				i += (int)n;
+				PrevCharacter = ptr[i - 1];
+				continue;
+			}
+		}
+#endif
+		ParseByte(ptr[i]);
+		i++;
+	}
+
+	CommSkipSpan(&cv, i);
+}
+
 int VTParse()
 {
 	BYTE b;
@@ -5316,59 +5440,10 @@ int VTParse()
 	LockBuffer();
 
 	while ((c>0) && (ChangeEmu==0)) {
-#if defined(DEBUG_DUMP_INPUTCODE)
-		{
-			static DWORD prev_tick;
-			DWORD now = GetTickCount();
-			if (prev_tick == 0) prev_tick = now;
-			if (now - prev_tick > 1*1000) {
-				printf("\n");
-				prev_tick = now;
-			}
-			printf("%02x(%c) ", b, isprint(b) ? b : '.');
-		}
-#endif
-		switch (ParseMode) {
-		case ModeFirst:
-			ParseFirst(charset_data, b);
-			break;
-		case ModeESC:
-			EscapeSequence(b);
-			break;
-		case ModeDCS:
-			DeviceControl(b);
-			break;
-		case ModeDCUserKey:
-			DCUserKey(b);
-			break;
-		case ModeSOS:
-			IgnoreString(b);
-			break;
-		case ModeCSI:
-			ControlSequence(b);
-			break;
-		case ModeXS:
-			XSequence(b);
-			break;
-		case ModeDLE:
-			DLESeen(b);
-			break;
-		case ModeCAN:
-			CANSeen(b);
-			break;
-		case ModeIgnore:
-			IgnoreString(b);
-			break;
-		default:
-			ParseMode = ModeFirst;
-			ParseFirst(charset_data, b);
-		}
-
-		PrevCharacter = b;		// memorize previous character for AUTO CR/LF-receive mode
+		ParseByte(b);
 
-		if ((ParseMode != ModeFirst) && (!(ParseMode == ModeESC || ParseMode == ModeCSI))) {
-			LastPutCharacter = 0;
-		}
+		if (ChangeEmu==0)
+			ParseSpan();
 
 		if (ChangeEmu==0)
 			c = CommRead1Byte_(&cv,&b);
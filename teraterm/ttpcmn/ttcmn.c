@@ -493,6 +493,9 @@ int WINAPI CommReadRawByte(PComVar cv, LPBYTE b)
 	if ( cv->InBuffCount>0 ) {
 		*b = cv->InBuff[cv->InPtr];
 		cv->InPtr++;
+		if (cv->InPtr >= cv->InBuffMax) {
+			cv->InPtr = 0;
+		}
 		cv->InBuffCount--;
 		if ( cv->InBuffCount==0 ) {
 			cv->InPtr = 0;
@@ -517,13 +520,15 @@ void WINAPI CommInsert1Byte(PComVar cv, BYTE b)
 	if ( ! cv->Ready ) {
 		return;
 	}
+	if (cv->InBuffCount >= cv->InBuffMax) {
+		return;
+	}
 
+	// Oobt@Ȃ̂Ő擪֖߂
 	if (cv->InPtr == 0) {
-		memmove(&(cv->InBuff[1]),&(cv->InBuff[0]),cv->InBuffCount);
-	}
-	else {
-		cv->InPtr--;
+		cv->InPtr = cv->InBuffMax;
 	}
+	cv->InPtr--;
 	cv->InBuff[cv->InPtr] = b;
 	cv->InBuffCount++;
 
@@ -537,6 +542,102 @@ static void Log1Bin(PComVar cv, BYTE b)
 	}
 }
 
+static void LogBin(PComVar cv, const BYTE *b, int len)
+{
+	if (cv->LogBin != NULL) {
+		cv->LogBin(b, len);
+	}
+	else if (cv->Log1Bin != NULL) {
+		int i;
+		for (i = 0; i < len; i++) {
+			cv->Log1Bin(b[i]);
+		}
+	}
+}
+
+/**
+ *	Mobt@̘Af[^QƂ
+ *	Oobt@̏I[A܂
+ *	telnet ̏KvȃoCg(IAC, CR)̎O܂łԂ
+ *	oCg CommSkipSpan() Œʒm邱
+ *
+ *	@param	cv
+ *	@param	ptr		f[^̐擪
+ *	@return	QƂłoCg
+ *			0 ̂Ƃ CommRead1Byte() 1byteǂݏo
+ */
+int WINAPI CommPeekSpan(PComVar cv, const BYTE **ptr)
+{
+	const BYTE *p;
+	int len;
+
+	if ( ! cv->Ready ) {
+		return 0;
+	}
+	if (cv->TelMode || cv->IACFlag || cv->TelCRFlag) {
+		// telnet ̃lSVG[VȂ
+		return 0;
+	}
+	if (cv->InBuffCount <= 0) {
+		return 0;
+	}
+
+	p = &cv->InBuff[cv->InPtr];
+	len = cv->InBuffCount;
+	if (len > cv->InBuffMax - cv->InPtr) {
+		// ܂ԂĂ
+		len = cv->InBuffMax - cv->InPtr;
+	}
+	if (cv->PortType == IdTCPIP) {
+		const BOOL check_cr = cv->TelFlag && ! cv->TelBinRecv;
+		int i;
+		for (i = 0; i < len; i++) {
+			if (p[i] == 0xFF || (check_cr && p[i] == 0x0D)) {
+				break;
+			}
+		}
+		len = i;
+	}
+
+	*ptr = p;
+	return len;
+}
+
+/**
+ *	CommPeekSpan() ŎQƂf[^
+ *	oCiOւ͂܂Ƃ߂ď
+ *
+ *	@param	cv
+ *	@param	len		oCg
+ */
+void WINAPI CommSkipSpan(PComVar cv, int len)
+{
+	const BYTE *p;
+
+	if ( ! cv->Ready ) {
+		return;
+	}
+	if (len > cv->InBuffCount) {
+		// ɎMobt@NAꂽ
+		len = cv->InBuffCount;
+	}
+	if (len <= 0) {
+		return;
+	}
+
+	p = &cv->InBuff[cv->InPtr];
+	cv->InPtr += len;
+	if (cv->InPtr >= cv->InBuffMax) {
+		cv->InPtr -= cv->InBuffMax;
+	}
+	cv->InBuffCount -= len;
+	if ( cv->InBuffCount==0 ) {
+		cv->InPtr = 0;
+	}
+
+	LogBin(cv, p, len);
+}
+
 int WINAPI CommRead1Byte(PComVar cv, LPBYTE b)
 {
 	int c;
@@ -707,29 +808,33 @@ static BOOL WriteOutBuff(PComVar cv, const char *TempStr, int TempLen)
 static BOOL WriteInBuff(PComVar cv, const char *TempStr, int TempLen)
 {
 	BOOL Full;
+	int tail;
+	int len;
 
 	if (TempLen == 0) {
 		return TRUE;
 	}
 
-	Full = InBuffSize-cv->InBuffCount-TempLen < 0;
-	if (! Full) {
-		memcpy(&(cv->InBuff[cv->InBuffCount]),TempStr,TempLen);
-		cv->InBuffCount = cv->InBuffCount + TempLen;
-		return TRUE;
+	Full = cv->InBuffMax-cv->InBuffCount-TempLen < 0;
+	if (Full) {
+		return FALSE;
 	}
-	return FALSE;
-}
 
-/**
- *	̓obt@̐擪ɋ󂫂l߂
- */
-static void PackInBuff(PComVar cv)
-{
-	if ( (cv->InPtr>0) && (cv->InBuffCount>0) ) {
-		memmove(cv->InBuff,&(cv->InBuff[cv->InPtr]),cv->InBuffCount);
-		cv->InPtr = 0;
+	// Oobt@̖ցA܂Ԃꍇ2ɕď
+	tail = cv->InPtr + cv->InBuffCount;
+	if (tail >= cv->InBuffMax) {
+		tail -= cv->InBuffMax;
+	}
+	len = cv->InBuffMax - tail;
+	if (len > TempLen) {
+		len = TempLen;
 	}
+	memcpy(&(cv->InBuff[tail]),TempStr,len);
+	if (len < TempLen) {
+		memcpy(&(cv->InBuff[0]),TempStr+len,TempLen-len);
+	}
+	cv->InBuffCount = cv->InBuffCount + TempLen;
+	return TRUE;
 }
 
 int WINAPI CommBinaryBuffOut(PComVar cv, PCHAR B, int C)
@@ -933,8 +1038,6 @@ int WINAPI CommBinaryEcho(PComVar cv, PCHAR B, int C)
 	if ( ! cv->Ready )
 		return C;
 
-	PackInBuff(cv);
-
 	i = 0;
 	a = 1;
 	while ((a>0) && (i<C)) {
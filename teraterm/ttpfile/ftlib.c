@@ -32,28 +32,143 @@
 #include <windows.h> // for BYTE, WORD, LONG
 #include "ftlib.h"
 
+/*
+ *	CRC ̓e[uŌvZ
+ *	obt@ł 8 oCg܂Ƃ߂ď (slice-by-8)
+ *
+ *	CRC16 : XMODEM/YMODEM/ZMODEM  CRC-16/CCITT (0x1021, MSB first)
+ *	CRC32 : ZMODEM  CRC-32 (0xedb88320, LSB first)
+ *	        lƍŌ̔]͌Ăяoōs
+ *
+ *	e[u͍ŏ̌Ăяoō쐬
+ *	t@C]͒[Xbhł̂ݍŝŔr͂ĂȂ
+ */
+static WORD CRC16Table[8][256];
+static DWORD CRC32Table[8][256];
+static BOOL CRCTableReady = FALSE;
+
+static void MakeCRCTable(void)
+{
+  int i, k;
+
+  for (i = 0 ; i < 256 ; i++) {
+    WORD c16 = (WORD)(i << 8);
+    DWORD c32 = (DWORD)i;
+    for (k = 0 ; k < 8 ; k++) {
+      c16 = (c16 & 0x8000) ? (WORD)((c16 << 1) ^ 0x1021) : (WORD)(c16 << 1);
+      c32 = (c32 & 1) ? ((c32 >> 1) ^ 0xedb88320) : (c32 >> 1);
+    }
+    CRC16Table[0][i] = c16;
+    CRC32Table[0][i] = c32;
+  }
+  for (k = 1 ; k < 8 ; k++) {
+    for (i = 0 ; i < 256 ; i++) {
+      WORD c16 = CRC16Table[k-1][i];
+      DWORD c32 = CRC32Table[k-1][i];
+      CRC16Table[k][i] = (WORD)((c16 << 8) ^ CRC16Table[0][c16 >> 8]);
+      CRC32Table[k][i] = (c32 >> 8) ^ CRC32Table[0][c32 & 0xff];
+    }
+  }
+  CRCTableReady = TRUE;
+}
+
 WORD UpdateCRC(BYTE b, WORD CRC)
 {
-  int i;
-
-  CRC = CRC ^ (WORD)((WORD)b << 8);
-  for (i = 1 ; i <= 8 ; i++)
-    if ((CRC & 0x8000)!=0)
-      CRC = (CRC << 1) ^ 0x1021;
-    else
-      CRC = CRC << 1;
+  if (!CRCTableReady)
+    MakeCRCTable();
+  return (WORD)((CRC << 8) ^ CRC16Table[0][(BYTE)((CRC >> 8) ^ b)]);
+}
+
+WORD UpdateCRCBuf(const BYTE *buf, size_t len, WORD CRC)
+{
+  if (!CRCTableReady)
+    MakeCRCTable();
+
+  while (len >= 8) {
+    CRC = (WORD)(CRC16Table[7][buf[0] ^ (CRC >> 8)] ^
+                 CRC16Table[6][buf[1] ^ (CRC & 0xff)] ^
+                 CRC16Table[5][buf[2]] ^
+                 CRC16Table[4][buf[3]] ^
+                 CRC16Table[3][buf[4]] ^
+                 CRC16Table[2][buf[5]] ^
+                 CRC16Table[1][buf[6]] ^
+                 CRC16Table[0][buf[7]]);
+    buf += 8;
+    len -= 8;
+  }
+  while (len > 0) {
+    CRC = (WORD)((CRC << 8) ^ CRC16Table[0][(BYTE)((CRC >> 8) ^ *buf)]);
+    buf++;
+    len--;
+  }
   return CRC;
 }
 
+/*
+ *	ȑO LONG ̂܂܎ZpVtgĂ߁Aʃrbg
+ *	W CRC-32 ƈقȂlɂȂĂ
+ */
 LONG UpdateCRC32(BYTE b, LONG CRC)
 {
-  int i;
-
-  CRC = CRC ^ (LONG)b;
-  for (i = 1 ; i <= 8 ; i++)
-    if ((CRC & 0x00000001)!=0)
-      CRC = (CRC >> 1) ^ 0xedb88320;
-    else
-      CRC = CRC >> 1;
-  return CRC;
+  DWORD c = (DWORD)CRC;
+
+  if (!CRCTableReady)
+    MakeCRCTable();
+  return (LONG)((c >> 8) ^ CRC32Table[0][(BYTE)(c ^ b)]);
+}
+
+LONG UpdateCRC32Buf(const BYTE *buf, size_t len, LONG CRC)
+{
+  DWORD c = (DWORD)CRC;
+
+  if (!CRCTableReady)
+    MakeCRCTable();
+
+  while (len >= 8) {
+    DWORD lo = c ^ ((DWORD)buf[0] | ((DWORD)buf[1] << 8) |
+                    ((DWORD)buf[2] << 16) | ((DWORD)buf[3] << 24));
+    c = CRC32Table[7][lo & 0xff] ^
+        CRC32Table[6][(lo >> 8) & 0xff] ^
+        CRC32Table[5][(lo >> 16) & 0xff] ^
+        CRC32Table[4][lo >> 24] ^
+        CRC32Table[3][buf[4]] ^
+        CRC32Table[2][buf[5]] ^
+        CRC32Table[1][buf[6]] ^
+        CRC32Table[0][buf[7]];
+    buf += 8;
+    len -= 8;
+  }
+  while (len > 0) {
+    c = (c >> 8) ^ CRC32Table[0][(BYTE)(c ^ *buf)];
+    buf++;
+    len--;
+  }
+  return (LONG)c;
+}
+
+/*
+ *	MeLXg̉s CR+LF ɕϊ
+ *	  CR ̂, LF ݂̂̉s CR+LF ɂ
+ *	  CRRecv ͒Õf[^ CR ǂ (pPbg܂ňp)
+ *	dst ɂ len * 2 oCgKv
+ *
+ *	@return	dst ɏ񂾃oCg
+ */
+size_t FTConvRecvNewLine(const BYTE *src, size_t len, BYTE *dst, BOOL *CRRecv)
+{
+  BOOL cr = *CRRecv;
+  size_t n = 0;
+  size_t i;
+
+  for (i = 0; i < len; i++) {
+    BYTE b = src[i];
+    if ((b == 0x0A) && !cr)
+      dst[n++] = 0x0D;
+    if (cr && (b != 0x0A))
+      dst[n++] = 0x0A;
+    cr = b == 0x0D;
+    dst[n++] = b;
+  }
+  *CRRecv = cr;
+  return n;
 }
@@ -36,7 +36,10 @@ extern "C" {
 #endif
 
 WORD UpdateCRC(BYTE b, WORD CRC);
+WORD UpdateCRCBuf(const BYTE *buf, size_t len, WORD CRC);
 LONG UpdateCRC32(BYTE b, LONG CRC);
+LONG UpdateCRC32Buf(const BYTE *buf, size_t len, LONG CRC);
+size_t FTConvRecvNewLine(const BYTE *src, size_t len, BYTE *dst, BOOL *CRRecv);
 
 #ifdef __cplusplus
 }
@@ -208,10 +208,7 @@ static WORD XCalcCheck(PXVar xv, const BYTE *PktBuf)
 			Check = Check + (BYTE) (PktBuf[3 + i]);
 		return (Check & 0xff);
 	} else {					/* CRC */
-		Check = 0;
-		for (i = 0; i <= xv->DataLen - 1; i++)
-			Check = UpdateCRC(PktBuf[3 + i], Check);
-		return (Check);
+		return UpdateCRCBuf(&PktBuf[3], xv->DataLen, 0);
 	}
 }
 
@@ -347,7 +344,7 @@ static BOOL XReadPacket(PFileVarProto fv, PComVar cv)
 {
 	PXVar xv = fv->data;
 	BYTE b, d;
-	int i, c;
+	int c;
 	BOOL GetPkt = FALSE;
 	TFileIO *file = fv->file;
 
@@ -471,24 +468,12 @@ static BOOL XReadPacket(PFileVarProto fv, PComVar cv)
 	}
 
 	if (xv->TextFlagConvertCRLF) {
-		// pPbgCR̂LF݂̂CR+LFɕϊȂt@C֏o
-		for (i = 0; i <= c - 1; i++) {
-			b = xv->PktIn[3 + i];
-			if ((b == LF) && (!xv->CRRecv)) {
-				// LF(0x0A)M && Õf[^CR(0x0D)ł͂Ȃ
-				// CR(0x0D)o
-				//   (CRȊO)+(LF) ́A(CRȊO)+(CR)+(LF)ŏo͂
-				file->WriteFile(file, "\015", 1);
-			}
-			if (xv->CRRecv && (b != LF)) {
-				// LF(0x0A)ȊOM && Õf[^CR(0xOD)
-				// LF(0x0A)o
-				//   (CR)+(LFȊO)́A(CR)+(LF)+(LFȊO)ŏo͂
-				file->WriteFile(file, "\012", 1);
-			}
-			xv->CRRecv = b == CR;
-			file->WriteFile(file, &b, 1);
-		}
+		// pPbgCR̂LF݂̂CR+LFɕϊĂt@C֏o
+		//   (CRȊO)+(LF) ́A(CRȊO)+(CR)+(LF)ŏo͂
+		//   (CR)+(LFȊO)́A(CR)+(LF)+(LFȊO)ŏo͂
+		BYTE buf[sizeof(xv->PktIn) * 2];
+		size_t len = FTConvRecvNewLine(&(xv->PktIn[3]), c, buf, &xv->CRRecv);
+		file->WriteFile(file, buf, len);
 	} else {
 		// ̂܂܃t@C֏o
 		file->WriteFile(file, &(xv->PktIn[3]), c);
@@ -597,11 +582,10 @@ static BOOL XSendPacket(PFileVarProto fv, PComVar cv)
 			xv->PktOut[2] = ~xv->PktNumSent;
 
 			i = 1;
-			while ((i <= xv->DataLen) && xv->FileOpen &&
-				   (file->ReadFile(file, &b, 1) == 1)) {
-				xv->PktOut[2 + i] = b;
-				i++;
-				xv->ByteCount++;
+			if (xv->FileOpen) {
+				size_t c = file->ReadFile(file, &(xv->PktOut[3]), xv->DataLen);
+				i += (int)c;
+				xv->ByteCount += (LONG)c;
 			}
 
 			if (i > 1) {
@@ -275,10 +275,7 @@ static WORD YCalcCheck(PYVar yv, const PCHAR PktBuf, const WORD len)
 	else
 	{
 		// CRC.
-		Check = 0;
-		for (i = 0 ; i <= len - 1 ; i++)
-			Check = UpdateCRC(PktBuf[3 + i],Check);
-		return (Check);
+		return UpdateCRCBuf((const BYTE *)&PktBuf[3], len, 0);
 	}
 }
 
@@ -490,7 +487,7 @@ static BOOL FTCreateFile(PFileVarProto fv)
 static BOOL YReadPacket(PFileVarProto fv, PYVar yv, PComVar cv)
 {
 	BYTE b, d;
-	int i, c, nak;
+	int c, nak;
 	BOOL GetPkt;
 	TFileIO *file = fv->file;
 
@@ -702,16 +699,11 @@ static BOOL YReadPacket(PFileVarProto fv, PYVar yv, PComVar cv)
 	}
 
 	if (yv->TextFlag>0)
-		for (i = 0 ; i <= c-1 ; i++)
-		{
-			b = yv->PktIn[3+i];
-			if ((b==LF) && (! yv->CRRecv))
-				file->WriteFile(file,"\015",1);
-			if (yv->CRRecv && (b!=LF))
-				file->WriteFile(file,"\012",1);
-			yv->CRRecv = b==CR;
-			file->WriteFile(file,&b,1);
-		}
+	{
+		BYTE buf[sizeof(yv->PktIn) * 2];
+		size_t len = FTConvRecvNewLine(&(yv->PktIn[3]), c, buf, &yv->CRRecv);
+		file->WriteFile(file, buf, len);
+	}
 	else
 		file->WriteFile(file, &(yv->PktIn[3]), c);
 
@@ -994,18 +986,16 @@ static BOOL YSendPacket(PFileVarProto fv, PYVar yv, PComVar cv)
 			else
 			{
 				TFileIO *file = fv->file;
-				BYTE fsym = 0;
 				size_t idx = 1;
 
 				yv->__DataLen = current_packet_size;
 
-				while ((idx <= current_packet_size) && yv->FileOpen &&
-				       (1 == file->ReadFile(file, &fsym, 1)))
+				if (yv->FileOpen)
 				{
 					// TODO: remove magic number.
-					yv->PktOut[2 + idx] = fsym;
-					++idx;
-					yv->ByteCount++;
+					size_t c = file->ReadFile(file, &(yv->PktOut[3]), current_packet_size);
+					idx += c;
+					yv->ByteCount += (LONG)c;
 				}
 
 				// No bytes were read.
@@ -53,11 +53,19 @@
 
 #include "zmodem.h"
 
+/*
+ * f[^TupPbg̍ő咷
+ *   1024 𒴂钷 ZMODEM-8k (lrzsz  sz -8 Ȃ) ̊g
+ *   M͏Ɏ󂯕tBM ZmodemDataLen  1024 傫
+ *   ݒ肵Ƃ̂ݎg
+ */
+#define ZMAXDATALEN 8192
+
 /* ZMODEM */
 typedef struct {
 	BYTE RxHdr[4], TxHdr[4];
 	BYTE RxType, TERM;
-	BYTE PktIn[1032], PktOut[1032];
+	BYTE PktIn[ZMAXDATALEN + 8], PktOut[ZMAXDATALEN + 8];
 	int PktInPtr, PktOutPtr;
 	int PktInCount, PktOutCount;
 	int PktInLen;
@@ -68,6 +76,10 @@ typedef struct {
 	BOOL CtlEsc, CRC32, HexLo, Quoted, CRRecv;
 	WORD CRC;
 	LONG CRC3, Pos, LastPos, WinSize;
+	LONG QPos;					// Ō ZCRCQ 𑗂ʒu
+	int BlkLen;					// MTupPbg (MaxDataLen ȉő)
+	LONG GoodBytes;				// G[ȂőoCg
+	LONG GoodNeeded;			// BlkLen 傫̂ɕKv GoodBytes
 	BYTE LastSent;
 	int TOutInit;
 	int TOutFin;
@@ -84,6 +96,10 @@ typedef struct {
 	DWORD StartTime;
 
 	DWORD FileMtime;
+
+	BYTE ReadBuf[32768];		// Mt@C̐ǂ݃obt@
+	LONG ReadBufPos;			// ReadBuf[0] ̃t@Cʒu
+	int ReadBufLen;
 } TZVar;
 typedef TZVar *PZVar;
 
@@ -169,6 +185,26 @@ typedef TZVar *PZVar;
 #define ZCBIN	1
 #define ZCNL	2
 
+/*
+ * MɃGXP[voCg (ZEscTable)
+ *
+ * lrzsz ł ZDLE(CAN), DLE, XON, XOFF, @ ̒ CR, т
+ * MSB GXP[vΏۂƂȂĂB
+ * Tera Term ł͈ȑO lrzsz Ɠ悤A炩̗R
+ * CR ͏ɃGXP[vΏۂɕςĂB
+ *
+ * ڑ悩炳 ssh / telnet ڑꍇɖNȂ悤A
+ * LF  GS ftHg̃GXP[vΏۂɉB
+ * ssh: LF ܂ CR ̒ ~ GXP[v
+ * telnet: GS GXP[v
+ *
+ * ESCCTL ̂Ƃ͐䕶 ((b & 0x60) == 0) GXP[v
+ */
+#define ZESC_ALWAYS	1
+#define ZESC_CTL	2
+
+static BYTE ZEscTable[256];
+
 /* Ot@Cpobt@ */
 #define LOGBUFSIZE 256
 
@@ -329,11 +365,11 @@ static void ZShHdr(PZVar zv, BYTE HdrType)
 	zv->PktOut[3] = ZHEX;
 	zv->PktOutCount = 4;
 	ZPutHex(zv, &(zv->PktOutCount), HdrType);
-	zv->CRC = UpdateCRC(HdrType, 0);
 	for (i = 0; i <= 3; i++) {
 		ZPutHex(zv, &(zv->PktOutCount), zv->TxHdr[i]);
-		zv->CRC = UpdateCRC(zv->TxHdr[i], zv->CRC);
 	}
+	zv->CRC = UpdateCRC(HdrType, 0);
+	zv->CRC = UpdateCRCBuf(zv->TxHdr, 4, zv->CRC);
 	ZPutHex(zv, &(zv->PktOutCount), HIBYTE(zv->CRC));
 	ZPutHex(zv, &(zv->PktOutCount), LOBYTE(zv->CRC));
 	zv->PktOut[zv->PktOutCount] = 0x8D;
@@ -359,51 +395,39 @@ static void ZShHdr(PZVar zv, BYTE HdrType)
 #endif
 }
 
+static void ZMakeEscTable(void)
+{
+	static const BYTE esc[] = {
+		0x0D, // CR
+		0x0A, // LF
+		0x10, // DLE
+		0x11, // XON
+		0x13, // XOFF
+		0x1d, // GS
+		ZDLE, // CAN(0x18)
+		0x8D, // CR | 0x80
+		0x8A, // LF | 0x80
+		0x90, // DLE | 0x80
+		0x91, // XON | 0x80
+		0x93, // XOFF | 0x80
+		0x9d, // GS | 0x80
+	};
+	int i;
+
+	for (i = 0; i < 256; i++)
+		ZEscTable[i] = ((i & 0x60) == 0) ? ZESC_CTL : 0;
+	for (i = 0; i < _countof(esc); i++)
+		ZEscTable[esc[i]] |= ZESC_ALWAYS;
+}
+
 static void ZPutBin(PZVar zv, int *i, BYTE b)
-/*
- * lrzsz ł ZDLE(CAN), DLE, XON, XOFF, @ ̒ CR, т
- * MSB GXP[vΏۂƂȂĂB
- * Tera Term ł͈ȑO lrzsz Ɠ悤A炩̗R
- * CR ͏ɃGXP[vΏۂɕςĂB
- *
- * ڑ悩炳 ssh / telnet ڑꍇɖNȂ悤A
- * LF  GS ftHg̃GXP[vΏۂɉB
- * ssh: LF ܂ CR ̒ ~ GXP[v
- * telnet: GS GXP[v
- */
 {
-	switch (b) {
-	case 0x0D: // CR
-	case 0x8D: // CR | 0x80
-		/* if (zv->CtlEsc ||
-		   ((zv->LastSent & 0x7f) == '@')) */
-//  {
-		zv->PktOut[*i] = ZDLE;
-		(*i)++;
-		b = b ^ 0x40;
-//  }
-		break;
-	case 0x0A: // LF
-	case 0x10: // DLE
-	case 0x11: // XON
-	case 0x13: // XOFF
-	case 0x1d: // GS
-	case ZDLE: // CAN(0x18)
-	case 0x8A: // LF | 0x80
-	case 0x90: // DLE | 0x80
-	case 0x91: // XON | 0x80
-	case 0x93: // XOFF | 0x80
-	case 0x9d: // GS | 0x80
+	BYTE mask = zv->CtlEsc ? (ZESC_ALWAYS | ZESC_CTL) : ZESC_ALWAYS;
+
+	if (ZEscTable[b] & mask) {
 		zv->PktOut[*i] = ZDLE;
 		(*i)++;
 		b = b ^ 0x40;
-		break;
-	default:
-		if (zv->CtlEsc && ((b & 0x60) == 0)) {
-			zv->PktOut[*i] = ZDLE;
-			(*i)++;
-			b = b ^ 0x40;
-		}
 	}
 	zv->LastSent = b;
 	zv->PktOut[*i] = b;
@@ -419,11 +443,11 @@ static void ZSbHdr(PZVar zv, BYTE HdrType)
 	zv->PktOut[2] = ZBIN;
 	zv->PktOutCount = 3;
 	ZPutBin(zv, &(zv->PktOutCount), HdrType);
-	zv->CRC = UpdateCRC(HdrType, 0);
 	for (i = 0; i <= 3; i++) {
 		ZPutBin(zv, &(zv->PktOutCount), zv->TxHdr[i]);
-		zv->CRC = UpdateCRC(zv->TxHdr[i], zv->CRC);
 	}
+	zv->CRC = UpdateCRC(HdrType, 0);
+	zv->CRC = UpdateCRCBuf(zv->TxHdr, 4, zv->CRC);
 	ZPutBin(zv, &(zv->PktOutCount), HIBYTE(zv->CRC));
 	ZPutBin(zv, &(zv->PktOutCount), LOBYTE(zv->CRC));
 
@@ -563,7 +587,7 @@ static void ZSendFileHdr(PZVar zv)
 
 static void ZSendFileDat(PFileVarProto fv, PZVar zv)
 {
-	int i, j;
+	int j;
 	TFileIO *file = fv->file;
 	char *filename;
 
@@ -577,9 +601,7 @@ static void ZSendFileDat(PFileVarProto fv, PZVar zv)
 	filename = file->GetSendFilename(file, zv->FullName, FALSE, TRUE, FALSE);
 	strncpy_s(zv->PktOut, sizeof(zv->PktOut), filename, _TRUNCATE);
 	zv->PktOutCount = strlen(zv->PktOut);
-	zv->CRC = 0;
-	for (i = 0; i <= zv->PktOutCount - 1; i++)
-		zv->CRC = UpdateCRC(zv->PktOut[i], zv->CRC);
+	zv->CRC = UpdateCRCBuf(zv->PktOut, zv->PktOutCount, 0);
 	ZPutBin(zv, &(zv->PktOutCount), 0);
 	zv->CRC = UpdateCRC(0, zv->CRC);
 	/* file size */
@@ -593,11 +615,9 @@ static void ZSendFileDat(PFileVarProto fv, PZVar zv)
 				sizeof(zv->PktOut) - zv->PktOutCount, _TRUNCATE,
 				"%lu %lo %o", zv->FileSize, zv->FileMtime,
 				0644 | _S_IFREG);
-	j = strlen(&(zv->PktOut[zv->PktOutCount])) - 1;
-	for (i = 0; i <= j; i++) {
-		zv->CRC = UpdateCRC(zv->PktOut[zv->PktOutCount], zv->CRC);
-		zv->PktOutCount++;
-	}
+	j = strlen(&(zv->PktOut[zv->PktOutCount]));
+	zv->CRC = UpdateCRCBuf(&(zv->PktOut[zv->PktOutCount]), j, zv->CRC);
+	zv->PktOutCount += j;
 
 	ZPutBin(zv, &(zv->PktOutCount), 0);
 	zv->CRC = UpdateCRC(0, zv->CRC);
@@ -635,11 +655,81 @@ static void ZSendDataHdr(PZVar zv)
 	zv->ZState = Z_SendDataHdr;
 }
 
+/*
+ *	Mt@C ByteCount ̈ʒũf[^Ԃ
+ *	ǂ݃obt@ɖƂ͂܂Ƃ߂ēǂݍ
+ *	ZRPOS Ŗ߂ƂȂǁAłȂʒûƂ Seek 
+ *
+ *	@return	ǂݏooCg, 0 ̂Ƃ̓t@CI[
+ */
+static int ZReadAhead(PFileVarProto fv, PZVar zv, const BYTE **data)
+{
+	TFileIO *file = fv->file;
+	LONG ofs = zv->ByteCount - zv->ReadBufPos;
+
+	if ((ofs < 0) || (ofs >= zv->ReadBufLen)) {
+		size_t c;
+		if (!zv->FileOpen)
+			return 0;
+		if (zv->ReadBufPos + zv->ReadBufLen != zv->ByteCount)
+			file->Seek(file, zv->ByteCount);
+		c = file->ReadFile(file, zv->ReadBuf, sizeof(zv->ReadBuf));
+		zv->ReadBufPos = zv->ByteCount;
+		zv->ReadBufLen = (int)c;
+		if (c == 0)
+			return 0;
+		ofs = 0;
+	}
+	*data = &zv->ReadBuf[ofs];
+	return zv->ReadBufLen - ofs;
+}
+
+/*
+ *	MTupPbg̒
+ *	ZRPOS (M̃G[) ŔɂAG[Ȃ GoodNeeded oCg
+ *	Ɣ{ɂ (MaxDataLen ܂)
+ *	G[̂т GoodNeeded {ɂāAG[̑ł͑傫
+ *	ɂ
+ */
+static void ZBlkLenError(PZVar zv)
+{
+	zv->BlkLen = zv->BlkLen / 2;
+	if (zv->BlkLen < 64)
+		zv->BlkLen = 64;
+	if (zv->BlkLen > zv->MaxDataLen)
+		zv->BlkLen = zv->MaxDataLen;
+	zv->GoodBytes = 0;
+	if (zv->GoodNeeded < 1024 * 1024)
+		zv->GoodNeeded = zv->GoodNeeded * 2;
+}
+
+static void ZBlkLenGood(PZVar zv, LONG len)
+{
+	if (zv->BlkLen >= zv->MaxDataLen)
+		return;
+	zv->GoodBytes += len;
+	if (zv->GoodBytes >= zv->GoodNeeded) {
+		zv->BlkLen = zv->BlkLen * 2;
+		if (zv->BlkLen > zv->MaxDataLen)
+			zv->BlkLen = zv->MaxDataLen;
+		zv->GoodBytes = 0;
+	}
+}
+
+/*
+ *	f[^TupPbg𑗂
+ *
+ *	EBhE (WinSize >= 0 ̂Ƃ)
+ *	  WinSize / 2 Ƃ ZCRCQ 𑗂ĎM ZACK v邪A
+ *	  ͑҂ɑM𑱂
+ *	  ZACK ŊmFꂽʒu (LastPos)  WinSize 𒴂Ƃ
+ *	  ~܂ ZACK ҂ (Z_SendDataDat2)
+ *	WinSize < 0 ̂Ƃ ZCRCG ő葱AG[͎M
+ *	ZRPOS ŉ񕜂
+ */
 static void ZSendDataDat(PFileVarProto fv, PZVar zv)
 {
-	int c;
 	BYTE b;
-	TFileIO *file = fv->file;
 
 	if (zv->Pos >= zv->FileSize) {
 		zv->Pos = zv->FileSize;
@@ -649,31 +739,35 @@ static void ZSendDataDat(PFileVarProto fv, PZVar zv)
 
 	zv->ByteCount = zv->Pos;
 
-	if (zv->FileOpen && (zv->Pos < zv->FileSize))
-		file->Seek(file, zv->Pos);
-
 	zv->CRC = 0;
 	zv->PktOutCount = 0;
-	do {
-		c = file->ReadFile(file, &b, 1);
-		if (c > 0) {
-			ZPutBin(zv, &(zv->PktOutCount), b);
-			zv->CRC = UpdateCRC(b, zv->CRC);
-			zv->ByteCount++;
-		}
-	} while ((c != 0) && (zv->PktOutCount <= zv->MaxDataLen - 2));
+	while (zv->PktOutCount <= zv->BlkLen - 2) {
+		const BYTE *data;
+		int len = ZReadAhead(fv, zv, &data);
+		int i;
+		if (len == 0)
+			break;
+		for (i = 0; (i < len) && (zv->PktOutCount <= zv->BlkLen - 2); i++)
+			ZPutBin(zv, &(zv->PktOutCount), data[i]);
+		zv->CRC = UpdateCRCBuf(data, i, zv->CRC);
+		zv->ByteCount += i;
+	}
 
 	fv->InfoOp->SetDlgByteCount(fv, zv->ByteCount);
 	fv->InfoOp->SetDlgPercent(fv, zv->ByteCount, zv->FileSize, &zv->ProgStat);
 	fv->InfoOp->SetDlgTime(fv, zv->StartTime, zv->ByteCount);
+	ZBlkLenGood(zv, zv->ByteCount - zv->Pos);
 	zv->Pos = zv->ByteCount;
 
 	zv->PktOut[zv->PktOutCount] = ZDLE;
 	zv->PktOutCount++;
 	if (zv->Pos >= zv->FileSize)
 		b = ZCRCE;
-	else if ((zv->WinSize >= 0) && (zv->Pos - zv->LastPos > zv->WinSize))
+	else if ((zv->WinSize >= 0) &&
+			 ((zv->Pos - zv->LastPos > zv->WinSize) || (zv->Pos - zv->QPos >= zv->WinSize / 2))) {
 		b = ZCRCQ;
+		zv->QPos = zv->Pos;
+	}
 	else
 		b = ZCRCG;
 	zv->PktOut[zv->PktOutCount] = b;
@@ -685,12 +779,12 @@ static void ZSendDataDat(PFileVarProto fv, PZVar zv)
 
 	zv->PktOutPtr = 0;
 	zv->Sending = TRUE;
-	if (b == ZCRCQ)
+	if ((b == ZCRCQ) && (zv->Pos - zv->LastPos > zv->WinSize))
 		zv->ZState = Z_SendDataDat2;	/* wait response from receiver */
 	else
 		zv->ZState = Z_SendDataDat;
 
-	add_sendbuf("%s: ", __FUNCTION__);
+	add_sendbuf("%s: len=%d ", __FUNCTION__, zv->BlkLen);
 }
 
 static BOOL ZInit(PFileVarProto fv, PComVar cv, PTTSet ts)
@@ -728,6 +822,7 @@ static BOOL ZInit(PFileVarProto fv, PComVar cv, PTTSet ts)
 	zv->PktOutCount = 0;
 	zv->Pos = 0;
 	zv->LastPos = 0;
+	zv->QPos = 0;
 	zv->ZPktState = Z_PktGetPAD;
 	zv->Sending = FALSE;
 	zv->LastSent = 0;
@@ -744,7 +839,7 @@ static BOOL ZInit(PFileVarProto fv, PComVar cv, PTTSet ts)
 	/* Time out & Max block size */
 	if (cv->PortType == IdTCPIP) {
 		zv->TimeOut = ts->ZmodemTimeOutTCPIP;
-		Max = 1024;
+		Max = ZMAXDATALEN;
 	} else {
 		zv->TimeOut = ts->ZmodemTimeOutNormal;
 		if (ts->Baud <= 110) {
@@ -765,6 +860,7 @@ static BOOL ZInit(PFileVarProto fv, PComVar cv, PTTSet ts)
 	}
 	if (zv->MaxDataLen > Max)
 		zv->MaxDataLen = Max;
+	zv->GoodNeeded = 8192;
 
 	if ((ts->LogFlag & LOG_Z) != 0) {
 		TProtoLog* log = ProtoLogCreate();
@@ -821,14 +917,10 @@ static BOOL ZCheckHdr(PFileVarProto fv, PZVar zv)
 	BOOL Ok;
 
 	if (zv->CRC32) {
-		zv->CRC3 = 0xFFFFFFFF;
-		for (i = 0; i <= 8; i++)
-			zv->CRC3 = UpdateCRC32(zv->PktIn[i], zv->CRC3);
+		zv->CRC3 = UpdateCRC32Buf(zv->PktIn, 9, 0xFFFFFFFF);
 		Ok = zv->CRC3 == 0xDEBB20E3;
 	} else {
-		zv->CRC = 0;
-		for (i = 0; i <= 6; i++)
-			zv->CRC = UpdateCRC(zv->PktIn[i], zv->CRC);
+		zv->CRC = UpdateCRCBuf(zv->PktIn, 7, 0);
 		Ok = zv->CRC == 0;
 	}
 
@@ -879,6 +971,8 @@ static void ZParseRInit(PFileVarProto fv, PZVar zv)
 
 	/* file open */
 	zv->FileOpen = file->OpenRead(file, zv->FullName);
+	zv->ReadBufPos = 0;
+	zv->ReadBufLen = 0;
 
 	if (zv->CtlEsc) {
 		if ((zv->RxHdr[ZF0] & ESCCTL) == 0) {
@@ -889,11 +983,14 @@ static void ZParseRInit(PFileVarProto fv, PZVar zv)
 	} else
 		zv->CtlEsc = (zv->RxHdr[ZF0] & ESCCTL) != 0;
 
+	/* M̃obt@ (0 ̂Ƃ͐Ȃ) */
 	Max = (zv->RxHdr[ZP1] << 8) + zv->RxHdr[ZP0];
-	if (Max <= 0)
-		Max = 1024;
-	if (zv->MaxDataLen > Max)
+	if ((Max > 0) && (zv->MaxDataLen > Max))
 		zv->MaxDataLen = Max;
+	/* 1024 𒴂Ƃ 1024 n߂ăG[ȂΑ傫 */
+	zv->BlkLen = zv->MaxDataLen;
+	if (zv->BlkLen > 1024)
+		zv->BlkLen = 1024;
 
 	zv->ZState = Z_SendFileHdr;
 	ZSendFileHdr(zv);
@@ -931,16 +1028,21 @@ static void ZParseHdr(PFileVarProto fv, PZVar zv, PComVar cv)
 		case Z_SendInitDat:
 			ZSendFileHdr(zv);
 			break;
-		case Z_SendDataDat2:
-			zv->LastPos = ZRclHdr(zv);
-			if (zv->Pos == zv->LastPos)
-				ZSendDataDat(fv, zv);
-			else {
-				zv->Pos = zv->LastPos;
-				ZSendDataHdr(zv);
+		case Z_SendDataDat:
+		case Z_SendDataDat2: {
+			/* ɑ ZCRCQ ̉͂̂ŁAmFʒui߂邾 */
+			LONG pos = ZRclHdr(zv);
+			if ((pos > zv->LastPos) && (pos <= zv->Pos))
+				zv->LastPos = pos;
+			if ((zv->ZState == Z_SendDataDat2) && (zv->Pos - zv->LastPos <= zv->WinSize)) {
+				/* EBhE󂢂̂őMĊJ (M̃pPbǧɑ) */
+				zv->ZState = Z_SendDataDat;
+				if (!zv->Sending)
+					ZSendDataDat(fv, zv);
 			}
 			break;
 		}
+		}
 		break;
 	case ZFILE:
 		zv->ZPktState = Z_PktGetData;
@@ -1000,8 +1102,11 @@ static void ZParseHdr(PFileVarProto fv, PZVar zv, PComVar cv)
 		case Z_SendDataDat:
 		case Z_SendDataDat2:
 		case Z_SendEOF:
+			if (zv->ZState != Z_SendFileDat)
+				ZBlkLenError(zv);	/* MŃG[ */
 			zv->Pos = ZRclHdr(zv);
 			zv->LastPos = zv->Pos;
+			zv->QPos = zv->Pos;
 			add_recvbuf(" pos=%ld", zv->Pos);
 			ZSendDataHdr(zv);
 			break;
@@ -1136,8 +1241,6 @@ static BOOL ZParseFile(PFileVarProto fv, PZVar zv)
 static BOOL ZWriteData(PFileVarProto fv, PZVar zv)
 {
 	TFileIO *file = fv->file;
-	int i;
-	BYTE b;
 
 	if (zv->ZState != Z_RecvData)
 		return FALSE;
@@ -1146,16 +1249,11 @@ static BOOL ZWriteData(PFileVarProto fv, PZVar zv)
 
 	if (zv->BinFlag)
 		file->WriteFile(file, zv->PktIn, zv->PktInPtr);
-	else
-		for (i = 0; i <= zv->PktInPtr - 1; i++) {
-			b = zv->PktIn[i];
-			if ((b == 0x0A) && (!zv->CRRecv))
-				file->WriteFile(file, "\015", 1);
-			if (zv->CRRecv && (b != 0x0A))
-				file->WriteFile(file, "\012", 1);
-			zv->CRRecv = b == 0x0D;
-			file->WriteFile(file, &b, 1);
-		}
+	else {
+		BYTE buf[sizeof(zv->PktIn) * 2];
+		size_t len = FTConvRecvNewLine(zv->PktIn, zv->PktInPtr, buf, &zv->CRRecv);
+		file->WriteFile(file, buf, len);
+	}
 
 	zv->ByteCount = zv->ByteCount + zv->PktInPtr;
 	zv->Pos = zv->Pos + zv->PktInPtr;
@@ -1247,6 +1345,7 @@ static BOOL ZParse(PFileVarProto fv, PComVar cv)
 	PZVar zv = fv->data;
 	BYTE b;
 	int c;
+	BOOL blocked = FALSE;
 
 	do {
 		/* Send packet */
@@ -1260,6 +1359,8 @@ static BOOL ZParse(PFileVarProto fv, PComVar cv)
 			}
 			if (zv->PktOutCount <= 0)
 				zv->Sending = FALSE;
+			else
+				blocked = TRUE;	/* Mobt@t */
 			if ((zv->ZMode == IdZReceive) && (zv->PktOutCount > 0))
 				return TRUE;
 		}
@@ -1425,7 +1526,7 @@ static BOOL ZParse(PFileVarProto fv, PComVar cv)
 					else
 						zv->CRC = UpdateCRC(b, zv->CRC);
 					if (zv->ZPktState == Z_PktGetData) {
-						if (zv->PktInPtr < 1024) {
+						if (zv->PktInPtr < ZMAXDATALEN) {
 							zv->PktIn[zv->PktInPtr] = b;
 							zv->PktInPtr++;
 						} else
@@ -1482,7 +1583,8 @@ static BOOL ZParse(PFileVarProto fv, PComVar cv)
 				break;
 			}
 
-		if (zv->Sending && (zv->PktOutCount > 0))
+		/* Mobt@󂢂ĂԂ͑ăpPbg𑗂 */
+		if (blocked)
 			return TRUE;
 	} while (zv->Sending);
 
@@ -1548,6 +1650,7 @@ BOOL ZCreate(PFileVarProto fv)
 	}
 	memset(zv, 0, sizeof(*zv));
 	zv->FileOpen = FALSE;
+	ZMakeEscTable();
 	fv->data = zv;
 	fv->ProtoOp = &Op;
 
@@ -208,6 +208,7 @@ BOOL InitTTL(HWND HWin)
 	NewStrVar("groupmatchstr7","");   // for 'waitregex' command (2005.10.15 yutaka)
 	NewStrVar("groupmatchstr8","");   // for 'waitregex' command (2005.10.15 yutaka)
 	NewStrVar("groupmatchstr9","");   // for 'waitregex' command (2005.10.15 yutaka)
+	NewIntVar("matchpos",0);    // for 'wait', 'waitln', 'waitlist' command
 
 	if (ParamCnt == 0) {
 		ParamCnt++;
@@ -320,6 +321,11 @@ void EndTTL()
 		KillTimer(HMainWin,IdTimeOutTimer);
 	CloseBuff(0);
 	EndVar();
+
+	// waitregex ̃RpCςݐK\Ă Oniguruma I
+	ClearWait();
+	onig_end();
+	FreeRecvLnBuff();
 }
 
 #if 0
@@ -1215,6 +1221,7 @@ static WORD TTLExecCmnd(void)
 	strncpy_s(LineBuff, sizeof(LineBuff),NextLine, _TRUNCATE);
 	LineLen = (WORD)strlen(LineBuff);
 	LinePtr = 0;
+	ClearLineKey();
 	b = GetFirstChar();
 	LinePtr--;
 	ParseAgain = (b!=0) && (b!=':') && (b!=';');
@@ -1682,11 +1689,10 @@ static WORD TTLFileRead(void)
 	TVarId VarId;
 	int fhi;
 	HANDLE FH;
-	int i, c;
+	int c;
 	int ReadByte;   // ǂݍރoCg
-	TStrVal Str;
+	char *Str;
 	BOOL EndFile;
-	BYTE b;
 
 	Err = 0;
 	GetIntVal(&fhi,&Err);
@@ -1695,30 +1701,24 @@ static WORD TTLFileRead(void)
 	GetStrVar(&VarId,&Err);
 	if ((Err==0) && (GetFirstChar()!=0))
 		Err = ErrSyntax;
-	if ((Err==0) && (ReadByte < 1 || ReadByte > MaxStrLen-1))  // ͈̓`FbN
+	if ((Err==0) && (ReadByte < 1))  // ͈̓`FbN
 		Err = ErrSyntax;
 	if (Err!=0) return Err;
 
-	EndFile = FALSE;
-	for (i = 0 ; i < ReadByte ; i++) {
-		c = win16_lread(FH,&b,1);
-		if (c <= 0) {  // EOF
-			EndFile = TRUE;
-			break;
-		}
-		if (i<MaxStrLen-1)
-		{
-			Str[i] = b;
-		}
-	}
+	// ǂݍރoCgɏ͂ȂA܂Ƃ߂ēǂݍ
+	Str = (char *)malloc((size_t)ReadByte + 1);
+	if (Str == NULL) return ErrFewMemory;
+	c = win16_lread(FH, Str, ReadByte);
+	EndFile = (c < ReadByte);  // EOF
 
 	if (EndFile)
 		SetResult(1);
 	else
 		SetResult(0);
 
-	Str[i] = 0;
+	Str[c] = 0;
 	SetStrVal(VarId,Str);
+	free(Str);
 	return Err;
 }
 
@@ -4617,7 +4617,6 @@ exit1:
 	onig_region_free(region, 1);
 exit2:
 	onig_free(reg);
-	onig_end();
 
 	return Err;
 }
@@ -4706,15 +4705,16 @@ static WORD TTLStrCompare(void)
 	TStrVal Str1, Str2;
 	WORD Err;
 	int i;
+	const char *s1, *s2;
 
 	Err = 0;
-	GetStrVal(Str1,&Err);
-	GetStrVal(Str2,&Err);
+	s1 = GetStrValRef(Str1,&Err);
+	s2 = GetStrValRef(Str2,&Err);
 	if ((Err==0) && (GetFirstChar()!=0))
 		Err = ErrSyntax;
 	if (Err!=0) return Err;
 
-	i = strcmp(Str1,Str2);
+	i = strcmp(s1,s2);
 	if (i<0)
 		i = -1;
 	else if (i>0)
@@ -4728,19 +4728,18 @@ static WORD TTLStrConcat(void)
 	TVarId VarId;
 	WORD Err;
 	TStrVal Str;
+	const char *add;
 
 	Err = 0;
 	GetStrVar(&VarId,&Err);
-	GetStrVal(Str,&Err);
+	add = GetStrValRef(Str,&Err);
 	if ((Err==0) && (GetFirstChar()!=0))
 		Err = ErrSyntax;
 	if (Err!=0) return Err;
 
-	char dest[MaxStrLen];
-	const char *src = StrVarPtr(VarId);
-	strcpy_s(dest, MaxStrLen, src);
-	strncat_s(dest, MaxStrLen, Str, _TRUNCATE);
-	SetStrVal(VarId, dest);
+	// ϐ̗̈L΂Ēǉ (̐Ȃ)
+	if (! AppendStrVal(VarId, add))
+		Err = ErrFewMemory;
 	return Err;
 }
 
@@ -4750,9 +4749,11 @@ static WORD TTLStrCopy(void)
 	TVarId VarId;
 	int From, Len, SrcLen;
 	TStrVal Str;
+	const char *src;
+	char *dest;
 
 	Err = 0;
-	GetStrVal(Str,&Err);
+	src = GetStrValRef(Str,&Err);
 	GetIntVal(&From,&Err);
 	GetIntVal(&Len,&Err);
 	GetStrVar(&VarId,&Err);
@@ -4761,13 +4762,15 @@ static WORD TTLStrCopy(void)
 	if (Err!=0) return Err;
 
 	if (From<1) From = 1;
-	SrcLen = strlen(Str)-From+1;
+	SrcLen = strlen(src)-From+1;
 	if (Len > SrcLen) Len = SrcLen;
 	if (Len < 0) Len = 0;
-	char dest[MaxStrLen];
-	memcpy(dest,&(Str[From-1]),Len);
+	dest = (char *)malloc(Len + 1);
+	if (dest == NULL) return ErrFewMemory;
+	memcpy(dest,&(src[From-1]),Len);
 	dest[Len] = 0;
 	SetStrVal(VarId, dest);
+	free(dest);
 	return Err;
 }
 
@@ -4775,13 +4778,14 @@ static WORD TTLStrLen(void)
 {
 	WORD Err;
 	TStrVal Str;
+	const char *p;
 
 	Err = 0;
-	GetStrVal(Str,&Err);
+	p = GetStrValRef(Str,&Err);
 	if ((Err==0) && (GetFirstChar()!=0))
 		Err = ErrSyntax;
 	if (Err!=0) return Err;
-	SetResult(strlen(Str));
+	SetResult(strlen(p));
 	return Err;
 }
 
@@ -4823,22 +4827,23 @@ static WORD TTLStrScan(void)
 {
 	WORD Err;
 	TStrVal Str1, Str2;
+	const char *s1, *s2;
 
 	Err = 0;
-	GetStrVal(Str1,&Err);
-	GetStrVal(Str2,&Err);
+	s1 = GetStrValRef(Str1,&Err);
+	s2 = GetStrValRef(Str2,&Err);
 	if ((Err==0) && (GetFirstChar()!=0))
 		Err = ErrSyntax;
 	if (Err!=0) return Err;
 
-	if ((Str1[0] == 0) || (Str2[0] == 0)) {
+	if ((s1[0] == 0) || (s2[0] == 0)) {
 		SetResult(0);
 		return Err;
 	}
 
-	char *p = strstr(Str1, Str2);
+	const char *p = strstr(s1, s2);
 	if (p != NULL) {
-		SetResult(p - Str1 + 1);
+		SetResult(p - s1 + 1);
 	}
 	else {
 		SetResult(0);
@@ -4846,7 +4851,7 @@ static WORD TTLStrScan(void)
 	return Err;
 }
 
-static void insert_string(char *str, int index, char *addstr)
+static void insert_string(char *str, int index, const char *addstr)
 {
 	char *np;
 	int srclen;
@@ -4857,7 +4862,7 @@ static void insert_string(char *str, int index, char *addstr)
 
 	// ܂͑}ӏȍ~̃f[^AɈړB
 	np = str + (index - 1);
-	memmove_s(np + addlen, MaxStrLen, np, srclen - (index - 1));
+	memmove(np + addlen, np, srclen - (index - 1));
 
 	// }
 	memcpy(np, addstr, addlen);
@@ -4873,31 +4878,30 @@ static WORD TTLStrInsert(void)
 	int Index;
 	TStrVal Str;
 	int srclen, addlen;
-	char *srcptr;
+	const char *add;
+	char *dest;
 
 	Err = 0;
 	GetStrVar(&VarId,&Err);
 	GetIntVal(&Index,&Err);
-	GetStrVal(Str,&Err);
+	add = GetStrValRef(Str,&Err);
 	if ((Err==0) && (GetFirstChar()!=0))
 		Err = ErrSyntax;
 	if (Err!=0) return Err;
 
-	char dest[MaxStrLen];
-	strcpy_s(dest, sizeof(dest), StrVarPtr(VarId));
-	srcptr = dest;
-	srclen = strlen(srcptr);
+	srclen = strlen(StrVarPtr(VarId));
 	if (Index <= 0 || Index > srclen+1) {
 		Err = ErrSyntax;
 	}
-	addlen = strlen(Str);
-	if (srclen + addlen + 1 > MaxStrLen) {
-		Err = ErrSyntax;
-	}
 	if (Err!=0) return Err;
 
-	insert_string(srcptr, Index, Str);
+	addlen = strlen(add);
+	dest = (char *)malloc(srclen + addlen + 1);
+	if (dest == NULL) return ErrFewMemory;
+	memcpy(dest, StrVarPtr(VarId), srclen + 1);
+	insert_string(dest, Index, add);
 	SetStrVal(VarId, dest);
+	free(dest);
 
 	return Err;
 }
@@ -4930,7 +4934,7 @@ static void remove_string(char *str, int index, int len)
 	np = str + (index - 1);
 	copylen = srclen - len - (index - 1);
 	if (copylen > 0)
-		memmove_s(np, MaxStrLen, np + len, copylen);
+		memmove(np, np + len, copylen);
 
 	// null-terminate
 	str[srclen - len] = '\0';
@@ -4952,17 +4956,17 @@ static WORD TTLStrRemove(void)
 		Err = ErrSyntax;
 	if (Err!=0) return Err;
 
-	char dest[MaxStrLen];
-	strcpy_s(dest, sizeof(dest), StrVarPtr(VarId));
-	srcptr = dest;
+	srcptr = _strdup(StrVarPtr(VarId));
+	if (srcptr == NULL) return ErrFewMemory;
 	srclen = strlen(srcptr);
 	if (Len <=0 || Index <= 0 || (Index-1 + Len) > srclen) {
 		Err = ErrSyntax;
 	}
-	if (Err!=0) return Err;
-
-	remove_string(srcptr, Index, Len);
-	SetStrVal(VarId, dest);
+	if (Err==0) {
+		remove_string(srcptr, Index, Len);
+		SetStrVal(VarId, srcptr);
+	}
+	free(srcptr);
 
 	return Err;
 }
@@ -4973,10 +4977,12 @@ static WORD TTLStrReplace(void)
 	TVariableType VarType;
 	TVarId DestVarId;
 	TStrVal oldstr;
-	TStrVal newstr;
-	TStrVal tmpstr;
+	TStrVal Str;
+	char *newstr = NULL;
+	char *tmpstr = NULL;
+	char *dest;
 	char *p;
-	int srclen, oldlen, matchlen;
+	int srclen, oldlen, newlen, matchlen;
 	int pos, ret;
 	int result = 0;
 
@@ -4984,13 +4990,19 @@ static WORD TTLStrReplace(void)
 	GetStrVar(&DestVarId,&Err);
 	GetIntVal(&pos,&Err);
 	GetStrVal(oldstr,&Err);
-	GetStrVal(newstr,&Err);
+	p = (char *)GetStrValRef(Str,&Err);
 	if ((Err==0) && (GetFirstChar()!=0))
 		Err = ErrSyntax;
 	if (Err!=0) return Err;
 
-	const char *srcptr = StrVarPtr(DestVarId);
-	srclen = strlen(srcptr);
+	//  matchstr ̂ŁAu̕ƑΏە̓Rs[Ă
+	newstr = _strdup(p);
+	tmpstr = _strdup(StrVarPtr(DestVarId));
+	if (newstr == NULL || tmpstr == NULL) {
+		Err = ErrFewMemory;
+		goto error;
+	}
+	srclen = strlen(tmpstr);
 
 	if (pos > srclen || pos <= 0) {
 		result = 0;
@@ -4998,8 +5010,6 @@ static WORD TTLStrReplace(void)
 	}
 	pos--;
 
-	strncpy_s(tmpstr, MaxStrLen, srcptr, _TRUNCATE);
-
 	oldlen = strlen(oldstr);
 
 	// strptr pos ڈȍ~ɂāAoldstr TB
@@ -5029,15 +5039,24 @@ static WORD TTLStrReplace(void)
 		goto error;
 	}
 
-	char dest[MaxStrLen];
-	strncpy_s(dest, sizeof(dest), tmpstr, pos + ret);
-	strncat_s(dest, sizeof(dest), newstr, _TRUNCATE);
-	strncat_s(dest, sizeof(dest), tmpstr + pos + ret + matchlen, _TRUNCATE);
+	newlen = strlen(newstr);
+	dest = (char *)malloc(srclen - matchlen + newlen + 1);
+	if (dest == NULL) {
+		Err = ErrFewMemory;
+		goto error;
+	}
+	memcpy(dest, tmpstr, pos + ret);
+	memcpy(dest + pos + ret, newstr, newlen);
+	memcpy(dest + pos + ret + newlen, tmpstr + pos + ret + matchlen, srclen - (pos + ret + matchlen) + 1);
 	SetStrVal(DestVarId, dest);
+	free(dest);
 
 	result = 1;
 
 error:
+	free(newstr);
+	free(tmpstr);
+	if (Err!=0) return Err;
 	SetResult(result);
 	return Err;
 }
@@ -5052,24 +5071,25 @@ static WORD TTLStrSpecial(void)
 	GetStrVar(&VarId,&Err);
 	if (Err!=0) return Err;
 
+	const char *src;
 	if (CheckParameterGiven()) { // strspecial strvar strval
-		GetStrVal(srcstr,&Err);
+		src = GetStrValRef(srcstr,&Err);
 		if ((Err==0) && (GetFirstChar()!=0))
 			Err = ErrSyntax;
 		if (Err!=0) {
 			return Err;
 		}
-
-		RestoreNewLine(srcstr);
-		SetStrVal(VarId, srcstr);
 	}
 	else { // strspecial strvar
-		char dest[MaxStrLen];
-		strcpy_s(dest, sizeof(dest), StrVarPtr(VarId));
-		RestoreNewLine(dest);
-		SetStrVal(VarId, dest);
+		src = StrVarPtr(VarId);
 	}
 
+	char *dest = _strdup(src);
+	if (dest == NULL) return ErrFewMemory;
+	RestoreNewLine(dest);
+	SetStrVal(VarId, dest);
+	free(dest);
+
 	return Err;
 }
 
@@ -5091,9 +5111,8 @@ static WORD TTLStrTrim(void)
 		Err = ErrSyntax;
 	if (Err!=0) return Err;
 
-	char dest[MaxStrLen];
-	strcpy_s(dest, sizeof(dest), StrVarPtr(VarId));
-	srcptr = dest;
+	srcptr = _strdup(StrVarPtr(VarId));
+	if (srcptr == NULL) return ErrFewMemory;
 	srclen = strlen(srcptr);
 
 	// 폜镶̃e[uB
@@ -5126,14 +5145,17 @@ static WORD TTLStrTrim(void)
 	// ɁA擪B
 	remove_string(srcptr, 1, start);
 
-	SetStrVal(VarId, dest);
+	SetStrVal(VarId, srcptr);
+	free(srcptr);
 	return Err;
 }
 
 static WORD TTLStrSplit(void)
 {
 #define MAXVARNUM 9
-	TStrVal src, delimchars, buf;
+	TStrVal Str, delimchars;
+	const char *src;
+	char *buf;
 	WORD Err;
 	int maxvar;
 	int srclen, len;
@@ -5143,7 +5165,7 @@ static WORD TTLStrSplit(void)
 	char /* *last, */ *tok[MAXVARNUM];
 
 	Err = 0;
-	GetStrVal(src,&Err);
+	src = GetStrValRef(Str,&Err);
 	GetStrVal(delimchars,&Err);
 	// 3rd arg (optional)
 	if (CheckParameterGiven()) {
@@ -5177,7 +5199,9 @@ static WORD TTLStrSplit(void)
 		return ErrSyntax;
 
 	srclen = strlen(src);
-	strcpy_s(buf, MaxStrLen, src);  /* j󂳂Ă悤ɁARs[obt@gB*/
+	buf = _strdup(src);  /* j󂳂Ă悤ɁARs[obt@gB*/
+	if (buf == NULL)
+		return ErrFewMemory;
 
 #if 0
 	// g[N̐؂osB
@@ -5240,6 +5264,7 @@ static WORD TTLStrSplit(void)
 	for (i = count+1 ; i <= MAXVARNUM ; i++) {
 		SetGroupMatchStr(i, "");
 	}
+	free(buf);
 	SetResult(count);
 	return Err;
 #undef MAXVARNUM
@@ -5255,8 +5280,10 @@ static WORD TTLStrJoin(void)
 	int maxvar;
 	int i;
 	BOOL ary = FALSE;
-	char *srcptr;
 	const char *p;
+	const char *str[MAXVARNUM];
+	size_t len, delimlen;
+	char *dest;
 
 	Err = 0;
 	GetStrVar(&TargetVarId,&Err);
@@ -5286,11 +5313,10 @@ static WORD TTLStrJoin(void)
 	if (!ary && (maxvar < 1 || maxvar > MAXVARNUM) )
 		return ErrSyntax;
 
-	char dest[MaxStrLen];
-	strcpy_s(dest, sizeof(dest), StrVarPtr(TargetVarId));
-	srcptr = dest;
-
-	srcptr[0] = '\0';
+	// A̒߂ĂxɊmۂ
+	len = 0;
+	delimlen = strlen(delimchars);
+	memset(str, 0, sizeof(str));
 	if (ary) {
 		// TODO array
 	}
@@ -5301,15 +5327,32 @@ static WORD TTLStrJoin(void)
 			if (CheckVar(buf,&VarType,&VarId)) {
 				if (VarType!=TypString)
 					return ErrSyntax;
-				p = StrVarPtr(VarId);
-				strncat_s(srcptr, MaxStrLen, p, _TRUNCATE);
+				str[i] = StrVarPtr(VarId);
+				len += strlen(str[i]);
 				if (i < maxvar-1) {
-					strncat_s(srcptr, MaxStrLen, delimchars, _TRUNCATE);
+					len += delimlen;
 				}
 			}
 		}
 	}
+
+	dest = (char *)malloc(len + 1);
+	if (dest == NULL) return ErrFewMemory;
+	len = 0;
+	for (i = 0 ; i < maxvar ; i++) {
+		p = str[i];
+		if (p == NULL)
+			continue;
+		memcpy(dest + len, p, strlen(p));
+		len += strlen(p);
+		if (i < maxvar-1) {
+			memcpy(dest + len, delimchars, delimlen);
+			len += delimlen;
+		}
+	}
+	dest[len] = '\0';
 	SetStrVal(TargetVarId, dest);
+	free(dest);
 
 	return Err;
 #undef MAXVARNUM
@@ -5482,6 +5525,80 @@ static WORD TTLWait(BOOL Ln)
 }
 
 
+// 'waitlist': z̗vf̂ꂩ҂
+//   waitlist <strarray> [<count>]
+//
+// wait ƓA҂̐ 10 ɐȂB
+// <count> ȗƔz̑Svf҂B󕶎̗vf͖B
+// result ɂ͈vvf̓Y + 1 B
+// matchpos ɂ͈v̐擪ʒu (waitlist Jn琔MoCg) B
+static WORD TTLWaitList(void)
+{
+	WORD Err = 0;
+	TVariableType ValType;
+	TVarId VarId, id;
+	int i, n, count;
+	int TimeOut;
+	const char *Str;
+
+	GetStrAryVar(&VarId,&Err);
+	if (Err!=0) return Err;
+	count = GetStrAryVarSize(VarId);
+	if (CheckParameterGiven()) {
+		GetIntVal(&n,&Err);
+		if ((Err==0) && (n < 0))
+			Err = ErrSyntax;
+		if ((Err==0) && (n < count))
+			count = n;
+	}
+	if ((Err==0) && (GetFirstChar()!=0))
+		Err = ErrSyntax;
+	if ((Err==0) && (! Linked))
+		Err = ErrLinkFirst;
+	if (Err!=0) return Err;
+
+	ClearWait();
+
+	n = 0;
+	for (i=0; i<count; i++) {
+		id = GetStrVarFromArray(VarId, i, &Err);
+		if (Err!=0)
+			break;
+		Str = StrVarPtr(id);
+		if (Str[0] == 0)
+			continue;
+		if (! AddWaitList(i+1, Str)) {
+			Err = ErrFewMemory;
+			break;
+		}
+		n++;
+	}
+
+	if ((Err==0) && (n>0))
+	{
+		TTLStatus = IdTTLWait;
+		TimeOut = 0;
+		if (CheckVar("timeout",&ValType,&VarId) && (ValType==TypInteger)) {
+			TimeOut = CopyIntVal(VarId) * 1000;
+		}
+		if (CheckVar("mtimeout",&ValType,&VarId) && (ValType==TypInteger)) {
+			TimeOut += CopyIntVal(VarId);
+		}
+
+		if (TimeOut>0)
+		{
+			TimeLimit = (DWORD)TimeOut;
+			TimeStart = GetTickCount();
+			SetTimer(HMainWin, IdTimeOutTimer, TIMEOUT_TIMER_MS, NULL);
+		}
+	}
+	else
+		ClearWait();
+
+	return Err;
+}
+
+
 static WORD TTLWait4all(BOOL Ln)
 {
 	WORD Err = 0;
@@ -5839,7 +5956,7 @@ static int ExecCmnd(void)
 
 	Err = 0;
 
-	Result = GetReservedWord(&WId);
+	Result = GetCommandWord(&WId);
 
 	if (EndWhileFlag>0) {
 		if (Result) {
@@ -6306,6 +6423,8 @@ static int ExecCmnd(void)
 			Err = TTLWait4all(FALSE); break;
 		case RsvWaitEvent:
 			Err = TTLWaitEvent(); break;
+		case RsvWaitList:
+			Err = TTLWaitList(); break;
 		case RsvWaitLn:
 			Err = TTLWait(TRUE); break;
 		case RsvWaitN:
@@ -6489,6 +6608,17 @@ void SetResult(int ResultCode)
 		SetIntVal(VarId,ResultCode);
 }
 
+// wait nR}hňv̈ʒuL^
+void SetMatchPos(int Pos)
+{
+	TVariableType VarType;
+	TVarId VarId;
+
+	if (CheckVar("matchpos",&VarType,&VarId) &&
+	    (VarType==TypInteger))
+		SetIntVal(VarId,Pos);
+}
+
 BOOL CheckTimeout()
 {
 	BOOL ret;
@@ -51,6 +51,7 @@ void SetMatchStr(PCHAR Str);
 void SetGroupMatchStr(int no, const char *Str);
 void SetInputStr(const char *Str);
 void SetResult(int ResultCode);
+void SetMatchPos(int Pos);
 BOOL CheckTimeout();
 BOOL TestWakeup(int Wakeup);
 void SetWakeup(int Wakeup);
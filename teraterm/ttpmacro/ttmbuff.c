@@ -85,6 +85,10 @@ static BOOL NextFlag;
 
 static int LineNo;  // line number (2005.7.18 yutaka)
 
+// LineBuff ɓǂݍ񂾍s̈ʒu (͌ʂ̃LbṼL[)
+static int LineKeyLevel;
+static BINT LineKeyStart = INVALIDPTR;
+
 void InitLineNo(void)
 {
 	LineNo = 1;
@@ -184,6 +188,9 @@ static BOOL LoadMacroFile(const wchar_t *FileName, int IBuff)
 		BuffLineNoMaxIndex[IBuff] = n + 1;
 	}
 
+	// lXgxɑOɓǂݍ񂾃t@C̉͌ʂ̂Ă
+	ClearParseCache();
+
 	return TRUE;
 }
 
@@ -197,26 +204,50 @@ const char *GetMacroFileName(void)
 	return &BuffHandleFileName[INest][0];
 }
 
+/**
+ *	LineBuff ɓǂݍ񂾍s̈ʒuԂ
+ *	@param	Level	lXgx
+ *	@param	Start	s̈ʒu
+ *	@retval	FALSE	}Nt@C̍sł͂Ȃ (exec R}hŒu)
+ */
+BOOL GetLineKey(int *Level, BINT *Start)
+{
+	if (LineKeyStart == INVALIDPTR) {
+		return FALSE;
+	}
+	*Level = LineKeyLevel;
+	*Start = LineKeyStart;
+	return TRUE;
+}
+
+// LineBuff }Nt@CȊO̓eŒuƂɌĂ
+void ClearLineKey(void)
+{
+	LineKeyStart = INVALIDPTR;
+}
+
 
 // ݎs̃}Nt@C̍sԍԂ (2005.7.18 yutaka)
 static int getCurrentLineNumber(BINT curpos, BINT *lineno, BINT linenomax)
 {
-	BINT i, no;
-
-	no = 0;
-	for (i = 0 ; i < linenomax ; i++) {
-		if (curpos < lineno[i]) {
-			no = i;
-			break;
+	BINT lo, hi, mid;
+
+	// sʒu̔z͏Ȃ̂ŁAcurpos ȉ̍s̐񕪒TŐB
+	// sƂɌĂ΂̂ŁA擪̐`Tƒ}NŒxȂB
+	// Ō̍sp[Xۂ linenomax ԂB
+	lo = 0;
+	hi = linenomax;
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (curpos < lineno[mid]) {
+			hi = mid;
+		}
+		else {
+			lo = mid + 1;
 		}
-	}
-	// Ō̍sp[XہAsԍԂĂȂCB
-	// (2014.7.6 yutaka)
-	if (no == 0 && i == linenomax) {
-		no = linenomax;
 	}
 
-	return (no);
+	return (lo);
 }
 
 
@@ -232,7 +263,6 @@ BOOL GetRawLine()
 		b = (Buff[INest])[BuffPtr[INest]];
 
 	i = 0;
-	memset(LineBuff, 0, sizeof(LineBuff));
 	while ((BuffPtr[INest]<BuffLen[INest]) &&
 		((b>=0x20) || (b==0x09)))
 	{
@@ -251,9 +281,17 @@ BOOL GetRawLine()
 		if (BuffPtr[INest]<BuffLen[INest])
 			b = (Buff[INest])[BuffPtr[INest]];
 	}
+	// obt@Ŝ̓NAAsI[
+	// (sɂ 0x00 ܂܂Ȃ̂ strlen() ƓɂȂ)
+	if (i > MaxLineLen-1) {
+		i = MaxLineLen-1;
+	}
+	LineBuff[i] = 0;
 	LinePtr = 0;
-	LineLen = (WORD)strlen(LineBuff);
+	LineLen = (WORD)i;
 	LineParsePtr = 0;
+	LineKeyLevel = INest;
+	LineKeyStart = LineStart;
 
 	// current line number (2005.7.18 yutaka)
 	// obt@̃CfbNX獂ɍsԍ悤ɂB(2014.1.18 yutaka)
@@ -29,6 +29,8 @@
 
 /* TTMACRO.EXE, Macro file buffer */
 
+#include "ttmparse.h"	// for BINT
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -59,6 +61,8 @@ char *GetLineBuffer(void);
 int IsUpdateMacroCommand(void);
 WORD BreakLoop(WORD WId);
 const char *GetMacroFileName(void);
+BOOL GetLineKey(int *Level, BINT *Start);
+void ClearLineKey(void);
 
 extern int EndWhileFlag;
 extern int BreakFlag;
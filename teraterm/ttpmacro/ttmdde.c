@@ -47,6 +47,7 @@
 #include "ttl.h"
 
 #include "wait4all.h"
+#include "waitmatch.h"
 
 #include "ttmonig.h"
 
@@ -69,10 +70,10 @@ OnigSyntaxType *RegexSyntax = ONIG_SYNTAX_RUBY;
 #define OutBufSize 512
 // Oobt@ 4KB  16KB ֊g (2006.10.15 yutaka)
 // Tera Term{̂ SendSync 𑗂Ƃ̏`FbN 8KB ɂB
-// Tera Term{̑DDEobt@ 1KB Ȃ̂ŁA傫Ȓlɂ邱ƂŁA
-// Tera Termƃ}NXbVOԂɂȂ邱ƂhB
-#define RingBufSize (4096*4)
-#define RCountLimit (RingBufSize/2)
+// 񓯊[hł Tera Term{̑1 DDE ] 8KB ܂łɗ}̂ŁA
+// ǂ̃f[^ 8KB ȉȂ㏑ȂBTCY͖{̂ƋL (ttddecmnd.h)B
+#define RingBufSize DdeMacroRingBufSize
+#define RCountLimit DdeMacroRCountLimit
 
 static HWND HMainWin = NULL;
 static DWORD Inst = 0;
@@ -98,14 +99,29 @@ static int RBufCount = 0;
   // for 'Wait' command
 static PCHAR PWaitStr[10];
 static int WaitStrLen[10];
-static int WaitCount[10];
+  // 'wait', 'wait4all', 'waitlist' ̏ƍpI[g}g
+static WaitMatch_t *WaitMatch = NULL;
+static BOOL WaitMatchDirty = FALSE;		// PWaitStr[] ύXꂽ̂ō蒼
+static WaitMatchStream_t WaitStream;
+static WaitMatchStream_t Wait4allStream[MAXNWIN];
+static int WaitMatchPos = -1;		// v̐擪ʒu (wait R}hJn琔oCg)
+  // for 'WaitRegex' command
+  // p^[ƂɃRpCς݂̐K\ێ (쐬̃IvVoĂ)
+static regex_t *WaitRegex[10];
+static BOOL WaitRegexError[10];
+static OnigOptionType WaitRegexOpt[10];
+static OnigEncoding WaitRegexEnc[10];
+static OnigSyntaxType *WaitRegexSyntax[10];
+static OnigRegion *WaitRegion = NULL;
   // for "WaitRecv" command
 static TStrVal Wait2SubStr;
 static int Wait2Count, Wait2Len;
 static int Wait2SubLen, Wait2SubPos;
  //  waitln & recvln
-static TStrVal RecvLnBuff;
+static char *RecvLnBuff = NULL;		// Kvɉ RECVLN_MAX ܂ŐL΂
+static int RecvLnBuffSize = 0;
 static int RecvLnPtr = 0;
+#define RECVLN_MAX (1024*1024)
 static BYTE RecvLnLast = 0;
 // for "WaitN" command
 static int WaitNLen = 0;
@@ -267,8 +283,8 @@ BOOL InitDDE(HWND HWin)
 	for (i = 0 ; i<=9 ; i++) {
 		PWaitStr[i] = NULL;
 		WaitStrLen[i] = 0;
-		WaitCount[i] = 0;
 	}
+	WaitMatchReset(&WaitStream);
 
 	if (DdeInitialize(&Inst, DdeCallbackProc,
 	                  APPCMD_CLIENTONLY |
@@ -467,7 +483,15 @@ void PutRecvLnBuff(BYTE b)
 	if (RecvLnLast==0x0a && RecvLnClear) {
 		ClearRecvLnBuff();
 	}
-	if (RecvLnPtr < sizeof(RecvLnBuff)-1) {
+	if (RecvLnPtr >= RecvLnBuffSize-1 && RecvLnBuffSize < RECVLN_MAX) {
+		int new_size = (RecvLnBuffSize == 0) ? MaxStrLen : RecvLnBuffSize * 2;
+		char *new_buff = (char *)realloc(RecvLnBuff, new_size);
+		if (new_buff != NULL) {
+			RecvLnBuff = new_buff;
+			RecvLnBuffSize = new_size;
+		}
+	}
+	if (RecvLnPtr < RecvLnBuffSize-1) {
 		RecvLnBuff[RecvLnPtr++] = b;
 	}
 	RecvLnLast = b;
@@ -475,6 +499,9 @@ void PutRecvLnBuff(BYTE b)
 
 PCHAR GetRecvLnBuff()
 {
+	if (RecvLnBuff == NULL) {
+		return "";
+	}
 	if ((RecvLnPtr>0) &&
 	    RecvLnBuff[RecvLnPtr-1]==0x0a) {
 		RecvLnPtr--;
@@ -488,6 +515,14 @@ PCHAR GetRecvLnBuff()
 	return RecvLnBuff;
 }
 
+void FreeRecvLnBuff()
+{
+	ClearRecvLnBuff();
+	free(RecvLnBuff);
+	RecvLnBuff = NULL;
+	RecvLnBuffSize = 0;
+}
+
 void FlushRecv()
 {
 	ClearRecvLnBuff();
@@ -496,6 +531,15 @@ void FlushRecv()
 	RBufCount = 0;
 }
 
+static void FreeWaitRegex(int i)
+{
+	if (WaitRegex[i] != NULL) {
+		onig_free(WaitRegex[i]);
+		WaitRegex[i] = NULL;
+	}
+	WaitRegexError[i] = FALSE;
+}
+
 void ClearWait()
 {
 	int i;
@@ -506,14 +550,21 @@ void ClearWait()
 		}
 		PWaitStr[i] = NULL;
 		WaitStrLen[i] = 0;
-		WaitCount[i] = 0;
+		FreeWaitRegex(i);
 	}
 
+	WaitMatchDestroy(WaitMatch);
+	WaitMatch = NULL;
+	WaitMatchDirty = FALSE;
+	WaitMatchReset(&WaitStream);
+
 	RegexActionType = REGEX_NONE; // regex disabled
 }
 
 void SetWait(int Index, const char *Str)
 {
+	FreeWaitRegex(Index-1);
+
 	if (PWaitStr[Index-1])
 		free(PWaitStr[Index-1]);
 
@@ -524,7 +575,43 @@ void SetWait(int Index, const char *Str)
 	else
 		WaitStrLen[Index-1] = 0;
 
-	WaitCount[Index-1] = 0;
+	WaitMatchDirty = TRUE;
+}
+
+// 'waitlist' p: ҂ǉ (Index  1 ȏAȂ)
+BOOL AddWaitList(int Index, const char *Str)
+{
+	if (WaitMatch == NULL) {
+		WaitMatch = WaitMatchCreate();
+		if (WaitMatch == NULL) {
+			return FALSE;
+		}
+	}
+	return WaitMatchAdd(WaitMatch, Index, Str) ? TRUE : FALSE;
+}
+
+// ƍpI[g}gԂ
+// SetWait() ŕύXĂ PWaitStr[] o^
+static WaitMatch_t *GetWaitMatch(void)
+{
+	int i;
+
+	if (WaitMatch == NULL) {
+		WaitMatch = WaitMatchCreate();
+		if (WaitMatch == NULL) {
+			return NULL;
+		}
+	}
+	if (WaitMatchDirty) {
+		WaitMatchClear(WaitMatch);
+		for (i = 0 ; i < 10 ; i++) {
+			if (PWaitStr[i] != NULL) {
+				WaitMatchAdd(WaitMatch, i+1, PWaitStr[i]);
+			}
+		}
+		WaitMatchDirty = FALSE;
+	}
+	return WaitMatch;
 }
 
 void SetRecvLnClear(BOOL v)
@@ -587,23 +674,15 @@ void SetWait2(PCHAR Str, int Len, int Pos)
 }
 
 
-// K\ɂp^[}b`siOnigurumagpj
+// K\RpC
 //
-// return : }b`ʒui1IWj
-//         0: }b`Ȃ
-int FindRegexStringOne(char *regex, int regex_len, char *target, int target_len)
+// return ̓RpCς݂̐K\As NULL
+static regex_t *CompileRegex(char *regex, int regex_len)
 {
 	int r;
-	unsigned char *start, *range, *end;
 	regex_t* reg;
 	OnigErrorInfo einfo;
-	OnigRegion *region;
 	UChar* pattern = (UChar* )regex;
-	UChar* str     = (UChar* )target;
-	int matched = 0;
-	char ch;
-	int mstart, mend;
-
 
 	r = onig_new(&reg, pattern, pattern + regex_len,
 		RegexOpt, RegexEnc, RegexSyntax, &einfo);
@@ -611,10 +690,26 @@ int FindRegexStringOne(char *regex, int regex_len, char *target, int target_len)
 		char s[ONIG_MAX_ERROR_MESSAGE_LEN];
 		onig_error_code_to_str(s, r, &einfo);
 		fprintf(stderr, "ERROR: %s\n", s);
-		return -1;
+		return NULL;
 	}
 
-	region = onig_region_new();
+	return reg;
+}
+
+// RpCς݂̐K\Ńp^[}b`sA
+// }b`ꍇ matchstr, groupmatchstr1-9 ݒ肷
+//
+// return : }b`ʒui1IWj
+//         0: }b`Ȃ
+//        -1: G[
+static int SearchRegex(regex_t *reg, OnigRegion *region, char *target, int target_len)
+{
+	int r;
+	unsigned char *start, *range, *end;
+	UChar* str     = (UChar* )target;
+	int matched = 0;
+	char ch;
+	int mstart, mend;
 
 	end   = str + target_len;
 	start = str;
@@ -667,13 +762,54 @@ int FindRegexStringOne(char *regex, int regex_len, char *target, int target_len)
 		return -1;
 	}
 
+	return (matched);
+}
+
+// K\ɂp^[}b`siOnigurumagpj
+//
+// return : }b`ʒui1IWj
+//         0: }b`Ȃ
+int FindRegexStringOne(char *regex, int regex_len, char *target, int target_len)
+{
+	regex_t* reg;
+	OnigRegion *region;
+	int matched;
+
+	reg = CompileRegex(regex, regex_len);
+	if (reg == NULL) {
+		return -1;
+	}
+
+	region = onig_region_new();
+	matched = SearchRegex(reg, region, target, target_len);
+
 	onig_region_free(region, 1 /* 1:free self, 0:free contents only */);
 	onig_free(reg);
-	onig_end();
 
 	return (matched);
 }
 
+// 'waitregex' ̃p^[̃RpCςݐK\Ԃ
+// (܂ regexoption Őݒ肪ς)RpCAȍ~͎g
+static regex_t *GetWaitRegex(int i)
+{
+	if ((WaitRegex[i] != NULL || WaitRegexError[i]) &&
+		(WaitRegexOpt[i] != RegexOpt || WaitRegexEnc[i] != RegexEnc || WaitRegexSyntax[i] != RegexSyntax)) {
+		FreeWaitRegex(i);
+	}
+	if (WaitRegex[i] == NULL && !WaitRegexError[i]) {
+		WaitRegex[i] = CompileRegex(PWaitStr[i], WaitStrLen[i]);
+		if (WaitRegex[i] == NULL) {
+			// RpCłȂp^[́AsƂɍăRpCȂ
+			WaitRegexError[i] = TRUE;
+		}
+		WaitRegexOpt[i] = RegexOpt;
+		WaitRegexEnc[i] = RegexEnc;
+		WaitRegexSyntax[i] = RegexSyntax;
+	}
+	return WaitRegex[i];
+}
+
 // K\ɂp^[}b`s
 int FindRegexString(void)
 {
@@ -685,8 +821,17 @@ int FindRegexString(void)
 	if (RecvLnPtr == 0)
 		return 0;  // not match
 
+	if (WaitRegion == NULL) {
+		WaitRegion = onig_region_new();
+	}
+
 	for (i = 0 ; i < 10 ; i++) {
-		if (PWaitStr[i] && FindRegexStringOne(PWaitStr[i], WaitStrLen[i], RecvLnBuff, RecvLnPtr) > 0) { // matched
+		regex_t *reg;
+		if (PWaitStr[i] == NULL) {
+			continue;
+		}
+		reg = GetWaitRegex(i);
+		if (reg != NULL && SearchRegex(reg, WaitRegion, RecvLnBuff, RecvLnPtr) > 0) { // matched
 			// }b`s inputstr ֊i[
 			LockVar();
 			SetInputStr(GetRecvLnBuff());  // Ńobt@NA
@@ -710,8 +855,8 @@ int FindRegexString(void)
 int Wait()
 {
 	BYTE b;
-	int i, j, Found, ret;
-	PCHAR Str;
+	int Found, ret;
+	WaitMatch_t *wm = GetWaitMatch();
 
 	Found = 0;
 	while ((Found==0) && Read1Byte(&b))
@@ -720,38 +865,19 @@ int Wait()
 			ret = FindRegexString();
 			if (ret > 0) {
 				Found = ret;
+				WaitMatchPos = -1;
 				break;
 			}
 		}
 
 		PutRecvLnBuff(b);
 
-		if (RegexActionType == REGEX_NONE) { // K\Ȃ̏ꍇ1oCg(wait command)
-			for (i = 9 ; i >= 0 ; i--) {
-				Str = PWaitStr[i];
-				if (Str!=NULL) {
-					if ((BYTE)Str[WaitCount[i]]==b) {
-						WaitCount[i]++;
-					}
-					else if (WaitCount[i]>0) {
-						for (j=WaitCount[i]-1; j>=0; j--) {
-							if ((BYTE)Str[j] == b) {
-								if (j== 0 || strncmp(Str, Str+(WaitCount[i]-j), j)==0) {
-									break;
-								}
-							}
-						}
-						if (j >= 0) {
-							WaitCount[i] = j+1;
-						}
-						else {
-							WaitCount[i] = 0;
-						}
-					}
-					if (WaitCount[i]==WaitStrLen[i]) {
-						Found = i+1;
-					}
-				}
+		if (RegexActionType == REGEX_NONE && wm != NULL) { // K\Ȃ̏ꍇ1oCg(wait command)
+			// Sp^[𓯎ɏƍBɈvꍇ͔ԍ̏̂D
+			unsigned long offset;
+			Found = WaitMatchPut(wm, &WaitStream, b, &offset);
+			if (Found > 0) {
+				WaitMatchPos = (int)offset;
 			}
 		}
 	}
@@ -761,6 +887,7 @@ int Wait()
 		ret = FindRegexString();
 		if (ret > 0) {
 			Found = ret;
+			WaitMatchPos = -1;
 		}
 	}
 
@@ -770,6 +897,14 @@ int Wait()
 	return Found;
 }
 
+// O Wait() ňv̐擪ʒuԂ
+//   wait/waitln/waitlist R}h̊Jn琔oCg (0 origin)
+//   K\ňvƂ -1
+int GetWaitMatchPos()
+{
+	return WaitMatchPos;
+}
+
 BOOL Wait2()
 {
 	BYTE b;
@@ -816,28 +951,15 @@ BOOL WaitN()
 static int Wait4allOneBuffer(int index)
 {
 	BYTE b;
-	int i, Found;
-	PCHAR Str;
+	int Found;
+	WaitMatch_t *wm = GetWaitMatch();
 
 	Found = 0;
 	while ((Found==0) && read_macro_1byte(index, &b))
 	{
-		for (i = 9 ; i >= 0 ; i--) {
-			Str = PWaitStr[i];
-			if (Str!=NULL) {
-				if ((BYTE)Str[WaitCount[i]]==b) {
-					WaitCount[i]++;
-				}
-				else if (WaitCount[i]>0) {
-					WaitCount[i] = 0;
-					if ((BYTE)Str[0]==b) {
-						WaitCount[i] = 1;
-					}
-				}
-				if (WaitCount[i]==WaitStrLen[i]) {
-					Found = i+1;
-				}
-			}
+		// ƍԂ̓obt@ƂɎ
+		if (wm != NULL) {
+			Found = WaitMatchPut(wm, &Wait4allStream[index], b, NULL);
 		}
 	}
 
@@ -863,6 +985,9 @@ int Wait4all()
 		num = 0;
 		memset(index, 0, sizeof(index));
 		memset(found, 0, sizeof(found));
+		for (i = 0 ; i < MAXNWIN ; i++) {
+			WaitMatchReset(&Wait4allStream[i]);
+		}
 		get_macro_active_info(&num, index);
 		Wait4allGotIndex = TRUE;
 	}
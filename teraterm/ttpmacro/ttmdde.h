@@ -44,14 +44,17 @@ void DDESend();
 void DDESendStringU8(const char *strU8);
 void DDESendBinary(const void *ptr, size_t len);
 PCHAR GetRecvLnBuff();
+void FreeRecvLnBuff();
 void FlushRecv();
 void ClearWait();
 void SetWait(int Index, const char *Str);
+BOOL AddWaitList(int Index, const char *Str);
 void ClearWaitN();
 void SetWaitN(int Len);
 int CmpWait(int Index, PCHAR Str);
 void SetWait2(PCHAR Str, int Len, int Pos);
 int Wait();
+int GetWaitMatchPos();
 BOOL Wait2();
 BOOL WaitN();
 int Wait4all();
@@ -153,6 +153,7 @@ BOOL CCtrlWindow::OnIdle()
 			TTLStatus = IdTTLRun;
 			LockVar();
 			SetResult(ResultCode);
+			SetMatchPos(GetWaitMatchPos());
 			UnlockVar();
 			ClearWait();
 			return TRUE;
@@ -166,6 +167,7 @@ BOOL CCtrlWindow::OnIdle()
 		if (ResultCode>0) {
 			LockVar();
 			SetResult(ResultCode);
+			SetMatchPos(GetWaitMatchPos());
 			UnlockVar();
 			Temp[0] = 0x0a;
 			Temp[1] = 0;
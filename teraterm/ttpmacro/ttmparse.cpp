@@ -82,6 +82,17 @@ typedef struct {
 
 static Variable_t *Variables;
 static int VariableCount;
+static int VariableMax;		// Variables[] ̊mې
+
+// ϐ̍ő吔
+//   TVarId ̏16bit͔zϐ̓Y+1A16bit͗vf̓Y\̂ŁA
+//   ϐ̓Y(TVarId) 0xfffe ܂łɂ
+#define MaxVariableCount	0xffff
+
+// ϐ(啶ʂȂ) Variables[] nbV\
+// I[vAhX@Avf Variables[] ̓Y+1 (0 = )
+static int *VarHash;
+static int VarHashSize;		// 2ׂ̂
 
 // g[N̉͊JnʒuXVB
 static void UpdateLineParsePtr(void)
@@ -89,11 +100,154 @@ static void UpdateLineParsePtr(void)
 	LineParsePtr = LinePtr;
 }
 
+// ͌ʂ̃LbV
+//   [vœsJԂsƂA񎚋͂Ǝ̍\͂
+//   蒼Ȃ悤ɁAs(lXgxƍsʒu)ƍs̉͊Jnʒu
+//   L[ɂ 1ڂ̉͌ʂoĂB
+//   - R}h: \ ID Ɖ͌ LinePtr
+//   - : ̎t|[hL@ɕϊԃR[hƉ͌ LinePtr
+//   }Nt@C̓ǂݍ݂ƃx̍폜(ϐ̓Y)őSĎ̂ĂB
+#define CacheWord	1
+#define CacheExpr	2
+
+// ԃR[h (Op ɂ͉Zq̗\ ID g)
+#define ExprNum		1	// lς
+#define ExprVar		2	// ϐς
+#define ExprAryElem	3	// Y𐮐z̗vfɒu
+#define ExprParsePtr	4	// LineParsePtr XV (GetIndex() Ɠ)
+#define ExprNeg		5	// P}CiX
+
+#define ExprCodeMax	256	// 1̎̒ԃR[h̍ő吔
+#define ExprStackMax	32	// ԃR[h̎sɎgX^bN̐[
+
+typedef struct {
+	WORD Op;
+	int Val;
+} TExprCode;
+
+typedef struct {
+	WORD Type;	// CacheWord / CacheExpr (0 = )
+	WORD Ptr;	// ͂n߂ LinePtr
+	int Level;	// s̃lXgx
+	BINT Start;	// s̈ʒu
+	WORD End;	// ͌ LinePtr
+	WORD WId;	// CacheWord: \ ID (0 = \ł͂Ȃ)
+	int CodeLen;	// CacheExpr: ԃR[h̐
+	TExprCode *Code;	// CacheExpr: ԃR[h (NULL = ϊłȂ)
+} TParseCache;
+
+#define ParseCacheMax	65536	// LbV̍ő̑傫 (2ׂ̂)
+
+static TParseCache *ParseCache;
+static int ParseCacheSize;	// 2ׂ̂
+static int ParseCacheCount;
+
+static unsigned int ParseCacheHash(WORD Type, int Level, BINT Start, WORD Ptr)
+{
+	unsigned int h = (unsigned int)Start * 2654435761U;
+	h ^= ((unsigned int)Ptr << 8) ^ ((unsigned int)Level << 4) ^ Type;
+	h *= 2246822519U;
+	return h ^ (h >> 15);
+}
+
+void ClearParseCache(void)
+{
+	int i;
+
+	for (i = 0; i < ParseCacheSize; i++) {
+		free(ParseCache[i].Code);
+	}
+	free(ParseCache);
+	ParseCache = NULL;
+	ParseCacheSize = 0;
+	ParseCacheCount = 0;
+}
+
+/**
+ *	LbV
+ *	@param	Type	CacheWord / CacheExpr
+ *	@param	Ptr		͂n߂ LinePtr
+ *	@param	Add		TRUE ̂ƂAȂ΋󂫂mۂĕԂ
+ *	@return	LbṼGgAȂ(mۂłȂ)Ƃ NULL
+ */
+static TParseCache *ParseCacheFind(WORD Type, WORD Ptr, BOOL Add)
+{
+	int Level;
+	BINT Start;
+	unsigned int mask, h;
+	TParseCache *c;
+
+	if (! GetLineKey(&Level, &Start)) {
+		// exec R}hŒusȂ
+		return NULL;
+	}
+	if (ParseCacheSize > 0) {
+		mask = (unsigned int)ParseCacheSize - 1;
+		h = ParseCacheHash(Type, Level, Start, Ptr) & mask;
+		while (ParseCache[h].Type != 0) {
+			c = &ParseCache[h];
+			if (c->Type == Type && c->Ptr == Ptr && c->Level == Level && c->Start == Start) {
+				return c;
+			}
+			h = (h + 1) & mask;
+		}
+	}
+	if (! Add) {
+		return NULL;
+	}
+
+	// gp 1/2 ȉɕۂBő܂Ŏg炻ȏ͊oȂ
+	if ((ParseCacheCount + 1) * 2 > ParseCacheSize) {
+		int i, new_size;
+		TParseCache *new_cache;
+
+		if (ParseCacheSize >= ParseCacheMax) {
+			return NULL;
+		}
+		new_size = (ParseCacheSize == 0) ? 256 : ParseCacheSize * 2;
+		new_cache = (TParseCache *)calloc(new_size, sizeof(TParseCache));
+		if (new_cache == NULL) {
+			return NULL;
+		}
+		mask = (unsigned int)new_size - 1;
+		for (i = 0; i < ParseCacheSize; i++) {
+			c = &ParseCache[i];
+			if (c->Type == 0) {
+				continue;
+			}
+			h = ParseCacheHash(c->Type, c->Level, c->Start, c->Ptr) & mask;
+			while (new_cache[h].Type != 0) {
+				h = (h + 1) & mask;
+			}
+			new_cache[h] = *c;
+		}
+		free(ParseCache);
+		ParseCache = new_cache;
+		ParseCacheSize = new_size;
+	}
+
+	mask = (unsigned int)ParseCacheSize - 1;
+	h = ParseCacheHash(Type, Level, Start, Ptr) & mask;
+	while (ParseCache[h].Type != 0) {
+		h = (h + 1) & mask;
+	}
+	c = &ParseCache[h];
+	c->Type = Type;
+	c->Ptr = Ptr;
+	c->Level = Level;
+	c->Start = Start;
+	ParseCacheCount++;
+	return c;
+}
+
 
 BOOL InitVar()
 {
 	Variables = NULL;
 	VariableCount = 0;
+	VariableMax = 0;
+	VarHash = NULL;
+	VarHashSize = 0;
 	return TRUE;
 }
 
@@ -119,6 +273,11 @@ void EndVar()
 	free(Variables);
 	Variables = NULL;
 	VariableCount = 0;
+	VariableMax = 0;
+	free(VarHash);
+	VarHash = NULL;
+	VarHashSize = 0;
+	ClearParseCache();
 }
 
 void DispErr(WORD Err)
@@ -173,275 +332,243 @@ void UnlockVar()
 {
 }
 
-BOOL CheckReservedWord(PCHAR Str, LPWORD WordId)
-{
-	*WordId = 0;
-
-	switch (Str[0] | 0x20) { // to lower-case
-	case 'a':
-		if (_stricmp(Str,"and")==0) *WordId = RsvBAnd;
-		break;
-	case 'b':
-		if (_stricmp(Str,"beep")==0) *WordId = RsvBeep;
-		else if (_stricmp(Str,"bplusrecv")==0) *WordId = RsvBPlusRecv;
-		else if (_stricmp(Str,"bplussend")==0) *WordId = RsvBPlusSend;
-		else if (_stricmp(Str,"break")==0) *WordId = RsvBreak;
-		else if (_stricmp(Str,"bringupbox")==0) *WordId = RsvBringupBox;
-		else if (_stricmp(Str,"basename")==0) *WordId = RsvBasename;
-		break;
-	case 'c':
-		if (_stricmp(Str,"call")==0) *WordId = RsvCall;
-		else if (_stricmp(Str,"callmenu")==0) *WordId = RsvCallMenu;
-		else if (_stricmp(Str,"changedir")==0) *WordId = RsvChangeDir;
-		else if (_stricmp(Str,"checksum8")==0) *WordId = RsvChecksum8;
-		else if (_stricmp(Str,"checksum8file")==0) *WordId = RsvChecksum8File;
-		else if (_stricmp(Str,"checksum16")==0) *WordId = RsvChecksum16;
-		else if (_stricmp(Str,"checksum16file")==0) *WordId = RsvChecksum16File;
-		else if (_stricmp(Str,"checksum32")==0) *WordId = RsvChecksum32;
-		else if (_stricmp(Str,"checksum32file")==0) *WordId = RsvChecksum32File;
-		else if (_stricmp(Str,"clearscreen")==0) *WordId = RsvClearScreen;
-		else if (_stricmp(Str,"clipb2var")==0) *WordId = RsvClipb2Var;  // add 'clipb2var' (2006.9.17 maya)
-		else if (_stricmp(Str,"closesbox")==0) *WordId = RsvCloseSBox;
-		else if (_stricmp(Str,"closett")==0) *WordId = RsvCloseTT;
-		else if (_stricmp(Str,"code2str")==0) *WordId = RsvCode2Str;
-		else if (_stricmp(Str,"connect")==0) *WordId = RsvConnect;
-		else if (_stricmp(Str,"continue")==0) *WordId = RsvContinue;
-		else if (_stricmp(Str,"crc16")==0) *WordId = RsvCrc16;
-		else if (_stricmp(Str,"crc16file")==0) *WordId = RsvCrc16File;
-		else if (_stricmp(Str,"crc32")==0) *WordId = RsvCrc32;
-		else if (_stricmp(Str,"crc32file")==0) *WordId = RsvCrc32File;
-		else if (_stricmp(Str,"cygconnect")==0) *WordId = RsvCygConnect;
-		break;
-	case 'd':
-		if (_stricmp(Str,"delpassword")==0) *WordId = RsvDelPassword;
-		else if (_stricmp(Str,"delpassword2")==0) *WordId = RsvDelPassword2;
-		else if (_stricmp(Str,"disconnect")==0) *WordId = RsvDisconnect;
-		else if (_stricmp(Str,"dispstr")==0) *WordId = RsvDispStr;
-		else if (_stricmp(Str,"do")==0) *WordId = RsvDo;
-		else if (_stricmp(Str,"dirname")==0) *WordId = RsvDirname;
-		else if (_stricmp(Str, "dirnamebox") == 0) *WordId = RsvDirnameBox;
-		break;
-	case 'e':
-		if (_stricmp(Str,"else")==0) *WordId = RsvElse;
-		else if (_stricmp(Str,"elseif")==0) *WordId = RsvElseIf;
-		else if (_stricmp(Str,"enablekeyb")==0) *WordId = RsvEnableKeyb;
-		else if (_stricmp(Str,"end")==0) *WordId = RsvEnd;
-		else if (_stricmp(Str,"endif")==0) *WordId = RsvEndIf;
-		else if (_stricmp(Str,"enduntil")==0) *WordId = RsvEndUntil;
-		else if (_stricmp(Str,"endwhile")==0) *WordId = RsvEndWhile;
-		else if (_stricmp(Str,"exec")==0) *WordId = RsvExec;
-		else if (_stricmp(Str,"execcmnd")==0) *WordId = RsvExecCmnd;
-		else if (_stricmp(Str,"exit")==0) *WordId = RsvExit;
-		else if (_stricmp(Str,"expandenv")==0) *WordId = RsvExpandEnv;
-		break;
-	case 'f':
-		if (_stricmp(Str,"fileclose")==0) *WordId = RsvFileClose;
-		else if (_stricmp(Str,"fileconcat")==0) *WordId = RsvFileConcat;
-		else if (_stricmp(Str,"filecopy")==0) *WordId = RsvFileCopy;
-		else if (_stricmp(Str,"filecreate")==0) *WordId = RsvFileCreate;
-		else if (_stricmp(Str,"filedelete")==0) *WordId = RsvFileDelete;
-		else if (_stricmp(Str,"filelock")==0) *WordId = RsvFileLock;
-		else if (_stricmp(Str,"filemarkptr")==0) *WordId = RsvFileMarkPtr;
-		else if (_stricmp(Str,"filenamebox")==0) *WordId  = RsvFilenameBox; // add 'filenamebox' (2007.9.13 maya)
-		else if (_stricmp(Str,"fileopen")==0) *WordId = RsvFileOpen;
-		else if (_stricmp(Str,"filereadln")==0) *WordId = RsvFileReadln;
-		else if (_stricmp(Str,"fileread")==0) *WordId = RsvFileRead;    // add
-		else if (_stricmp(Str,"filerename")==0) *WordId = RsvFileRename;
-		else if (_stricmp(Str,"filesearch")==0) *WordId = RsvFileSearch;
-		else if (_stricmp(Str,"fileseek")==0) *WordId = RsvFileSeek;
-		else if (_stricmp(Str,"fileseekback")==0) *WordId = RsvFileSeekBack;
-		else if (_stricmp(Str,"filestat")==0) *WordId = RsvFileStat;
-		else if (_stricmp(Str,"filestrseek")==0) *WordId = RsvFileStrSeek;
-		else if (_stricmp(Str,"filestrseek2")==0) *WordId = RsvFileStrSeek2;
-		else if (_stricmp(Str,"filetruncate")==0) *WordId = RsvFileTruncate;
-		else if (_stricmp(Str,"fileunlock")==0) *WordId = RsvFileUnLock;
-		else if (_stricmp(Str,"filewrite")==0) *WordId = RsvFileWrite;
-		else if (_stricmp(Str,"filewriteln")==0) *WordId = RsvFileWriteLn;
-		else if (_stricmp(Str,"findclose")==0) *WordId = RsvFindClose;
-		else if (_stricmp(Str,"findfirst")==0) *WordId = RsvFindFirst;
-		else if (_stricmp(Str,"findnext")==0) *WordId = RsvFindNext;
-		else if (_stricmp(Str,"flushrecv")==0) *WordId = RsvFlushRecv;
-		else if (_stricmp(Str,"foldercreate")==0) *WordId = RsvFolderCreate;
-		else if (_stricmp(Str,"folderdelete")==0) *WordId = RsvFolderDelete;
-		else if (_stricmp(Str,"foldersearch")==0) *WordId = RsvFolderSearch;
-		else if (_stricmp(Str,"for")==0) *WordId = RsvFor;
-		break;
-	case 'g':
-		if (_stricmp(Str,"getdate")==0) *WordId = RsvGetDate;
-		else if (_stricmp(Str,"getdir")==0) *WordId = RsvGetDir;
-		else if (_stricmp(Str,"getenv")==0) *WordId = RsvGetEnv;
-		else if (_stricmp(Str,"getfileattr")==0) *WordId = RsvGetFileAttr;
-		else if (_stricmp(Str,"gethostname")==0) *WordId = RsvGetHostname;
-		else if (_stricmp(Str,"getipv4addr")==0) *WordId = RsvGetIPv4Addr;
-		else if (_stricmp(Str,"getipv6addr")==0) *WordId = RsvGetIPv6Addr;
-		else if (_stricmp(Str,"getmodemstatus") == 0) *WordId = RsvGetModemStatus;
-		else if (_stricmp(Str,"getpassword")==0) *WordId = RsvGetPassword;
-		else if (_stricmp(Str,"getpassword2")==0) *WordId = RsvGetPassword2;
-		else if (_stricmp(Str,"getspecialfolder")==0) *WordId = RsvGetSpecialFolder;
-		else if (_stricmp(Str,"gettime")==0) *WordId = RsvGetTime;
-		else if (_stricmp(Str,"gettitle")==0) *WordId = RsvGetTitle;
-		else if (_stricmp(Str,"getttdir")==0) *WordId = RsvGetTTDir;
-		else if (_stricmp(Str,"getttpos")==0) *WordId = RsvGetTTPos;
-		else if (_stricmp(Str,"getver")==0) *WordId = RsvGetVer;
-		else if (_stricmp(Str,"goto")==0) *WordId = RsvGoto;
-		break;
-	case 'i':
-		if (_stricmp(Str,"if")==0) *WordId = RsvIf;
-		else if (_stricmp(Str,"ifdefined")==0) *WordId = RsvIfDefined;
-		else if (_stricmp(Str,"include")==0) *WordId = RsvInclude ;
-		else if (_stricmp(Str,"inputbox")==0) *WordId = RsvInputBox;
-		else if (_stricmp(Str,"int2str")==0) *WordId = RsvInt2Str;
-		else if (_stricmp(Str,"intdim")==0) *WordId = RsvIntDim;
-		else if (_stricmp(Str,"ispassword")==0) *WordId = RsvIsPassword;    // add 'ispassword'  (2012.5.24 yutaka)
-		else if (_stricmp(Str,"ispassword2")==0) *WordId = RsvIsPassword2;
-		break;
-	case 'k':
-		if (_stricmp(Str,"kmtfinish")==0) *WordId = RsvKmtFinish;
-		else if (_stricmp(Str,"kmtget")==0) *WordId = RsvKmtGet;
-		else if (_stricmp(Str,"kmtrecv")==0) *WordId = RsvKmtRecv;
-		else if (_stricmp(Str,"kmtsend")==0) *WordId = RsvKmtSend;
-		break;
-	case 'l':
-		if (_stricmp(Str,"listbox")==0) *WordId = RsvListBox;
-		else if (_stricmp(Str,"loadkeymap")==0) *WordId = RsvLoadKeyMap;
-		else if (_stricmp(Str,"logautoclosemode")==0) *WordId = RsvLogAutoClose;
-		else if (_stricmp(Str,"logclose")==0) *WordId = RsvLogClose;
-		else if (_stricmp(Str,"loginfo")==0) *WordId = RsvLogInfo;
-		else if (_stricmp(Str,"logopen")==0) *WordId = RsvLogOpen;
-		else if (_stricmp(Str,"logpause")==0) *WordId = RsvLogPause;
-		else if (_stricmp(Str,"logrotate")==0) *WordId = RsvLogRotate;
-		else if (_stricmp(Str,"logstart")==0) *WordId = RsvLogStart;
-		else if (_stricmp(Str,"logwrite")==0) *WordId = RsvLogWrite;
-		else if (_stricmp(Str,"loop")==0) *WordId = RsvLoop;
-		break;
-	case 'm':
-		if (_stricmp(Str,"makepath")==0) *WordId = RsvMakePath;
-		else if (_stricmp(Str,"messagebox")==0) *WordId = RsvMessageBox;
-		else if (_stricmp(Str,"mpause")==0) *WordId = RsvMilliPause;
-		break;
-	case 'n':
-		if (_stricmp(Str,"next")==0) *WordId = RsvNext;
-		else if (_stricmp(Str,"not")==0) *WordId = RsvBNot;
-		break;
-	case 'o':
-		if (_stricmp(Str,"or")==0) *WordId = RsvBOr;
+// \̕\
+// CheckReservedWord() œ񕪒T邽߁AO ASCII ()ɕׂ邱
+typedef struct {
+	const char *name;
+	WORD id;
+} ReservedWord_t;
+
+static const ReservedWord_t ReservedWords[] = {
+	{ "and", RsvBAnd },
+	{ "basename", RsvBasename },
+	{ "beep", RsvBeep },
+	{ "bplusrecv", RsvBPlusRecv },
+	{ "bplussend", RsvBPlusSend },
+	{ "break", RsvBreak },
+	{ "bringupbox", RsvBringupBox },
+	{ "call", RsvCall },
+	{ "callmenu", RsvCallMenu },
+	{ "changedir", RsvChangeDir },
+	{ "checksum16", RsvChecksum16 },
+	{ "checksum16file", RsvChecksum16File },
+	{ "checksum32", RsvChecksum32 },
+	{ "checksum32file", RsvChecksum32File },
+	{ "checksum8", RsvChecksum8 },
+	{ "checksum8file", RsvChecksum8File },
+	{ "clearscreen", RsvClearScreen },
+	{ "clipb2var", RsvClipb2Var }, // add 'clipb2var' (2006.9.17 maya)
+	{ "closesbox", RsvCloseSBox },
+	{ "closett", RsvCloseTT },
+	{ "code2str", RsvCode2Str },
+	{ "connect", RsvConnect },
+	{ "continue", RsvContinue },
+	{ "crc16", RsvCrc16 },
+	{ "crc16file", RsvCrc16File },
+	{ "crc32", RsvCrc32 },
+	{ "crc32file", RsvCrc32File },
+	{ "cygconnect", RsvCygConnect },
+	{ "delpassword", RsvDelPassword },
+	{ "delpassword2", RsvDelPassword2 },
+	{ "dirname", RsvDirname },
+	{ "dirnamebox", RsvDirnameBox },
+	{ "disconnect", RsvDisconnect },
+	{ "dispstr", RsvDispStr },
+	{ "do", RsvDo },
+	{ "else", RsvElse },
+	{ "elseif", RsvElseIf },
+	{ "enablekeyb", RsvEnableKeyb },
+	{ "end", RsvEnd },
+	{ "endif", RsvEndIf },
+	{ "enduntil", RsvEndUntil },
+	{ "endwhile", RsvEndWhile },
+	{ "exec", RsvExec },
+	{ "execcmnd", RsvExecCmnd },
+	{ "exit", RsvExit },
+	{ "expandenv", RsvExpandEnv },
+	{ "fileclose", RsvFileClose },
+	{ "fileconcat", RsvFileConcat },
+	{ "filecopy", RsvFileCopy },
+	{ "filecreate", RsvFileCreate },
+	{ "filedelete", RsvFileDelete },
+	{ "filelock", RsvFileLock },
+	{ "filemarkptr", RsvFileMarkPtr },
+	{ "filenamebox", RsvFilenameBox }, // add 'filenamebox' (2007.9.13 maya)
+	{ "fileopen", RsvFileOpen },
+	{ "fileread", RsvFileRead }, // add
+	{ "filereadln", RsvFileReadln },
+	{ "filerename", RsvFileRename },
+	{ "filesearch", RsvFileSearch },
+	{ "fileseek", RsvFileSeek },
+	{ "fileseekback", RsvFileSeekBack },
+	{ "filestat", RsvFileStat },
+	{ "filestrseek", RsvFileStrSeek },
+	{ "filestrseek2", RsvFileStrSeek2 },
+	{ "filetruncate", RsvFileTruncate },
+	{ "fileunlock", RsvFileUnLock },
+	{ "filewrite", RsvFileWrite },
+	{ "filewriteln", RsvFileWriteLn },
+	{ "findclose", RsvFindClose },
+	{ "findfirst", RsvFindFirst },
+	{ "findnext", RsvFindNext },
+	{ "flushrecv", RsvFlushRecv },
+	{ "foldercreate", RsvFolderCreate },
+	{ "folderdelete", RsvFolderDelete },
+	{ "foldersearch", RsvFolderSearch },
+	{ "for", RsvFor },
+	{ "getdate", RsvGetDate },
+	{ "getdir", RsvGetDir },
+	{ "getenv", RsvGetEnv },
+	{ "getfileattr", RsvGetFileAttr },
+	{ "gethostname", RsvGetHostname },
+	{ "getipv4addr", RsvGetIPv4Addr },
+	{ "getipv6addr", RsvGetIPv6Addr },
+	{ "getmodemstatus", RsvGetModemStatus },
+	{ "getpassword", RsvGetPassword },
+	{ "getpassword2", RsvGetPassword2 },
+	{ "getspecialfolder", RsvGetSpecialFolder },
+	{ "gettime", RsvGetTime },
+	{ "gettitle", RsvGetTitle },
+	{ "getttdir", RsvGetTTDir },
+	{ "getttpos", RsvGetTTPos },
+	{ "getver", RsvGetVer },
+	{ "goto", RsvGoto },
+	{ "if", RsvIf },
+	{ "ifdefined", RsvIfDefined },
+	{ "include", RsvInclude },
+	{ "inputbox", RsvInputBox },
+	{ "int2str", RsvInt2Str },
+	{ "intdim", RsvIntDim },
+	{ "ispassword", RsvIsPassword }, // add 'ispassword'  (2012.5.24 yutaka)
+	{ "ispassword2", RsvIsPassword2 },
+	{ "kmtfinish", RsvKmtFinish },
+	{ "kmtget", RsvKmtGet },
+	{ "kmtrecv", RsvKmtRecv },
+	{ "kmtsend", RsvKmtSend },
+	{ "listbox", RsvListBox },
+	{ "loadkeymap", RsvLoadKeyMap },
+	{ "logautoclosemode", RsvLogAutoClose },
+	{ "logclose", RsvLogClose },
+	{ "loginfo", RsvLogInfo },
+	{ "logopen", RsvLogOpen },
+	{ "logpause", RsvLogPause },
+	{ "logrotate", RsvLogRotate },
+	{ "logstart", RsvLogStart },
+	{ "logwrite", RsvLogWrite },
+	{ "loop", RsvLoop },
+	{ "makepath", RsvMakePath },
+	{ "messagebox", RsvMessageBox },
+	{ "mpause", RsvMilliPause },
+	{ "next", RsvNext },
+	{ "not", RsvBNot },
+	{ "or", RsvBOr },
 #if defined(OUTPUTDEBUGSTRING_ENABLE)
-		if (_stricmp(Str,"outputdebugstring")==0) *WordId = RsvOutputDebugString;
+	{ "outputdebugstring", RsvOutputDebugString },
 #endif
-		break;
-	case 'p':
-		if (_stricmp(Str,"passwordbox")==0) *WordId = RsvPasswordBox;
-		else if (_stricmp(Str,"pause")==0) *WordId = RsvPause;
-		break;
-	case 'q':
-		if (_stricmp(Str,"quickvanrecv")==0) *WordId = RsvQuickVANRecv;
-		else if (_stricmp(Str,"quickvansend")==0) *WordId = RsvQuickVANSend;
-		break;
-	case 'r':
-		if (_stricmp(Str,"random")==0) *WordId = RsvRandom;    // add 'random' (2006.2.11 yutaka)
-		else if (_stricmp(Str,"recvln")==0) *WordId = RsvRecvLn;
-		else if (_stricmp(Str,"regexoption")==0) *WordId = RsvRegexOption;
-		else if (_stricmp(Str,"restoresetup")==0) *WordId = RsvRestoreSetup;
-		else if (_stricmp(Str,"return")==0) *WordId = RsvReturn;
-		else if (_stricmp(Str,"rotateleft")==0) *WordId = RsvRotateL;   // add 'rotateleft' (2007.8.19 maya)
-		else if (_stricmp(Str,"rotateright")==0) *WordId = RsvRotateR;  // add 'rotateright' (2007.8.19 maya)
-		break;
-	case 's':
-		if (_stricmp(Str,"scprecv")==0) *WordId = RsvScpRecv;      // add 'scprecv' (2008.1.1 yutaka)
-		else if (_stricmp(Str,"scpsend")==0) *WordId = RsvScpSend;      // add 'scpsend' (2008.1.1 yutaka)
-		else if (_stricmp(Str,"send")==0) *WordId = RsvSend;
-		else if (_stricmp(Str,"sendbreak")==0) *WordId = RsvSendBreak;
-		else if (_stricmp(Str,"sendbroadcast")==0) *WordId = RsvSendBroadcast;
-		else if (_stricmp(Str,"sendlnbroadcast")==0) *WordId = RsvSendlnBroadcast;
-		else if (_stricmp(Str,"sendlnmulticast")==0) *WordId = RsvSendlnMulticast;
-		else if (_stricmp(Str,"sendmulticast")==0) *WordId = RsvSendMulticast;
-		else if (_stricmp(Str,"sendtext")==0) *WordId = RsvSendText;
-		else if (_stricmp(Str,"sendbinary")==0) *WordId = RsvSendBinary;
-		else if (_stricmp(Str,"setfileattr")==0) *WordId = RsvSetFileAttr;
-		else if (_stricmp(Str,"setmulticastname")==0) *WordId = RsvSetMulticastName;
-		else if (_stricmp(Str,"sendfile")==0) *WordId = RsvSendFile;
-		else if (_stricmp(Str,"sendkcode")==0) *WordId = RsvSendKCode;
-		else if (_stricmp(Str,"sendln")==0) *WordId = RsvSendLn;
-		else if (_stricmp(Str,"setbaud")==0) *WordId = RsvSetBaud;
-		else if (_stricmp(Str,"setdate")==0) *WordId = RsvSetDate;
-		else if (_stricmp(Str,"setdebug")==0) *WordId = RsvSetDebug;
-		else if (_stricmp(Str,"setdir")==0) *WordId = RsvSetDir;
-		else if (_stricmp(Str,"setdlgpos")==0) *WordId = RsvSetDlgPos;
-		else if (_stricmp(Str,"setdtr")==0) *WordId = RsvSetDtr;    // add 'setdtr'  (2008.3.12 maya)
-		else if (_stricmp(Str,"setecho")==0) *WordId = RsvSetEcho;
-		else if (_stricmp(Str,"setenv")==0) *WordId = RsvSetEnv;    // reactivate 'setenv' (2007.8.31 maya)
-		else if (_stricmp(Str,"setexitcode")==0) *WordId = RsvSetExitCode;
-		else if (_stricmp(Str,"setflowctrl")==0) *WordId = RsvSetFlowCtrl;
-		else if (_stricmp(Str,"setpassword")==0) *WordId = RsvSetPassword;    // add 'setpassword'  (2012.5.23 yutaka)
-		else if (_stricmp(Str,"setpassword2")==0) *WordId = RsvSetPassword2;
-		else if (_stricmp(Str,"setrts")==0) *WordId = RsvSetRts;    // add 'setrts'  (2008.3.12 maya)
-		else if (_stricmp(Str,"setspeed")==0) *WordId = RsvSetBaud;
-		else if (_stricmp(Str,"setsync")==0) *WordId = RsvSetSync;
-		else if (_stricmp(Str,"settime")==0) *WordId = RsvSetTime;
-		else if (_stricmp(Str,"settitle")==0) *WordId = RsvSetTitle;
-		else if (_stricmp(Str,"show")==0) *WordId = RsvShow;
-		else if (_stricmp(Str,"showtt")==0) *WordId = RsvShowTT;
-		else if (_stricmp(Str,"sprintf")==0) *WordId = RsvSprintf;  // add 'sprintf' (2007.5.1 yutaka)
-		else if (_stricmp(Str,"sprintf2")==0) *WordId = RsvSprintf2;  // add 'sprintf2' (2008.12.18 maya)
-		else if (_stricmp(Str,"statusbox")==0) *WordId = RsvStatusBox;
-		else if (_stricmp(Str,"str2code")==0) *WordId = RsvStr2Code;
-		else if (_stricmp(Str,"str2int")==0) *WordId = RsvStr2Int;
-		else if (_stricmp(Str,"strcompare")==0) *WordId = RsvStrCompare;
-		else if (_stricmp(Str,"strconcat")==0) *WordId = RsvStrConcat;
-		else if (_stricmp(Str,"strcopy")==0) *WordId = RsvStrCopy;
-		else if (_stricmp(Str,"strdim")==0) *WordId = RsvStrDim;
-		else if (_stricmp(Str,"strinsert")==0) *WordId = RsvStrInsert;
-		else if (_stricmp(Str,"strjoin")==0) *WordId = RsvStrJoin;
-		else if (_stricmp(Str,"strlen")==0) *WordId = RsvStrLen;
-		else if (_stricmp(Str,"strmatch")==0) *WordId = RsvStrMatch;
-		else if (_stricmp(Str,"strremove")==0) *WordId = RsvStrRemove;
-		else if (_stricmp(Str,"strreplace")==0) *WordId = RsvStrReplace;
-		else if (_stricmp(Str,"strscan")==0) *WordId = RsvStrScan;
-		else if (_stricmp(Str,"strspecial")==0) *WordId = RsvStrSpecial;
-		else if (_stricmp(Str,"strsplit")==0) *WordId = RsvStrSplit;
-		else if (_stricmp(Str,"strtrim")==0) *WordId = RsvStrTrim;
-		break;
-	case 't':
-		if (_stricmp(Str,"testlink")==0) *WordId = RsvTestLink;
-		else if (_stricmp(Str,"then")==0) *WordId = RsvThen;
-		else if (_stricmp(Str,"tolower")==0) *WordId = RsvToLower;  // add 'tolower' (2007.7.12 maya)
-		else if (_stricmp(Str,"toupper")==0) *WordId = RsvToUpper;  // add 'toupper' (2007.7.12 maya)
-		break;
-	case 'u':
-		if (_stricmp(Str,"unlink")==0) *WordId = RsvUnlink;
-		else if (_stricmp(Str,"until")==0) *WordId = RsvUntil;
-		else if (_stricmp(Str,"uptime")==0) *WordId = RsvUptime;
-		break;
-	case 'v':
-		if (_stricmp(Str,"var2clipb")==0) *WordId = RsvVar2Clipb;  // add 'var2clipb' (2006.9.17 maya)
-		break;
-	case 'w':
-		if (_stricmp(Str,"waitregex")==0) *WordId = RsvWaitRegex;  // add 'waitregex' (2005.10.5 yutaka)
-		else if (_stricmp(Str,"wait")==0) *WordId = RsvWait;
-		else if (_stricmp(Str,"wait4all")==0) *WordId = RsvWait4all;
-		else if (_stricmp(Str,"waitevent")==0) *WordId = RsvWaitEvent;
-		else if (_stricmp(Str,"waitln")==0) *WordId = RsvWaitLn;
-		else if (_stricmp(Str,"waitn")==0) *WordId = RsvWaitN;  // add 'waitn'  (2009.1.26 maya)
-		else if (_stricmp(Str,"waitrecv")==0) *WordId = RsvWaitRecv;
-		else if (_stricmp(Str,"while")==0) *WordId = RsvWhile;
-		break;
-	case 'x':
-		if (_stricmp(Str,"xmodemrecv")==0) *WordId = RsvXmodemRecv;
-		else if (_stricmp(Str,"xmodemsend")==0) *WordId = RsvXmodemSend;
-		else if (_stricmp(Str,"xor")==0) *WordId = RsvBXor;
-		break;
-	case 'y':
-		if (_stricmp(Str,"yesnobox")==0) *WordId = RsvYesNoBox;
-		else if (_stricmp(Str,"ymodemrecv")==0) *WordId = RsvYmodemRecv;
-		else if (_stricmp(Str,"ymodemsend")==0) *WordId = RsvYmodemSend;
-		break;
-	case 'z':
-		if (_stricmp(Str,"zmodemrecv")==0) *WordId = RsvZmodemRecv;
-		else if (_stricmp(Str,"zmodemsend")==0) *WordId = RsvZmodemSend;
-		break;
-	default:
-		; /* nothing to do */
-	}
+	{ "passwordbox", RsvPasswordBox },
+	{ "pause", RsvPause },
+	{ "quickvanrecv", RsvQuickVANRecv },
+	{ "quickvansend", RsvQuickVANSend },
+	{ "random", RsvRandom }, // add 'random' (2006.2.11 yutaka)
+	{ "recvln", RsvRecvLn },
+	{ "regexoption", RsvRegexOption },
+	{ "restoresetup", RsvRestoreSetup },
+	{ "return", RsvReturn },
+	{ "rotateleft", RsvRotateL }, // add 'rotateleft' (2007.8.19 maya)
+	{ "rotateright", RsvRotateR }, // add 'rotateright' (2007.8.19 maya)
+	{ "scprecv", RsvScpRecv }, // add 'scprecv' (2008.1.1 yutaka)
+	{ "scpsend", RsvScpSend }, // add 'scpsend' (2008.1.1 yutaka)
+	{ "send", RsvSend },
+	{ "sendbinary", RsvSendBinary },
+	{ "sendbreak", RsvSendBreak },
+	{ "sendbroadcast", RsvSendBroadcast },
+	{ "sendfile", RsvSendFile },
+	{ "sendkcode", RsvSendKCode },
+	{ "sendln", RsvSendLn },
+	{ "sendlnbroadcast", RsvSendlnBroadcast },
+	{ "sendlnmulticast", RsvSendlnMulticast },
+	{ "sendmulticast", RsvSendMulticast },
+	{ "sendtext", RsvSendText },
+	{ "setbaud", RsvSetBaud },
+	{ "setdate", RsvSetDate },
+	{ "setdebug", RsvSetDebug },
+	{ "setdir", RsvSetDir },
+	{ "setdlgpos", RsvSetDlgPos },
+	{ "setdtr", RsvSetDtr }, // add 'setdtr'  (2008.3.12 maya)
+	{ "setecho", RsvSetEcho },
+	{ "setenv", RsvSetEnv }, // reactivate 'setenv' (2007.8.31 maya)
+	{ "setexitcode", RsvSetExitCode },
+	{ "setfileattr", RsvSetFileAttr },
+	{ "setflowctrl", RsvSetFlowCtrl },
+	{ "setmulticastname", RsvSetMulticastName },
+	{ "setpassword", RsvSetPassword }, // add 'setpassword'  (2012.5.23 yutaka)
+	{ "setpassword2", RsvSetPassword2 },
+	{ "setrts", RsvSetRts }, // add 'setrts'  (2008.3.12 maya)
+	{ "setspeed", RsvSetBaud },
+	{ "setsync", RsvSetSync },
+	{ "settime", RsvSetTime },
+	{ "settitle", RsvSetTitle },
+	{ "show", RsvShow },
+	{ "showtt", RsvShowTT },
+	{ "sprintf", RsvSprintf }, // add 'sprintf' (2007.5.1 yutaka)
+	{ "sprintf2", RsvSprintf2 }, // add 'sprintf2' (2008.12.18 maya)
+	{ "statusbox", RsvStatusBox },
+	{ "str2code", RsvStr2Code },
+	{ "str2int", RsvStr2Int },
+	{ "strcompare", RsvStrCompare },
+	{ "strconcat", RsvStrConcat },
+	{ "strcopy", RsvStrCopy },
+	{ "strdim", RsvStrDim },
+	{ "strinsert", RsvStrInsert },
+	{ "strjoin", RsvStrJoin },
+	{ "strlen", RsvStrLen },
+	{ "strmatch", RsvStrMatch },
+	{ "strremove", RsvStrRemove },
+	{ "strreplace", RsvStrReplace },
+	{ "strscan", RsvStrScan },
+	{ "strspecial", RsvStrSpecial },
+	{ "strsplit", RsvStrSplit },
+	{ "strtrim", RsvStrTrim },
+	{ "testlink", RsvTestLink },
+	{ "then", RsvThen },
+	{ "tolower", RsvToLower }, // add 'tolower' (2007.7.12 maya)
+	{ "toupper", RsvToUpper }, // add 'toupper' (2007.7.12 maya)
+	{ "unlink", RsvUnlink },
+	{ "until", RsvUntil },
+	{ "uptime", RsvUptime },
+	{ "var2clipb", RsvVar2Clipb }, // add 'var2clipb' (2006.9.17 maya)
+	{ "wait", RsvWait },
+	{ "wait4all", RsvWait4all },
+	{ "waitevent", RsvWaitEvent },
+	{ "waitlist", RsvWaitList },
+	{ "waitln", RsvWaitLn },
+	{ "waitn", RsvWaitN }, // add 'waitn'  (2009.1.26 maya)
+	{ "waitrecv", RsvWaitRecv },
+	{ "waitregex", RsvWaitRegex }, // add 'waitregex' (2005.10.5 yutaka)
+	{ "while", RsvWhile },
+	{ "xmodemrecv", RsvXmodemRecv },
+	{ "xmodemsend", RsvXmodemSend },
+	{ "xor", RsvBXor },
+	{ "yesnobox", RsvYesNoBox },
+	{ "ymodemrecv", RsvYmodemRecv },
+	{ "ymodemsend", RsvYmodemSend },
+	{ "zmodemrecv", RsvZmodemRecv },
+	{ "zmodemsend", RsvZmodemSend },
+};
+
+static int CmpReservedWord(const void *key, const void *elem)
+{
+	return _stricmp((const char *)key, ((const ReservedWord_t *)elem)->name);
+}
+
+BOOL CheckReservedWord(PCHAR Str, LPWORD WordId)
+{
+	const ReservedWord_t *p;
+
+	// ̕ϐ̎QƂłĂ΂̂œ񕪒Tň
+	p = (const ReservedWord_t *)bsearch(Str, ReservedWords, _countof(ReservedWords),
+	                                    sizeof(ReservedWords[0]), CmpReservedWord);
+	*WordId = (p != NULL) ? p->id : 0;
 
 	return (*WordId!=0);
 }
@@ -620,6 +747,41 @@ BOOL GetReservedWord(LPWORD WordId)
 	return FALSE;
 }
 
+/**
+ *	R}h(\)擾
+ *	GetReservedWord() ƓAsJԂsƂ 1ڂ
+ *	ʂgA͂Ɨ\\̌Ȃ
+ */
+BOOL GetCommandWord(LPWORD WordId)
+{
+	TParseCache *c;
+	WORD P;
+	BOOL Result;
+
+	// CRg̒ł GetFirstChar() ̌ʂς̂ŊoȂ
+	if (commenting) {
+		return GetReservedWord(WordId);
+	}
+
+	P = LinePtr;
+	c = ParseCacheFind(CacheWord, P, FALSE);
+	if (c != NULL) {
+		*WordId = c->WId;
+		LinePtr = c->End;
+		return (c->WId != 0);
+	}
+
+	Result = GetReservedWord(WordId);
+	if (! commenting) {
+		c = ParseCacheFind(CacheWord, P, TRUE);
+		if (c != NULL) {
+			c->WId = Result ? *WordId : 0;
+			c->End = LinePtr;
+		}
+	}
+	return Result;
+}
+
 BOOL GetOperator(LPWORD WordId)
 {
 	WORD P;
@@ -849,15 +1011,65 @@ BOOL GetNumber(int *Num)
 	return TRUE;
 }
 
-BOOL CheckVar(const char *Name, TVariableType *VarType, PVarId VarId)
+static unsigned int VarHashValue(const char *Name)
+{
+	// FNV-1a (啶ʂȂ)
+	unsigned int h = 2166136261U;
+	const unsigned char *p = (const unsigned char *)Name;
+	for (; *p != 0; p++) {
+		h ^= (unsigned int)tolower(*p);
+		h *= 16777619U;
+	}
+	return h;
+}
+
+static void VarHashInsert(int i)
+{
+	unsigned int mask = (unsigned int)VarHashSize - 1;
+	unsigned int h = VarHashValue(Variables[i].Name) & mask;
+	while (VarHash[h] != 0) {
+		h = (h + 1) & mask;
+	}
+	VarHash[h] = i + 1;
+}
+
+// nbV\蒼 (size  2ׂ̂)
+static BOOL VarHashRebuild(int size)
 {
 	int i;
-	const Variable_t *v = Variables;
-	for (i = 0; i < VariableCount; v++,i++) {
-		if (_stricmp(v->Name, Name) == 0) {
-			*VarType = v->Type;
-			*VarId = (TVarId)i;
-			return TRUE;
+
+	if (size == VarHashSize) {
+		memset(VarHash, 0, sizeof(int) * size);
+	}
+	else {
+		int *new_hash = (int *)calloc(size, sizeof(int));
+		if (new_hash == NULL) {
+			return FALSE;
+		}
+		free(VarHash);
+		VarHash = new_hash;
+		VarHashSize = size;
+	}
+	// ̕ϐꍇɐɍꂽ̂悤AYɓo^
+	for (i = 0; i < VariableCount; i++) {
+		VarHashInsert(i);
+	}
+	return TRUE;
+}
+
+BOOL CheckVar(const char *Name, TVariableType *VarType, PVarId VarId)
+{
+	if (VarHashSize > 0) {
+		unsigned int mask = (unsigned int)VarHashSize - 1;
+		unsigned int h = VarHashValue(Name) & mask;
+		while (VarHash[h] != 0) {
+			const Variable_t *v = &Variables[VarHash[h] - 1];
+			if (_stricmp(v->Name, Name) == 0) {
+				*VarType = v->Type;
+				*VarId = (TVarId)(VarHash[h] - 1);
+				return TRUE;
+			}
+			h = (h + 1) & mask;
 		}
 	}
 	*VarType = TypUnknown;
@@ -867,22 +1079,40 @@ BOOL CheckVar(const char *Name, TVariableType *VarType, PVarId VarId)
 
 static Variable_t *NewVar(const char *name, TVariableType type)
 {
-	Variable_t *new_v = (Variable_t * )realloc(Variables, sizeof(Variable_t) * (VariableCount + 1));
-	if (new_v == NULL) {
-		// TODO Ȃ
+	if (VariableCount >= MaxVariableCount) {
 		return NULL;
-	};
-	Variables = new_v;
+	}
+	if (VariableCount == VariableMax) {
+		// 1 realloc() ƕϐ̑}NŒxȂ̂Ŕ{XŊmۂ
+		int new_max = (VariableMax == 0) ? 64 : VariableMax * 2;
+		Variable_t *new_v = (Variable_t * )realloc(Variables, sizeof(Variable_t) * new_max);
+		if (new_v == NULL) {
+			// TODO Ȃ
+			return NULL;
+		};
+		Variables = new_v;
+		VariableMax = new_max;
+	}
+	// nbV\̎gp 1/2 ȉɕۂ
+	if ((VariableCount + 1) * 2 > VarHashSize) {
+		if (! VarHashRebuild((VarHashSize == 0) ? 128 : VarHashSize * 2)) {
+			return NULL;
+		}
+	}
 	Variable_t *v = &Variables[VariableCount];
 	VariableCount++;
 	v->Name = _strdup(name);
 	v->Type = type;
+	VarHashInsert(VariableCount - 1);
 	return v;
 }
 
 BOOL NewIntVar(const char *Name, int InitVal)
 {
 	Variable_t *v = NewVar(Name, TypeInteger);
+	if (v == NULL) {
+		return FALSE;
+	}
 	v->Value.Int = InitVal;
 	return TRUE;
 }
@@ -890,18 +1120,27 @@ BOOL NewIntVar(const char *Name, int InitVal)
 BOOL NewStrVar(const char *Name, const char *InitVal)
 {
 	Variable_t *v = NewVar(Name, TypeString);
+	if (v == NULL) {
+		return FALSE;
+	}
 	v->Value.Str = _strdup(InitVal);
 	return TRUE;
 }
 
 int NewIntAryVar(const char *Name, int size)
 {
-	Variable_t *v = NewVar(Name, TypeIntArray);
-	TIntAry *intAry = &v->Value.IntAry;
+	Variable_t *v;
+	TIntAry *intAry;
 	int *array = (int *)calloc(size, sizeof(int));
 	if (array == NULL) {
 		return ErrFewMemory;
 	}
+	v = NewVar(Name, TypeIntArray);
+	if (v == NULL) {
+		free(array);
+		return ErrTooManyVar;
+	}
+	intAry = &v->Value.IntAry;
 	intAry->val = array;
 	intAry->size = size;
 	return 0;
@@ -909,12 +1148,18 @@ int NewIntAryVar(const char *Name, int size)
 
 int NewStrAryVar(const char *Name, int size)
 {
-	Variable_t *v = NewVar(Name, TypeStrArray);
-	TStrAry *strAry = &v->Value.StrAry;
+	Variable_t *v;
+	TStrAry *strAry;
 	char **array = (char **)calloc(size, sizeof(char *));
 	if (array == NULL) {
 		return ErrFewMemory;
 	}
+	v = NewVar(Name, TypeStrArray);
+	if (v == NULL) {
+		free(array);
+		return ErrTooManyVar;
+	}
+	strAry = &v->Value.StrAry;
 	strAry->val = array;
 	strAry->size = size;
 	return 0;
@@ -923,7 +1168,11 @@ int NewStrAryVar(const char *Name, int size)
 BOOL NewLabVar(const char *Name, BINT InitVal, WORD ILevel)
 {
 	Variable_t *v = NewVar(Name, TypeLabel);
-	TLab *lab = &v->Value.Lab;
+	TLab *lab;
+	if (v == NULL) {
+		return FALSE;
+	}
+	lab = &v->Value.Lab;
 	lab->val = InitVal;
 	lab->level = ILevel;
 	return TRUE;
@@ -955,7 +1204,12 @@ void DelLabVar(WORD ILevel)
 		}
 		v++;
 	}
-	Variables = (Variable_t *)realloc(Variables, sizeof(Variable_t) * VariableCount);
+	// Yꂽ̂ŃnbV\蒼
+	if (VarHashSize > 0) {
+		VarHashRebuild(VarHashSize);
+	}
+	// ԃR[h̕ϐ̓YgȂȂ
+	ClearParseCache();
 }
 
 void CopyLabel(WORD ILabel, BINT *Ptr, LPWORD Level)
@@ -1187,6 +1441,35 @@ static BOOL EvalAddition(TVariableType *ValType, int *Val, LPWORD Err)
 	}
 }
 
+// VtgZ (WId: RsvARShift / RsvALShift / RsvLRShift)
+static int ShiftVal(int Val1, int Val2, WORD WId)
+{
+	if (WId == RsvALShift)
+		Val2 = -Val2;
+
+	if (Val2 <= -(int)INT_BIT) {	/* Val2 <= -32 */
+		Val1 = 0;
+	} else if (Val2 < 0 ) {		/* -32 < Val2 < 0 */
+		Val1 = Val1 << -Val2;
+	} else if (Val2 == 0 ) {	/* Val2 == 0 */
+		; /* do nothing */
+	} else if (Val2 < INT_BIT) {	/* 0 < Val2 < 32 */
+		if (WId == RsvLRShift) {
+			// use unsigned int for logical right shift
+			Val1 = (unsigned int)Val1 >> Val2;
+		} else {
+			Val1 = Val1 >> Val2;
+		}
+	} else {			/* Val2 >= 32 */
+		if (Val1 > 0 || WId == RsvLRShift) {
+			Val1 = 0;
+		} else {
+			Val1 = ~0;
+		}
+	}
+	return Val1;
+}
+
 /*
  * Precedence: 4
  *   Evaluate following operator.
@@ -1235,29 +1518,7 @@ static BOOL EvalBitShift(TVariableType *ValType, int *Val, LPWORD Err)
 			return TRUE;
 		}
 
-		if (WId == RsvALShift)
-			Val2 = -Val2;
-
-		if (Val2 <= -(int)INT_BIT) {	/* Val2 <= -32 */
-			Val1 = 0;
-		} else if (Val2 < 0 ) {		/* -32 < Val2 < 0 */
-			Val1 = Val1 << -Val2;
-		} else if (Val2 == 0 ) {	/* Val2 == 0 */
-			; /* do nothing */
-		} else if (Val2 < INT_BIT) {	/* 0 < Val2 < 32 */
-			if (WId == RsvLRShift) {
-				// use unsigned int for logical right shift
-				Val1 = (unsigned int)Val1 >> Val2;
-			} else {
-				Val1 = Val1 >> Val2;
-			}
-		} else {			/* Val2 >= 32 */
-			if (Val1 > 0 || WId == RsvLRShift) {
-				Val1 = 0;
-			} else {
-				Val1 = ~0;
-			}
-		}
+		Val1 = ShiftVal(Val1, Val2, WId);
 		*Val = Val1;
 	}
 }
@@ -1573,7 +1834,7 @@ static BOOL EvalLogicalAnd(TVariableType *ValType, int *Val, LPWORD Err)
  *   Evaluate following operator.
  *     ||
  */
-BOOL GetExpression(TVariableType *ValType, int *Val, LPWORD Err)
+static BOOL EvalLogicalOr(TVariableType *ValType, int *Val, LPWORD Err)
 {
 	WORD P1, P2, Er;
 	TVariableType Type;
@@ -1629,6 +1890,258 @@ BOOL GetExpression(TVariableType *ValType, int *Val, LPWORD Err)
 	}
 }
 
+// D揇ʂƂ2Zq (EvalMultiplication() ` EvalLogicalOr())
+#define ExprLevels	10
+static const WORD ExprLevelOps[ExprLevels][4] = {
+	{ RsvMul, RsvDiv, RsvMod },
+	{ RsvPlus, RsvMinus },
+	{ RsvARShift, RsvALShift, RsvLRShift },
+	{ RsvBAnd },
+	{ RsvBXor },
+	{ RsvBOr },
+	{ RsvLT, RsvGT, RsvLE, RsvGE },
+	{ RsvEQ, RsvNE },
+	{ RsvLAnd },
+	{ RsvLOr, RsvLXor },
+};
+
+static TExprCode CompCode[ExprCodeMax];
+static int CompLen;
+static int CompDepth;	// s̃X^bN̐[
+
+static BOOL EmitExprCode(WORD Op, int Val, int Push)
+{
+	if ((CompLen >= ExprCodeMax) || (CompDepth + Push > ExprStackMax)) {
+		return FALSE;
+	}
+	CompCode[CompLen].Op = Op;
+	CompCode[CompLen].Val = Val;
+	CompLen++;
+	CompDepth += Push;
+	return TRUE;
+}
+
+static BOOL CompileLevel(int Level);
+
+// GetFactor() Ɠɉ͂ĒԃR[hɂ
+static BOOL CompileFactor(void)
+{
+	TName Name;
+	WORD WId;
+	TVariableType VarType;
+	TVarId VarId;
+	int Val;
+
+	if (GetIdentifier(Name)) {
+		if (CheckReservedWord(Name,&WId)) {
+			if ((WId != RsvBNot) && (WId != RsvLNot))
+				return FALSE;
+			if (! CompileFactor())
+				return FALSE;
+			return EmitExprCode(WId, 0, 0);
+		}
+		if (! CheckVar(Name, &VarType, &VarId))
+			return FALSE;
+		switch (VarType) {
+			case TypInteger:
+				return EmitExprCode(ExprVar, VarId, 1);
+			case TypIntArray:
+				// GetIndex() Ɠɉ͂
+				if (GetFirstChar() != '[')
+					return FALSE;
+				if (! EmitExprCode(ExprParsePtr, LinePtr, 0) ||
+				    ! CompileLevel(ExprLevels-1) ||
+				    (GetFirstChar() != ']'))
+					return FALSE;
+				return EmitExprCode(ExprAryElem, VarId, 0);
+			default:
+				// Ȃǂ͕ϊȂ
+				return FALSE;
+		}
+	}
+	else if (GetNumber(&Val))
+		return EmitExprCode(ExprNum, Val, 1);
+	else if (GetOperator(&WId)) {
+		switch (WId) {
+			case RsvPlus:
+			case RsvMinus:
+			case RsvBNot:
+			case RsvLNot:
+				break;
+			default:
+				return FALSE;
+		}
+		if (! CompileFactor())
+			return FALSE;
+		switch (WId) {
+			case RsvPlus:  return TRUE;
+			case RsvMinus: return EmitExprCode(ExprNeg, 0, 0);
+			default:       return EmitExprCode(WId, 0, 0);
+		}
+	}
+	else if (GetFirstChar()=='(') {
+		return CompileLevel(ExprLevels-1) && (GetFirstChar()==')');
+	}
+	return FALSE;
+}
+
+// EvalMultiplication() ` EvalLogicalOr() Ɠɉ͂ĒԃR[hɂ
+//   Level: ExprLevelOps[] ̓Y (-1 = GetFactor())
+static BOOL CompileLevel(int Level)
+{
+	WORD P, WId;
+	int i;
+
+	if (Level < 0)
+		return CompileFactor();
+
+	if (! CompileLevel(Level-1)) return FALSE;
+
+	while (TRUE) {
+		P = LinePtr;
+		if (! GetOperator(&WId)) return TRUE;
+
+		for (i = 0; i < (int)_countof(ExprLevelOps[Level]); i++) {
+			if (ExprLevelOps[Level][i] == WId)
+				break;
+		}
+		if (i == (int)_countof(ExprLevelOps[Level])) {
+			LinePtr = P;
+			return TRUE;
+		}
+
+		if (! CompileLevel(Level-1)) return FALSE;
+		if (! EmitExprCode(WId, 0, -1)) return FALSE;
+	}
+}
+
+// ԃR[hs
+//   G[ EvalMultiplication() ȂǂƓœ̂Ԃ
+static WORD RunExprCode(const TParseCache *c, int *Val)
+{
+	int Stack[ExprStackMax];
+	int sp = 0;
+	int Val1, Val2;
+	const TExprCode *p = c->Code;
+	const TExprCode *end = p + c->CodeLen;
+
+	for (; p != end; p++) {
+		switch (p->Op) {
+			case ExprNum:
+				Stack[sp++] = p->Val;
+				continue;
+			case ExprVar:
+				Stack[sp++] = Variables[p->Val].Value.Int;
+				continue;
+			case ExprAryElem: {
+				TIntAry *intAry = &Variables[p->Val].Value.IntAry;
+				int Index = Stack[sp-1];
+				if (Index < 0 || Index >= intAry->size)
+					return ErrOutOfRange;
+				Stack[sp-1] = intAry->val[Index];
+				continue;
+			}
+			case ExprParsePtr:
+				LineParsePtr = (WORD)p->Val;
+				continue;
+			case ExprNeg: Stack[sp-1] = -Stack[sp-1]; continue;
+			case RsvBNot: Stack[sp-1] = ~Stack[sp-1]; continue;
+			case RsvLNot: Stack[sp-1] = !Stack[sp-1]; continue;
+		}
+
+		sp--;
+		Val1 = Stack[sp-1];
+		Val2 = Stack[sp];
+		switch (p->Op) {
+			case RsvMul: Val1 = Val1 * Val2; break;
+			case RsvDiv:
+				if (Val2 == 0) return ErrDivByZero;
+				Val1 = Val1 / Val2;
+				break;
+			case RsvMod:
+				if (Val2 == 0) return ErrDivByZero;
+				Val1 = Val1 % Val2;
+				break;
+			case RsvPlus:  Val1 = Val1 + Val2; break;
+			case RsvMinus: Val1 = Val1 - Val2; break;
+			case RsvARShift:
+			case RsvALShift:
+			case RsvLRShift:
+				Val1 = ShiftVal(Val1, Val2, p->Op);
+				break;
+			case RsvBAnd: Val1 = Val1 & Val2; break;
+			case RsvBXor: Val1 = Val1 ^ Val2; break;
+			case RsvBOr:  Val1 = Val1 | Val2; break;
+			case RsvLT: Val1 = (Val1 <Val2); break;
+			case RsvGT: Val1 = (Val1 >Val2); break;
+			case RsvLE: Val1 = (Val1<=Val2); break;
+			case RsvGE: Val1 = (Val1>=Val2); break;
+			case RsvEQ: Val1 = (Val1==Val2); break;
+			case RsvNE: Val1 = (Val1!=Val2); break;
+			case RsvLAnd: Val1 = Val1 && Val2; break;
+			case RsvLOr:  Val1 = Val1 || Val2; break;
+			case RsvLXor: Val1 = (Val1 && !Val2) || (!Val1 && Val2); break;
+		}
+		Stack[sp-1] = Val1;
+	}
+	*Val = Stack[0];
+	return 0;
+}
+
+static int ExprNest;	// ʂY̒̎̓LbVȂ
+
+/**
+ *	]
+ *	ʒu̎JԂ]Ƃ́A1ڂɕϊԃR[hs
+ */
+BOOL GetExpression(TVariableType *ValType, int *Val, LPWORD Err)
+{
+	TParseCache *c = NULL;
+	BOOL Cache, Result;
+	WORD P, End;
+
+	P = LinePtr;
+	// CRg̒ł GetFirstChar() ̌ʂς̂ŊoȂ
+	Cache = (ExprNest == 0) && ! commenting;
+	if (Cache) {
+		c = ParseCacheFind(CacheExpr, P, FALSE);
+		if (c != NULL && c->Code != NULL) {
+			*ValType = TypInteger;
+			*Val = 0;
+			*Err = RunExprCode(c, Val);
+			LinePtr = (*Err == 0) ? c->End : P;
+			return TRUE;
+		}
+	}
+
+	ExprNest++;
+	Result = EvalLogicalOr(ValType, Val, Err);
+	ExprNest--;
+
+	// G[ɂȂ炸ɉ͂ło
+	if (Cache && (c == NULL) && Result && (*Err == 0) && ! commenting) {
+		End = LinePtr;
+		c = ParseCacheFind(CacheExpr, P, TRUE);
+		if (c != NULL) {
+			c->End = End;
+			if (*ValType == TypInteger) {
+				LinePtr = P;
+				CompLen = 0;
+				CompDepth = 0;
+				if (CompileLevel(ExprLevels-1) && (LinePtr == End) && (CompLen > 0)) {
+					c->Code = (TExprCode *)malloc(sizeof(TExprCode) * CompLen);
+					if (c->Code != NULL) {
+						memcpy(c->Code, CompCode, sizeof(TExprCode) * CompLen);
+						c->CodeLen = CompLen;
+					}
+				}
+				LinePtr = End;
+			}
+		}
+	}
+	return Result;
+}
+
 void GetIntVal(int *Val, LPWORD Err)
 {
 	TVariableType ValType;
@@ -1752,6 +2265,35 @@ void GetStrVal2(PCHAR Str, LPWORD Err, BOOL AutoConversion)
 		*Err = ErrSyntax;
 }
 
+/**
+ *	擾
+ *	ϐ̏ꍇ̓Rs[ɕϐ̓eԂ̂ŁA̐Ȃ
+ *	@param	Str	萔i[̈ (MaxStrLen byte ̗̈悪Kv)
+ *	@return	Str ܂͕ϐ̓eւ̃|C^
+ *			ϐ̓éAɂ̕ϐύX܂ŗL
+ */
+const char *GetStrValRef(PCHAR Str, LPWORD Err)
+{
+	TVariableType VarType;
+	int VarId;
+
+	UpdateLineParsePtr();
+	Str[0] = 0;
+	if (*Err!=0) return Str;
+
+	if (GetString(Str, Err))
+		return Str;
+	else if (GetExpression(&VarType, &VarId, Err)) {
+		if (*Err!=0) return Str;
+		if (VarType == TypString)
+			return StrVarPtr((TVarId)VarId);
+		*Err = ErrTypeMismatch;
+	}
+	else
+		*Err = ErrSyntax;
+	return Str;
+}
+
 void GetStrVar(PVarId VarId, LPWORD Err)
 {
 	TName Name;
@@ -1788,20 +2330,51 @@ void GetStrVar(PVarId VarId, LPWORD Err)
 		*Err = ErrSyntax;
 }
 
-void SetStrVal(TVarId VarId, const char *Str)
+// ϐ̓eێĂ|C^̏ꏊ
+static char **StrVarSlot(TVarId VarId)
 {
 	if (VarId >> 16) {
 		Variable_t *v = &Variables[(VarId>>16)-1];
-		char **str = &v->Value.StrAry.val[VarId & 0xffff];
-		free(*str);
-		*str = _strdup(Str);
+		return &v->Value.StrAry.val[VarId & 0xffff];
 	}
 	else {
 		Variable_t *v = &Variables[VarId];
-		char **str = &v->Value.Str;
-		free(*str);
-		*str = _strdup(Str);
+		return &v->Value.Str;
+	}
+}
+
+void SetStrVal(TVarId VarId, const char *Str)
+{
+	char **str = StrVarSlot(VarId);
+	// Str ϐg̓ewĂ邱Ƃ̂ŁAɃRs[
+	char *new_str = _strdup(Str);
+	free(*str);
+	*str = new_str;
+}
+
+/**
+ *	ϐ̖ɕǉ
+ *	@param	Str	ǉ镶 (ϐg̓ewĂĂ悢)
+ *	@retval	FALSE	s
+ */
+BOOL AppendStrVal(TVarId VarId, const char *Str)
+{
+	char **str = StrVarSlot(VarId);
+	char *old_str = *str;
+	size_t old_len = (old_str != NULL) ? strlen(old_str) : 0;
+	size_t add_len = strlen(Str);
+	BOOL self = (old_str != NULL && Str >= old_str && Str <= old_str + old_len);
+	size_t self_offset = self ? (size_t)(Str - old_str) : 0;
+	char *new_str;
+
+	new_str = (char *)realloc(old_str, old_len + add_len + 1);
+	if (new_str == NULL) {
+		return FALSE;
 	}
+	memmove(new_str + old_len, self ? new_str + self_offset : Str, add_len);
+	new_str[old_len + add_len] = 0;
+	*str = new_str;
+	return TRUE;
 }
 
 /**
@@ -296,6 +296,7 @@ typedef enum {
 #define RsvDelPassword2 221
 #define RsvIsPassword2  222
 #define RsvGetTTPos     223
+#define RsvWaitList     224
 
 #define RsvOperator     1000
 #define RsvBNot         1001
@@ -352,6 +353,7 @@ BYTE GetFirstChar();
 BOOL CheckParameterGiven();
 BOOL GetIdentifier(PCHAR Name);
 BOOL GetReservedWord(LPWORD WordId);
+BOOL GetCommandWord(LPWORD WordId);
 BOOL CheckReservedWord(PCHAR Str, LPWORD WordId);
 BOOL GetLabelName(PCHAR Name);
 BOOL GetString(PCHAR Str, LPWORD Err);
@@ -362,6 +364,7 @@ BOOL NewLabVar(const char *Name, BINT InitVal, WORD ILevel);
 int NewIntAryVar(const char *Name, int size);
 int NewStrAryVar(const char *Name, int size);
 void DelLabVar(WORD ILevel);
+void ClearParseCache(void);
 void CopyLabel(WORD ILabel, BINT *Ptr, LPWORD Level);
 BOOL GetExpression(TVariableType *ValType, int *Val, LPWORD Err);
 void GetIntVal(int *Val, LPWORD Err);
@@ -370,8 +373,10 @@ int CopyIntVal(TVarId VarId);
 void GetIntVar(PVarId VarId, LPWORD Err);
 void GetStrVal(PCHAR Str, LPWORD Err);
 void GetStrVal2(PCHAR Str, LPWORD Err, BOOL AutoConversion);
+const char *GetStrValRef(PCHAR Str, LPWORD Err);
 void GetStrVar(PVarId VarId, LPWORD Err);
 void SetStrVal(TVarId VarId, const char *Str);
+BOOL AppendStrVal(TVarId VarId, const char *Str);
 const char *StrVarPtr(TVarId VarId);
 void GetVarType(TVariableType *ValType, int *Val, LPWORD Err);
 TVarId GetIntVarFromArray(TVarId VarId, int Index, LPWORD Err);
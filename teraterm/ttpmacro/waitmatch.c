@@ -0,0 +1,285 @@
+/*
+ * Copyright (C) 2026- TeraTerm Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * wait n}NR}hp̕񌟍
+ *
+ * o^ꂽ񂩂 Aho-Corasick @Ō萫I[g}g(DFA)A
+ * Mf[^ 1 oCgɂ\ 1 ŏƍB
+ * p^[ⒷɊ֌WȂ 1 oCg̏ʂ͈ɂȂB
+ *
+ * - Jڕ\̓p^[ɌoCg𕶎NXɊ蓖Ăď
+ *   (p^[ɌȂoCgׂ͂ăNX 0 ŁAKԂ֖߂)
+ * - ʒuŕ̃p^[vƂ id ̏̂Ԃ
+ *   (wait R}h̏]̗D揇ʂƓ)
+ * - I[g}g̓p^[ύXAŏ WaitMatchPut() ō蒼
+ */
+#include <stdlib.h>
+#include <string.h>
+
+#include "waitmatch.h"
+
+struct WaitMatch_st {
+	// o^p^[
+	int count;
+	int max;
+	char **str;
+	int *id;
+
+	// I[g}g
+	int built;
+	unsigned int generation;
+	unsigned char cls[256];		// oCg -> NX
+	int class_count;
+	int state_count;
+	int *next;					// Jڕ\ next[state * class_count + class]
+	int *out;					// ̏Ԃňvp^[̍ŏ id (0 = Ȃ)
+	int *outlen;				// out ̃p^[
+};
+
+static void FreeAutomaton(WaitMatch_t *wm)
+{
+	free(wm->next);
+	free(wm->out);
+	free(wm->outlen);
+	wm->next = NULL;
+	wm->out = NULL;
+	wm->outlen = NULL;
+	wm->state_count = 0;
+	wm->built = 0;
+	wm->generation++;
+}
+
+WaitMatch_t *WaitMatchCreate(void)
+{
+	WaitMatch_t *wm = (WaitMatch_t *)calloc(1, sizeof(*wm));
+	return wm;
+}
+
+void WaitMatchClear(WaitMatch_t *wm)
+{
+	int i;
+
+	for (i = 0; i < wm->count; i++) {
+		free(wm->str[i]);
+	}
+	free(wm->str);
+	free(wm->id);
+	wm->str = NULL;
+	wm->id = NULL;
+	wm->count = 0;
+	wm->max = 0;
+	FreeAutomaton(wm);
+}
+
+void WaitMatchDestroy(WaitMatch_t *wm)
+{
+	if (wm == NULL) {
+		return;
+	}
+	WaitMatchClear(wm);
+	free(wm);
+}
+
+/**
+ *	p^[ǉ
+ *
+ *	@param	id		vƂ WaitMatchPut() Ԃl (1ȏ)
+ *	@param	str		p^[
+ *	@retval	1		
+ *	@retval	0		s
+ */
+int WaitMatchAdd(WaitMatch_t *wm, int id, const char *str)
+{
+	char *s;
+
+	if (wm->count == wm->max) {
+		// mۂłƂւ
+		int max = wm->max == 0 ? 16 : wm->max * 2;
+		char **new_str = (char **)malloc(sizeof(char *) * max);
+		int *new_id = (int *)malloc(sizeof(int) * max);
+		if (new_str == NULL || new_id == NULL) {
+			free(new_str);
+			free(new_id);
+			return 0;
+		}
+		if (wm->count > 0) {
+			memcpy(new_str, wm->str, sizeof(char *) * wm->count);
+			memcpy(new_id, wm->id, sizeof(int) * wm->count);
+		}
+		free(wm->str);
+		free(wm->id);
+		wm->str = new_str;
+		wm->id = new_id;
+		wm->max = max;
+	}
+
+	s = _strdup(str);
+	if (s == NULL) {
+		return 0;
+	}
+	wm->str[wm->count] = s;
+	wm->id[wm->count] = id;
+	wm->count++;
+	FreeAutomaton(wm);
+	return 1;
+}
+
+int WaitMatchGetCount(const WaitMatch_t *wm)
+{
+	return wm->count;
+}
+
+static int Build(WaitMatch_t *wm)
+{
+	int total, C, i, u, c;
+	int *fail = NULL, *queue = NULL;
+	int head, tail;
+
+	// NX蓖Ă
+	memset(wm->cls, 0, sizeof(wm->cls));
+	C = 1;
+	total = 1;
+	for (i = 0; i < wm->count; i++) {
+		const unsigned char *p = (const unsigned char *)wm->str[i];
+		for (; *p != 0; p++) {
+			if (wm->cls[*p] == 0) {
+				wm->cls[*p] = (unsigned char)C++;
+			}
+			total++;
+		}
+	}
+	wm->class_count = C;
+
+	wm->next = (int *)malloc(sizeof(int) * total * C);
+	wm->out = (int *)calloc(total, sizeof(int));
+	wm->outlen = (int *)calloc(total, sizeof(int));
+	fail = (int *)malloc(sizeof(int) * total);
+	queue = (int *)malloc(sizeof(int) * total);
+	if (wm->next == NULL || wm->out == NULL || wm->outlen == NULL || fail == NULL || queue == NULL) {
+		free(fail);
+		free(queue);
+		FreeAutomaton(wm);
+		return 0;
+	}
+	memset(wm->next, 0xff, sizeof(int) * total * C);	// -1 = `
+
+	// gC؂
+	wm->state_count = 1;
+	for (i = 0; i < wm->count; i++) {
+		const unsigned char *p = (const unsigned char *)wm->str[i];
+		int len = (int)strlen(wm->str[i]);
+		u = 0;
+		for (; *p != 0; p++) {
+			int *t = &wm->next[u * C + wm->cls[*p]];
+			if (*t < 0) {
+				*t = wm->state_count++;
+			}
+			u = *t;
+		}
+		if (wm->out[u] == 0 || wm->id[i] < wm->out[u]) {
+			wm->out[u] = wm->id[i];
+			wm->outlen[u] = len;
+		}
+	}
+
+	// DŎsJڂ߁AJڕ\𖄂߂
+	head = tail = 0;
+	for (c = 0; c < C; c++) {
+		int v = wm->next[c];
+		if (v < 0) {
+			wm->next[c] = 0;
+		}
+		else {
+			fail[v] = 0;
+			queue[tail++] = v;
+		}
+	}
+	while (head < tail) {
+		int f;
+		u = queue[head++];
+		f = fail[u];
+		// sJڐňvp^[(ڔ)܂߂
+		if (wm->out[f] != 0 && (wm->out[u] == 0 || wm->out[f] < wm->out[u])) {
+			wm->out[u] = wm->out[f];
+			wm->outlen[u] = wm->outlen[f];
+		}
+		for (c = 0; c < C; c++) {
+			int *t = &wm->next[u * C + c];
+			if (*t < 0) {
+				*t = wm->next[f * C + c];
+			}
+			else {
+				fail[*t] = wm->next[f * C + c];
+				queue[tail++] = *t;
+			}
+		}
+	}
+
+	free(fail);
+	free(queue);
+	wm->built = 1;
+	return 1;
+}
+
+void WaitMatchReset(WaitMatchStream_t *s)
+{
+	s->state = 0;
+	s->generation = 0;
+	s->pos = 0;
+}
+
+/**
+ *	1oCg͂
+ *
+ *	@param	s		ƍ (MXg[ƂɎ)
+ *	@param	b		̓oCg
+ *	@param	offset	vp^[̐擪ʒu (s  pos ) ԂANULL 
+ *	@return	vp^[ idAvȂƂ 0
+ */
+int WaitMatchPut(WaitMatch_t *wm, WaitMatchStream_t *s, unsigned char b, unsigned long *offset)
+{
+	int id;
+
+	if (!wm->built && !Build(wm)) {
+		return 0;
+	}
+	if (s->generation != wm->generation) {
+		// p^[ύXꂽ̂œr܂ł̈v͎̂Ă
+		s->state = 0;
+		s->generation = wm->generation;
+	}
+
+	s->state = wm->next[s->state * wm->class_count + wm->cls[b]];
+	s->pos++;
+	id = wm->out[s->state];
+	if (id != 0 && offset != NULL) {
+		*offset = s->pos - wm->outlen[s->state];
+	}
+	return id;
+}
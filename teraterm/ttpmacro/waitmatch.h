@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2026- TeraTerm Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * waitmatch.h
+ *
+ * wait n}NR}hp̕񌟍 (Aho-Corasick)
+ */
+#ifndef _WAITMATCH_H_
+#define _WAITMATCH_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct WaitMatch_st WaitMatch_t;
+
+// MXg[Ƃ̏ƍ
+typedef struct {
+	int state;					// I[g}g̏
+	unsigned int generation;	// ԂƂ̃I[g}g̐
+	unsigned long pos;			// ܂łɓ͂oCg
+} WaitMatchStream_t;
+
+WaitMatch_t *WaitMatchCreate(void);
+void WaitMatchDestroy(WaitMatch_t *wm);
+void WaitMatchClear(WaitMatch_t *wm);
+int WaitMatchAdd(WaitMatch_t *wm, int id, const char *str);
+int WaitMatchGetCount(const WaitMatch_t *wm);
+void WaitMatchReset(WaitMatchStream_t *s);
+int WaitMatchPut(WaitMatch_t *wm, WaitMatchStream_t *s, unsigned char b, unsigned long *offset);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -1137,6 +1137,9 @@ void PASCAL _ReadIniFile(const wchar_t *FName, PTTSet ts)
 	ts->LogRotateSize = GetPrivateProfileInt(Section, "LogRotateSize", 0, FName);
 	ts->LogRotateSizeType = GetPrivateProfileInt(Section, "LogRotateSizeType", 0, FName);
 	ts->LogRotateStep = GetPrivateProfileInt(Section, "LogRotateStep", 0, FName);
+	ts->LogRotateNaming = GetPrivateProfileInt(Section, "LogRotateNaming", 0, FName);
+	ts->LogRotateCompress = GetOnOff(Section, "LogRotateCompress", FName, FALSE);
+	ts->LogRotateMaxTotalSize = GetPrivateProfileInt(Section, "LogRotateMaxTotalSize", 0, FName);
 
 	/* Deferred Log Write Mode (2013.4.20 yutaka) */
 	ts->DeferredLogWriteMode = GetOnOff(Section, "DeferredLogWriteMode", FName, TRUE);
@@ -2076,6 +2079,15 @@ void PASCAL _ReadIniFile(const wchar_t *FName, PTTSet ts)
 	ts->MessageBoxPosParentRelative = GetOnOff(Section, "MessageBoxPosParentRelative", FName, FALSE);
 	MessageBoxPosParentRelative = ts->MessageBoxPosParentRelative;
 
+	// Mobt@TCY
+	ts->RecvBuffSize = GetPrivateProfileInt(Section, "RecvBuffSize", RecvBuffSizeDefault, FName);
+	if (ts->RecvBuffSize < RecvBuffSizeMin) {
+		ts->RecvBuffSize = RecvBuffSizeMin;
+	}
+	else if (ts->RecvBuffSize > RecvBuffSizeMax) {
+		ts->RecvBuffSize = RecvBuffSizeMax;
+	}
+
 	// Experimental
 	ts->ExperimentalTreeProprtySheetEnable = GetOnOff("Experimental", "TreeProprtySheet", FName, FALSE);
 }
@@ -2619,6 +2631,9 @@ void PASCAL _WriteIniFile(const wchar_t *FName, PTTSet ts)
 	WriteInt(Section, "LogRotateSize", FName, ts->LogRotateSize);
 	WriteInt(Section, "LogRotateSizeType", FName, ts->LogRotateSizeType);
 	WriteInt(Section, "LogRotateStep", FName, ts->LogRotateStep);
+	WriteInt(Section, "LogRotateNaming", FName, ts->LogRotateNaming);
+	WriteOnOff(Section, "LogRotateCompress", FName, ts->LogRotateCompress);
+	WriteInt(Section, "LogRotateMaxTotalSize", FName, ts->LogRotateMaxTotalSize);
 
 	/* Deferred Log Write Mode (2013.4.20 yutaka) */
 	WriteOnOff(Section, "DeferredLogWriteMode", FName, ts->DeferredLogWriteMode);
@@ -3336,6 +3351,9 @@ void PASCAL _WriteIniFile(const wchar_t *FName, PTTSet ts)
 
 	// MessageBox̕\ʒu
 	WriteOnOff(Section, "MessageBoxPosParentRelative", FName, ts->MessageBoxPosParentRelative);
+
+	// Mobt@TCY
+	WriteInt(Section, "RecvBuffSize", FName, ts->RecvBuffSize);
 }
 
 void PASCAL _CopySerialList(const wchar_t *IniSrc, const wchar_t *IniDest, const wchar_t *section,
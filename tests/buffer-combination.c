@@ -0,0 +1,109 @@
+/*
+ * buffer.c ̃Rrl[Ve[ũeXg
+ *
+ *   Z Combination tO CombTable ̃GgvĂ邱ƂA
+ *   Z֐ (memcpyW/memmoveW/memsetW/BuffSetChar/BuffAddChar)
+ *   _ɌĂŊmF
+ *     - tOĂZ͕Ke[uɃGg
+ *     - e[ũGg̓tOĂZ̐Ɠ
+ *     - Rs[̃Rrl[V̓Rs[Ɠ
+ *
+ *   Linux/MinGW Ŏs
+ *     sh buffer-combination.sh []
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "buffcomb.h"
+
+#define CELLS	4096
+
+static buff_char_t Cells[CELLS];
+
+// eZ̃Rrl[V̊Ғl (Ōɕt, 0=Ȃ)
+static char32_t Expect[CELLS];
+
+static int Check(int iter)
+{
+	size_t flags = 0;
+	int i;
+
+	for (i = 0; i < CELLS; i++) {
+		size_t count;
+		const char32_t *p32 = GetCombinationChars32(&Cells[i], &count);
+		char32_t last = count == 0 ? 0 : p32[count - 1];
+		if (Cells[i].Combination) {
+			flags++;
+		}
+		if (last != Expect[i]) {
+			printf("NG iter=%d cell=%d U+%04X (expect U+%04X)\n", iter, i, (unsigned)last, (unsigned)Expect[i]);
+			return 0;
+		}
+	}
+	if (flags != CombCount) {
+		printf("NG iter=%d flags=%u entries=%u\n", iter, (unsigned)flags, (unsigned)CombCount);
+		return 0;
+	}
+	return 1;
+}
+
+int main(int argc, char *argv[])
+{
+	int iters = argc > 1 ? atoi(argv[1]) : 100000;
+	int i;
+
+	srand(1);
+	memsetW(Cells, ' ', 0, 0, 0, 0, CELLS);
+	for (i = 0; i < iters; i++) {
+		int dst = rand() % CELLS;
+		int src = rand() % CELLS;
+		int len = rand() % 200;
+		if (dst + len > CELLS) {
+			len = CELLS - dst;
+		}
+		if (src + len > CELLS) {
+			len = CELLS - src;
+		}
+		switch (rand() % 5) {
+		case 0:
+			BuffSetChar(&Cells[dst], 'a' + rand() % 26, 'H');
+			Expect[dst] = 0;
+			break;
+		case 1: {
+			char32_t u32 = 0x300 + rand() % 0x70;
+			BuffAddChar(&Cells[dst], u32);
+			Expect[dst] = u32;
+			break;
+		}
+		case 2:
+			if (dst < src || dst >= src + len) {
+				// dȂȂƂ
+				memcpyW(&Cells[dst], &Cells[src], len);
+				memcpy(&Expect[dst], &Expect[src], sizeof(char32_t) * len);
+				break;
+			}
+			// fall through
+		case 3:
+			memmoveW(&Cells[dst], &Cells[src], len);
+			memmove(&Expect[dst], &Expect[src], sizeof(char32_t) * len);
+			break;
+		case 4:
+			memsetW(&Cells[dst], ' ', 0, 0, 0, 0, len);
+			memset(&Expect[dst], 0, sizeof(char32_t) * len);
+			break;
+		}
+		if (!Check(i)) {
+			return 1;
+		}
+	}
+
+	memsetW(Cells, ' ', 0, 0, 0, 0, CELLS);
+	if (CombCount != 0) {
+		printf("NG %u entries left\n", (unsigned)CombCount);
+		return 1;
+	}
+	printf("OK %d iterations, table size %u\n", iters, (unsigned)CombTableSize);
+	return 0;
+}
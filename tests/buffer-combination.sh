@@ -0,0 +1,57 @@
+#!/bin/sh
+# buffer.c のコンビネーション文字テーブル (CombTable) のテストをビルドして実行する
+#   buffer.c からセルの定義とセルを書き換える関数を取り出し、
+#   使う型と関数だけを定義したヘッダと合わせてビルドする
+#   usage: buffer-combination.sh [回数]
+
+cd "$(dirname "$0")"
+CC=${CC:-cc}
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+
+{
+	cat <<'EOT'
+#pragma once
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <uchar.h>
+#include <wchar.h>
+typedef int BOOL;
+#define TRUE 1
+#define FALSE 0
+#define AttrDefaultFG 0
+#define AttrDefaultBG 0
+#define MAX_CHAR_SIZE 100
+static int CodePage = 932;
+static size_t UTF32ToMBCP(char32_t u32, int code_page, char *mb, size_t mb_len)
+{
+	(void)u32; (void)code_page; (void)mb_len;
+	mb[0] = '?';
+	return 1;
+}
+static size_t UTF32ToUTF16(char32_t u32, wchar_t *wstr, size_t wstr_len)
+{
+	(void)wstr_len;
+	if (u32 < 0x10000) {
+		wstr[0] = (wchar_t)u32;
+		return 1;
+	}
+	u32 -= 0x10000;
+	wstr[0] = (wchar_t)(0xd800 | (u32 >> 10));
+	wstr[1] = (wchar_t)(0xdc00 | (u32 & 0x3ff));
+	return 2;
+}
+EOT
+	# セルの定義 ～ CombCount, CombHash() ～ memmoveW()
+	iconv -f cp932 -t utf-8 ../teraterm/teraterm/buffer.c | tr -d '\r' |
+		awk '/^typedef struct {/ && !done1 { on = 1 }
+			/^static size_t CombHash\(/ { on = 1 }
+			/^static BOOL IsBuffPadding\(/ { exit }
+			on { print }
+			/^static size_t CombCount;/ { on = 0; done1 = 1 }'
+} > "$tmp/buffcomb.h"
+
+iconv -f cp932 -t utf-8 buffer-combination.c | tr -d '\r' > "$tmp/buffer-combination.c"
+$CC -O2 -w -I"$tmp" -o "$tmp/buffer-combination" "$tmp/buffer-combination.c" &&
+"$tmp/buffer-combination" "$@"
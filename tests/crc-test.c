@@ -0,0 +1,125 @@
+/*
+ * ftlib.c  CRC ̃eXg
+ *
+ *   - Qƒl ("123456789"  CRC-16/XMODEM, CRC-32)
+ *   - 1rbgvZƂ̔r (, Jnʒuς)
+ *   - obt@ł̑x (MB/s)
+ *
+ *   Linux/MinGW Ŏs
+ *     sh crc-test.sh
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <windows.h>
+
+#include "ftlib.h"
+
+static WORD RefCRC16(const BYTE *p, size_t len, WORD crc)
+{
+	while (len-- > 0) {
+		int i;
+		crc ^= (WORD)(*p++ << 8);
+		for (i = 0; i < 8; i++) {
+			crc = (crc & 0x8000) ? (WORD)((crc << 1) ^ 0x1021) : (WORD)(crc << 1);
+		}
+	}
+	return crc;
+}
+
+static DWORD RefCRC32(const BYTE *p, size_t len, DWORD crc)
+{
+	while (len-- > 0) {
+		int i;
+		crc ^= *p++;
+		for (i = 0; i < 8; i++) {
+			crc = (crc & 1) ? (crc >> 1) ^ 0xedb88320 : (crc >> 1);
+		}
+	}
+	return crc;
+}
+
+static int errors;
+
+static void Check(const char *name, DWORD result, DWORD expect)
+{
+	if (result != expect) {
+		printf("NG %s: %08lx (expect %08lx)\n", name, (unsigned long)result, (unsigned long)expect);
+		errors++;
+	}
+}
+
+static double Now(void)
+{
+	return (double)clock() / CLOCKS_PER_SEC;
+}
+
+int main(void)
+{
+	static const BYTE vec[] = "123456789";
+	const size_t size = 1024 * 1024;
+	BYTE *buf = (BYTE *)malloc(size + 8);
+	size_t i;
+	int ofs;
+	double t;
+	int loop;
+	WORD crc16;
+	LONG crc32;
+
+	for (i = 0; i < size + 8; i++) {
+		buf[i] = (BYTE)rand();
+	}
+
+	/* Qƒl */
+	Check("CRC16 vector", UpdateCRCBuf(vec, 9, 0), 0x31c3);
+	Check("CRC32 vector", ~(DWORD)UpdateCRC32Buf(vec, 9, (LONG)0xffffffff), 0xcbf43926);
+	crc16 = 0;
+	crc32 = (LONG)0xffffffff;
+	for (i = 0; i < 9; i++) {
+		crc16 = UpdateCRC(vec[i], crc16);
+		crc32 = UpdateCRC32(vec[i], crc32);
+	}
+	Check("CRC16 vector (1byte)", crc16, 0x31c3);
+	Check("CRC32 vector (1byte)", ~(DWORD)crc32, 0xcbf43926);
+
+	/* ƊJnʒuςĔr */
+	for (ofs = 0; ofs < 8; ofs++) {
+		for (i = 0; i < 1100; i++) {
+			WORD init16 = (WORD)(i * 7919);
+			DWORD init32 = (DWORD)(i * 2654435761u);
+			Check("CRC16", UpdateCRCBuf(buf + ofs, i, init16), RefCRC16(buf + ofs, i, init16));
+			Check("CRC32", (DWORD)UpdateCRC32Buf(buf + ofs, i, (LONG)init32), RefCRC32(buf + ofs, i, init32));
+		}
+	}
+
+	/* x */
+	t = Now();
+	crc16 = 0;
+	for (loop = 0; loop < 256; loop++) {
+		crc16 = UpdateCRCBuf(buf, size, crc16);
+	}
+	t = Now() - t;
+	printf("CRC16 %.0f MB/s (%04x)\n", 256 / t, crc16);
+
+	t = Now();
+	crc32 = 0;
+	for (loop = 0; loop < 256; loop++) {
+		crc32 = UpdateCRC32Buf(buf, size, crc32);
+	}
+	t = Now() - t;
+	printf("CRC32 %.0f MB/s (%08lx)\n", 256 / t, (unsigned long)crc32);
+
+	t = Now();
+	crc16 = 0;
+	for (loop = 0; loop < 16; loop++) {
+		crc16 = RefCRC16(buf, size, crc16);
+	}
+	t = Now() - t;
+	printf("CRC16 bitwise %.0f MB/s (%04x)\n", 16 / t, crc16);
+
+	free(buf);
+	printf("%s\n", errors == 0 ? "OK" : "NG");
+	return errors == 0 ? 0 : 1;
+}
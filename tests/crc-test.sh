@@ -0,0 +1,31 @@
+#!/bin/sh
+# ftlib.c の CRC のテストをビルドして実行する
+#   usage: crc-test.sh
+#   Linux では BYTE などの型だけを定義した windows.h を用意してビルドする
+
+cd "$(dirname "$0")"
+CC=${CC:-cc}
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+
+case "$(uname -s)" in
+  MINGW*|MSYS*|CYGWIN*)
+    inc=""
+    ;;
+  *)
+    cat > "$tmp/windows.h" <<'EOT'
+#include <stddef.h>
+#include <stdint.h>
+typedef uint8_t BYTE;
+typedef uint16_t WORD;
+typedef uint32_t DWORD;
+typedef int32_t LONG;
+typedef int BOOL;
+#define TRUE 1
+#define FALSE 0
+EOT
+    inc="-I$tmp"
+    ;;
+esac
+
+$CC -O2 $inc -I../teraterm/ttpfile -o "$tmp/crc-test" crc-test.c ../teraterm/ttpfile/ftlib.c && "$tmp/crc-test"
@@ -0,0 +1,341 @@
+/*
+ * known_hosts ̍̃eXg
+ *
+ *   ttssh2/ttxssh/hostsindex.c rhA_~[ known_hosts 
+ *   ňʂASsɏƍʂƓɂȂ邩m߂
+ *   킹 1 ̌ɂ鎞Ԃׂ
+ *     linear: Ssƍ (Ȃ)
+ *     cold:    (̃zXg߂ĈƂ)
+ *     warm:    (zXg 2 ڈȍ~ɈƂ)
+ *
+ *   Gg 20  12  "host", 3  "[host]:port",
+ *   4 nbVꂽzXg, 1  "host,address"
+ *   ChJ[hAےARg
+ *
+ *   Linux/MinGW Ŏs (OpenSSL Kv)
+ *     sh known-hosts-index.sh [Gg...]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+#include <openssl/rand.h>
+
+#include "b64decode.c"
+#include "matcher.c"
+#include "hostsindex.c"
+
+#define MAX_LINES 4096  /* 1 ̌Ōs̍ő */
+
+typedef struct {
+	char host[64];
+	unsigned short port;
+} Query;
+
+typedef struct {
+	char *buf;
+	size_t len, max;
+} Text;
+
+static void Append(Text *t, const char *s)
+{
+	size_t n = strlen(s);
+	if (t->len + n + 1 > t->max) {
+		t->max = (t->len + n + 1) * 2;
+		t->buf = realloc(t->buf, t->max);
+	}
+	memcpy(t->buf + t->len, s, n + 1);
+	t->len += n;
+}
+
+static void AppendKey(Text *t)
+{
+	static const char b64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+	char key[128];
+	int i;
+
+	strcpy(key, " ssh-ed25519 AAAAC3NzaC1lZDI1NTE5AAAAI");
+	for (i = 0; i < 43; i++) {
+		char c[2] = { b64[rand() % 64], 0 };
+		strcat(key, c);
+	}
+	strcat(key, "\n");
+	Append(t, key);
+}
+
+static void AppendHashed(Text *t, const char *host, unsigned short port)
+{
+	unsigned char salt[20], hash[20];
+	unsigned char salt64[32], hash64[32];
+	char name[96], line[128];
+	unsigned int len;
+
+	RAND_bytes(salt, sizeof(salt));
+	if (port == 22) {
+		snprintf(name, sizeof(name), "%s", host);
+	} else {
+		snprintf(name, sizeof(name), "[%s]:%u", host, port);
+	}
+	HMAC(EVP_sha1(), salt, sizeof(salt), (unsigned char *)name, strlen(name), hash, &len);
+	EVP_EncodeBlock(salt64, salt, sizeof(salt));
+	EVP_EncodeBlock(hash64, hash, sizeof(hash));
+	snprintf(line, sizeof(line), "|1|%s|%s", salt64, hash64);
+	Append(t, line);
+}
+
+/* _~[ known_hosts Bqueries[i]  i Ԗڂ̃Gg̃zXg */
+static char *MakeKnownHosts(int num, Query *queries)
+{
+	Text t = { NULL, 0, 0 };
+	char line[128];
+	int i;
+
+	Append(&t, "# known_hosts for test\n");
+	for (i = 0; i < num; i++) {
+		Query *q = &queries[i];
+		int kind = i % 20;
+
+		if (i % 1000 == 500) {
+			snprintf(line, sizeof(line), "\n# group %d\n*.wild%d.example.net", i / 1000, i / 1000);
+			Append(&t, line);
+			AppendKey(&t);
+			Append(&t, "!deny.example.org,*.example.org");
+			AppendKey(&t);
+		}
+
+		snprintf(q->host, sizeof(q->host), "host%d.example.com", i);
+		q->port = 22;
+		if (kind < 12) {
+			Append(&t, q->host);
+		} else if (kind < 15) {
+			q->port = 2200 + i % 7;
+			snprintf(line, sizeof(line), "[%s]:%u", q->host, q->port);
+			Append(&t, line);
+		} else if (kind < 19) {
+			if (i % 2) {
+				q->port = 2222;
+			}
+			AppendHashed(&t, q->host, q->port);
+		} else {
+			snprintf(line, sizeof(line), "%s,10.%d.%d.%d", q->host, (i >> 16) & 255, (i >> 8) & 255, i & 255);
+			Append(&t, line);
+		}
+		AppendKey(&t);
+	}
+	return t.buf;
+}
+
+/* hosts.c  check_host_key() Ɠƍ */
+static int LineMatches(char *data, const char *hostname, unsigned short tcpport)
+{
+	int index = 0;
+	int matched = 0;
+
+	while (data[index] == ' ' || data[index] == '\t') {
+		index++;
+	}
+	if (data[index] == '#') {
+		return 0;
+	}
+
+	index--;
+	do {
+		int negated;
+		int bracketed;
+		char *end_bracket = NULL;
+		int host_matched;
+		unsigned short keyfile_port = 22;
+
+		index++;
+		negated = data[index] == '!';
+		if (negated) {
+			index++;
+		}
+		if (!negated && data[index] == '|') {
+			if (hostsindex_match_hashed(data + index, hostname, tcpport)) {
+				matched = 1;
+			}
+		} else {
+			bracketed = data[index] == '[';
+			if (bracketed) {
+				end_bracket = strstr(data + index + 1, "]:");
+				if (end_bracket != NULL) {
+					*end_bracket = ' ';
+					index++;
+				}
+			}
+			host_matched = match_pattern(data + index, hostname);
+			if (bracketed && end_bracket != NULL) {
+				*end_bracket = ']';
+				keyfile_port = atoi(end_bracket + 2);
+			}
+			if (host_matched && keyfile_port == tcpport) {
+				if (negated) {
+					return 0;
+				}
+				matched = 1;
+			}
+		}
+		while (is_pattern_char(data[index])) {
+			index++;
+		}
+	} while (data[index] == ',');
+
+	return matched;
+}
+
+static int NextLine(const char *data, int index)
+{
+	while (data[index] != '\n' && data[index] != '\r' && data[index] != 0) {
+		index++;
+	}
+	while (data[index] == '\n' || data[index] == '\r') {
+		index++;
+	}
+	return index;
+}
+
+/* g킸ɑSsƍ */
+static int LinearLookup(char *data, const char *hostname, unsigned short tcpport, int *lines)
+{
+	int index = 0;
+	int num = 0;
+
+	while (data[index] != 0) {
+		if (num < MAX_LINES && LineMatches(data + index, hostname, tcpport)) {
+			lines[num++] = index;
+		}
+		index = NextLine(data, index);
+	}
+	return num;
+}
+
+/* ň̂Aۂɏƍłs */
+static int IndexLookup(hostsindex_t *idx, char *data, const char *hostname, unsigned short tcpport, int *lines)
+{
+	const int *cand;
+	int n, i, num = 0;
+
+	n = hostsindex_lookup(idx, hostname, tcpport, &cand);
+	if (n < 0) {
+		return -1;
+	}
+	for (i = 0; i < n; i++) {
+		if (num < MAX_LINES && LineMatches(data + cand[i], hostname, tcpport)) {
+			lines[num++] = cand[i];
+		}
+	}
+	return num;
+}
+
+static double Now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int Check(hostsindex_t *idx, char *data, const char *hostname, unsigned short tcpport, int expect_found)
+{
+	static int a[MAX_LINES], b[MAX_LINES];
+	int na = LinearLookup(data, hostname, tcpport, a);
+	int nb = IndexLookup(idx, data, hostname, tcpport, b);
+
+	if (na != nb || memcmp(a, b, na * sizeof(int)) != 0 || (expect_found && na == 0)) {
+		printf("NG: %s:%u linear %d lines, index %d lines\n", hostname, tcpport, na, nb);
+		return 0;
+	}
+	return 1;
+}
+
+static int Run(int num)
+{
+	Query *queries = malloc(sizeof(Query) * num);
+	char *data = MakeKnownHosts(num, queries);
+	hostsindex_t *idx;
+	int lines[MAX_LINES];
+	int checks = num <= 1000 ? num : 200;
+	int linear_num = num <= 1000 ? 200 : 10;
+	int cold_num = num <= 1000 ? 1000 : 50;
+	int warm_num = 100000;
+	double t0, t_build, t_linear, t_cold, t_warm;
+	int ok = 1;
+	int i;
+
+	t0 = Now();
+	idx = hostsindex_build(data);
+	t_build = Now() - t0;
+	if (idx == NULL) {
+		printf("NG: hostsindex_build() failed\n");
+		return 0;
+	}
+
+	// o^ĂzXgA|[gႢAo^AChJ[hAے
+	for (i = 0; i < checks && ok; i++) {
+		Query *q = &queries[(int)((i * 7919L) % num)];
+		ok = Check(idx, data, q->host, q->port, 1) &&
+		     Check(idx, data, q->host, (unsigned short)(q->port + 1), 0);
+	}
+	ok = ok && Check(idx, data, "unknown.example.com", 22, 0);
+	if (num > 500) {
+		ok = ok && Check(idx, data, "a.wild0.example.net", 22, 1) &&
+		     Check(idx, data, "x.example.org", 22, 1) &&
+		     Check(idx, data, "deny.example.org", 22, 0);
+	}
+
+	// 
+	t0 = Now();
+	for (i = 0; i < linear_num; i++) {
+		Query *q = &queries[(int)((i * 104729L) % num)];
+		LinearLookup(data, q->host, q->port, lines);
+	}
+	t_linear = (Now() - t0) / linear_num;
+
+	hostsindex_free(idx);
+	idx = hostsindex_build(data);
+	t0 = Now();
+	for (i = 0; i < cold_num; i++) {
+		Query *q = &queries[(int)((i * 104729L) % num)];
+		IndexLookup(idx, data, q->host, q->port, lines);
+	}
+	t_cold = (Now() - t0) / cold_num;
+
+	t0 = Now();
+	for (i = 0; i < warm_num; i++) {
+		Query *q = &queries[0];
+		IndexLookup(idx, data, q->host, q->port, lines);
+	}
+	t_warm = (Now() - t0) / warm_num;
+
+	printf("%6d entries (%4d hashed): build %8.2f ms, linear %9.1f us, cold %9.1f us, warm %6.2f us\n",
+	       num, idx->hashed_num, t_build * 1e3, t_linear * 1e6, t_cold * 1e6, t_warm * 1e6);
+
+	hostsindex_free(idx);
+	free(data);
+	free(queries);
+	return ok;
+}
+
+int main(int argc, char *argv[])
+{
+	static const int defaults[] = { 1000, 100000 };
+	int ok = 1;
+	int i;
+
+	srand(1);
+	if (argc > 1) {
+		for (i = 1; i < argc; i++) {
+			ok = Run(atoi(argv[i])) && ok;
+		}
+	} else {
+		for (i = 0; i < 2; i++) {
+			ok = Run(defaults[i]) && ok;
+		}
+	}
+	printf("%s\n", ok ? "OK" : "NG");
+	return ok ? 0 : 1;
+}
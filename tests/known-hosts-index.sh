@@ -0,0 +1,41 @@
+#!/bin/sh
+# hostsindex.c (known_hosts の索引) をテストする
+#   hostsindex.c と matcher.c をそのままビルドし、ttxssh.h などは
+#   使う部分だけを定義したものを用意する
+#   usage: known-hosts-index.sh [エントリ数...]
+
+cd "$(dirname "$0")"
+CC=${CC:-cc}
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+
+cat > "$tmp/windows.h" <<'EOT'
+#pragma once
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+typedef int BOOL;
+typedef char *PCHAR;
+#define TRUE 1
+#define FALSE 0
+#define _TRUNCATE 0
+#define _snprintf_s(b, n, t, ...) snprintf(b, n, __VA_ARGS__)
+#define _strdup strdup
+int b64decode(PCHAR dst, int dsize, PCHAR src);
+EOT
+echo '#include <windows.h>' > "$tmp/ttxssh.h"
+
+# ソースは CP932 なので UTF-8 に変換する
+for f in ../ttssh2/ttxssh/hostsindex.c ../ttssh2/ttxssh/hostsindex.h ../ttssh2/matcher/matcher.c ../ttssh2/matcher/matcher.h; do
+	iconv -f cp932 -t utf-8 $f | tr -d '\r' > "$tmp/$(basename $f)"
+done
+{
+	echo '#include <windows.h>'
+	iconv -f cp932 -t utf-8 ../teraterm/common/ttlib.c | tr -d '\r' |
+		sed -n '/^static char b64dec_table/,/^};/p; /^int b64decode(/,/^}/p'
+} > "$tmp/b64decode.c"
+
+iconv -f cp932 -t utf-8 known-hosts-index.c | tr -d '\r' > "$tmp/known-hosts-index.c"
+$CC -O2 -w -I"$tmp" -o "$tmp/known-hosts-index" "$tmp/known-hosts-index.c" -lcrypto &&
+"$tmp/known-hosts-index" "$@"
@@ -0,0 +1,48 @@
+#!/bin/sh
+# ログ書き込みのスループットを計測する
+#   Tera Term でログ (テキスト/バイナリどちらでも) を開始してから、ホスト側で実行する
+#   usage: log-throughput.sh [MB]
+#          log-throughput.sh check <logfile>
+#   - 連番付きの行を大量に送り、送信にかかった時間を表示する
+#     DeferredLogWriteMode=on と off で比較する
+#   - check でログファイルを調べ、行の欠落や順序の乱れがないか確認する
+#     (タイムスタンプ付きのログでもよい)
+#     書き込みが追いつかないときは受信処理を止めずに古いログを捨てるので、
+#     欠落があれば下の dropped も 0 ではない
+#   - TERATERM.INI の Debug=on のとき、ログを閉じるとデバッグ出力 (DebugView など)
+#     に FileTransEnd_: の行で書き込みバイト数, WriteFile 回数,
+#     あふれで捨てたバイト数 (dropped), 書き込みスレッドが追いつかなかった回数
+#     (stalled) が出力される (リリースビルドでも出力される)
+
+if [ "x$1" = "xcheck" ]; then
+  awk '
+    /LOGTEST [0-9]+ / {
+      sub(/.*LOGTEST /, "")
+      n = $1 + 0
+      if (count > 0 && n != prev + 1) {
+        printf "gap: %d -> %d\n", prev, n
+        gaps++
+      }
+      prev = n
+      count++
+    }
+    END { printf "%d lines, %d gaps\n", count, gaps; exit (gaps > 0) }
+  ' "$2"
+  exit $?
+fi
+
+size_mb=${1:-64}
+lines=$((size_mb * 1048576 / 80))
+
+start=$(date +%s.%N)
+awk -v n=$lines 'BEGIN {
+  pad = "................................................................................"
+  for (i = 0; i < n; i++) {
+    printf "LOGTEST %d %s\n", i, substr(pad, 1, 70 - length(i ""))
+  }
+}'
+end=$(date +%s.%N)
+
+printf "\n%s MB (%d lines) in %s sec, %s MB/s\n" $size_mb $lines \
+  $(echo "$end - $start" | bc) \
+  $(echo "scale=2; $size_mb / ($end - $start)" | bc)
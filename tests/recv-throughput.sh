@@ -0,0 +1,63 @@
+#!/bin/sh
+# 受信処理のスループットを計測する
+#   ホスト側で実行し、Tera Term に大量のテキストを送る
+#   usage: recv-throughput.sh [MB] [ascii|utf8|sgr]
+#   送信後に DSR (CSI 6 n) を送り、Tera Term から CPR が返るまでを計る。
+#   CPR は前のデータをすべて処理してから返されるので、ホストの cat ではなく
+#   Tera Term の受信・解析の時間 (と通信路の時間) になる。
+#   SSH 接続で実行した場合は、切断時に TTSSH のログ (LogLevel 100 以上) に
+#   PKT_end: の行で受信バイト数と受信バッファ内のコピー量 (copies/byte) が出力される
+#   接続なしで pkt.c だけを計測するときは ssh-recv-loopback.sh を使う
+
+size_mb=${1:-32}
+kind=${2:-ascii}
+
+tmp=$(mktemp)
+tty_mode=$(stty -g)
+trap 'stty "$tty_mode"; rm -f "$tmp"' EXIT
+
+esc=$(printf '\033')
+case "$kind" in
+  utf8)
+    line="[build] コンパイル中 src/teraterm/vtterm.c -> vtterm.obj (警告 0 件) αβγ"
+    ;;
+  sgr)
+    line="${esc}[32m[ OK ]${esc}[0m gcc -O2 -c src/teraterm/vtterm.c -o vtterm.o ${esc}[1mdone${esc}[0m"
+    ;;
+  *)
+    line="[build] gcc -O2 -Wall -c src/teraterm/vtterm.c -o obj/vtterm.o # 0 warnings"
+    ;;
+esac
+
+# 1MB 分の行を作成
+i=0
+while [ $i -lt 16384 ]; do
+  printf "%s %d\n" "$line" $i
+  i=$((i+1))
+done | head -c 1048576 > "$tmp"
+
+# DSR を送り、CPR (CSI 行;桁 R) が返るまで待つ
+wait_cpr() {
+  printf '\033[6n'
+  while :; do
+    c=$(dd bs=1 count=1 2>/dev/null)
+    [ -z "$c" ] && { echo "no response from terminal" >&2; exit 1; }
+    [ "$c" = "R" ] && break
+  done
+}
+
+stty -icanon -echo min 0 time 100
+wait_cpr
+start=$(date +%s.%N)
+n=0
+while [ $n -lt $size_mb ]; do
+  cat "$tmp"
+  n=$((n+1))
+done
+wait_cpr
+end=$(date +%s.%N)
+stty "$tty_mode"
+
+printf "\n%s MB (%s) in %s sec, %s MB/s\n" $size_mb $kind \
+  $(echo "$end - $start" | bc) \
+  $(echo "scale=2; $size_mb / ($end - $start)" | bc)
@@ -0,0 +1,27 @@
+#!/bin/sh
+# スクロールバッファのメモリ使用量を確認する
+#   ホスト側で実行し、スクロールバッファを埋める
+#   Tera Term の "ScrollBuffSize=500000" で、実行前後のワーキングセット
+#   (タスクマネージャー等) を比較する
+#   usage: scrollback-memory.sh [lines] [ascii|combining]
+
+lines=${1:-500000}
+kind=${2:-ascii}
+
+case "$kind" in
+  combining)
+    # 結合文字を含む行
+    line="e\314\201 a\314\200 n\314\203 o\314\210 ASCII text with combining marks"
+    ;;
+  *)
+    line="[build] gcc -O2 -Wall -c src/teraterm/buffer.c -o obj/buffer.o # 0 warnings"
+    ;;
+esac
+
+i=0
+while [ $i -lt $lines ]; do
+  printf "%7d $line\n" $i
+  i=$((i+1))
+done
+
+printf "\n%d lines (%s)\n" $lines $kind
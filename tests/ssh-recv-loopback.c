@@ -0,0 +1,260 @@
+/*
+ * SSH Mobt@ (pkt.c) ̃[vobNeXg
+ *
+ *   pkt.c  PKT_recv() ɁASSH2  CHANNEL_DATA pPbg TCP 
+ *   ZOgɕ̂ recv() œnAo payload ̓e
+ *   vƁAMobt@ŋlߒ (memmove ) oCg\
+ *   "copies/byte"  memmove oCg / recv() ŎMoCg
+ *   Í MAC ̌؂͂Ȃ̂ŁAԂ̓obt@̈̂
+ *
+ *   segment  0 w肷ƁA낢ȑ傫̃ZOgɎg
+ *
+ *   Linux/MinGW Ŏs
+ *     sh ssh-recv-loopback.sh [MB] [packet] [segment]
+ *   ύXO pkt.c ƔׂƂ PKT_C ɂ̃t@Cw肷
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <time.h>
+
+#include "ttxssh.h"
+#include "pkt.h"
+
+#define MAC_LEN		32		/* hmac-sha2-256-etm  */
+#define APP_BUFF	(64*1024)	/* Tera Term ̎Mobt@ */
+
+static const int mixed_segments[] = {
+	1448, 2896, 65536, 1448, 16384, 4344, 32768 + 100, 7240, 1448 * 20,
+};
+
+/* M (T[o[) */
+static unsigned char *wire;		/* 1 pPbg */
+static size_t wire_len;
+static size_t wire_pos;
+static size_t sent_data;		/* CHANNEL_DATA ƂđoCg */
+static size_t wire_bytes;		/* recv() œnoCg */
+static size_t total_data;
+static int packet_data;
+static int segment;
+static int segment_index;
+
+/* MŊmFʒu */
+static size_t recv_data_count;
+static int data_error;
+
+static unsigned long long moved_bytes;
+
+static unsigned char Pattern(size_t pos)
+{
+	return (unsigned char)((pos * 7) ^ (pos >> 11));
+}
+
+void *CountMemmove(void *dest, const void *src, size_t n)
+{
+	moved_bytes += n;
+	return (memmove)(dest, src, n);
+}
+
+/* ̃pPbg */
+static void MakePacket(void)
+{
+	size_t len = total_data - sent_data;
+	unsigned int padding = 4;
+	unsigned int pktsize;
+	size_t i;
+
+	if (len > (size_t)packet_data) {
+		len = packet_data;
+	}
+	/* padding_length + payload (type, channel, length, data) + padding */
+	pktsize = 1 + 9 + (unsigned int)len + padding;
+	wire_len = 4 + pktsize + MAC_LEN;
+	wire = (unsigned char *)realloc(wire, wire_len);
+	set_uint32_MSBfirst(wire, pktsize);
+	wire[4] = (unsigned char)padding;
+	wire[5] = 94;	/* SSH2_MSG_CHANNEL_DATA */
+	set_uint32_MSBfirst(wire + 6, 0);
+	set_uint32_MSBfirst(wire + 10, len);
+	for (i = 0; i < len; i++) {
+		wire[14 + i] = Pattern(sent_data + i);
+	}
+	memset(wire + 14 + len, 0, padding + MAC_LEN);
+	sent_data += len;
+	wire_pos = 0;
+}
+
+static int PASCAL LoopRecv(SOCKET s, char *buf, int len, int flags)
+{
+	int seg = segment;
+	int done = 0;
+
+	(void)s;
+	(void)flags;
+	if (seg == 0) {
+		seg = mixed_segments[segment_index];
+		segment_index = (segment_index + 1) % _countof(mixed_segments);
+	}
+	if (len > seg) {
+		len = seg;
+	}
+	while (done < len) {
+		size_t n;
+		if (wire_pos == wire_len) {
+			if (sent_data == total_data) {
+				break;
+			}
+			MakePacket();
+		}
+		n = wire_len - wire_pos;
+		if (n > (size_t)(len - done)) {
+			n = len - done;
+		}
+		memcpy(buf + done, wire + wire_pos, n);
+		wire_pos += n;
+		done += (int)n;
+	}
+	wire_bytes += done;
+	return done;
+}
+
+/* ssh.c ̑ */
+unsigned int SSH_get_min_packet_size(PTInstVar pvar)
+{
+	(void)pvar;
+	return 16;
+}
+
+unsigned int SSH_get_authdata_size(PTInstVar pvar, int direction)
+{
+	(void)pvar;
+	(void)direction;
+	return MAC_LEN;
+}
+
+void SSH2_handle_packet(PTInstVar pvar, char *data, unsigned int len, unsigned int aadlen, unsigned int authlen)
+{
+	unsigned char *p = (unsigned char *)data + 4;
+	unsigned int padding = p[0];
+	unsigned int datalen = get_uint32_MSBfirst(p + 6);
+
+	(void)aadlen;
+	(void)authlen;
+	if (p[1] != 94 || datalen + 9 + padding + 1 != len) {
+		data_error = 1;
+		return;
+	}
+	/* ssh.c ƓApayload ͎Mobt@w܂܂ɂ */
+	pvar->ssh_state.payload = p + 10;
+	pvar->ssh_state.payload_datalen = datalen;
+}
+
+int SSH_extract_payload(PTInstVar pvar, unsigned char *dest, int len)
+{
+	int n = pvar->ssh_state.payload_datalen;
+
+	if (n > len) {
+		n = len;
+	}
+	memcpy(dest, pvar->ssh_state.payload, n);
+	pvar->ssh_state.payload += n;
+	pvar->ssh_state.payload_datalen -= n;
+	return n;
+}
+
+BOOL SSH_handle_server_ID(PTInstVar pvar, char *ID, int ID_len)
+{
+	(void)pvar;
+	(void)ID;
+	(void)ID_len;
+	return TRUE;
+}
+
+void SSH2_send_kexinit(PTInstVar pvar) { (void)pvar; }
+void SSH_predecrypt_packet(PTInstVar pvar, char *data) { (void)pvar; (void)data; }
+void SSH1_handle_packet(PTInstVar pvar, char *data, unsigned int len, unsigned int padding)
+{
+	(void)pvar; (void)data; (void)len; (void)padding;
+	data_error = 1;
+}
+int chachapoly_get_length(void *ctx, uint32 *plenp, unsigned int seqnr, const char *cp, unsigned int len)
+{
+	(void)ctx; (void)plenp; (void)seqnr; (void)cp; (void)len;
+	data_error = 1;
+	return -1;
+}
+
+void UTIL_get_lang_msg(const char *key, PTInstVar pvar, const char *def)
+{
+	(void)key;
+	strncpy_s(pvar->UIMsg, sizeof(pvar->UIMsg), def, _TRUNCATE);
+}
+
+void notify_fatal_error(PTInstVar pvar, char *msg, BOOL send_disconnect)
+{
+	(void)send_disconnect;
+	printf("fatal: %s\n", msg);
+	pvar->fatal_error = TRUE;
+}
+
+void logprintf(int level, const char *fmt, ...)
+{
+	va_list ap;
+
+	(void)level;
+	va_start(ap, fmt);
+	vprintf(fmt, ap);
+	va_end(ap);
+	printf("\n");
+}
+
+int main(int argc, char *argv[])
+{
+	size_t mb = argc > 1 ? (size_t)atoi(argv[1]) : 256;
+	static TInstVar inst;
+	PTInstVar pvar = &inst;
+	static char app[APP_BUFF];
+	clock_t t;
+	double sec;
+	int ok;
+
+	packet_data = argc > 2 ? atoi(argv[2]) : 32 * 1024;
+	segment = argc > 3 ? atoi(argv[3]) : 0;
+	total_data = mb * 1024 * 1024 + 777;	/* [̂钷 */
+
+	pvar->Precv = LoopRecv;
+	pvar->ssh2_keys[MODE_IN].mac.etm = 1;	/* pPbg͈ÍĂȂ */
+	PKT_init(pvar);
+	pvar->pkt_state.seen_server_ID = TRUE;
+
+	t = clock();
+	for (;;) {
+		int i;
+		int n = PKT_recv(pvar, app, sizeof(app));
+		if (n <= 0 || pvar->fatal_error) {
+			break;
+		}
+		for (i = 0; i < n; i++) {
+			if ((unsigned char)app[i] != Pattern(recv_data_count + i)) {
+				data_error = 1;
+				break;
+			}
+		}
+		recv_data_count += n;
+	}
+	sec = (double)(clock() - t) / CLOCKS_PER_SEC;
+
+	printf("%zu bytes (packet %d, segment %s), %.2f s, %.1f MB/s\n",
+		   recv_data_count, packet_data, segment == 0 ? "mixed" : argv[3], sec,
+		   sec > 0 ? recv_data_count / sec / (1024 * 1024) : 0.0);
+	printf("memmove %llu bytes, %.4f copies/byte\n", moved_bytes,
+		   (double)moved_bytes / (wire_bytes > 0 ? wire_bytes : 1));
+	PKT_end(pvar);
+	free(wire);
+
+	ok = !data_error && recv_data_count == total_data;
+	printf("%s\n", ok ? "OK" : "NG");
+	return ok ? 0 : 1;
+}
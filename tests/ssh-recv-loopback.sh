@@ -0,0 +1,96 @@
+#!/bin/sh
+# pkt.c の受信バッファのループバックテストをビルドして実行する
+#   usage: ssh-recv-loopback.sh [MB] [packet] [segment]
+#   pkt.c をそのままビルドし、ttxssh.h などは使う部分だけを定義したものを用意する
+#   PKT_C=<file> で別の pkt.c (変更前のものなど) を指定できる
+#     git show <commit>:ttssh2/ttxssh/pkt.c > /tmp/pkt-old.c
+#     PKT_C=/tmp/pkt-old.c sh ssh-recv-loopback.sh
+
+cd "$(dirname "$0")"
+CC=${CC:-cc}
+PKT_C=${PKT_C:-../ttssh2/ttxssh/pkt.c}
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+
+cat > "$tmp/windows.h" <<'EOT'
+#pragma once
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <wchar.h>
+typedef int BOOL;
+typedef int SOCKET;
+typedef void *HWND;
+typedef void *HFONT;
+#define TRUE 1
+#define FALSE 0
+#define PASCAL
+#define SOCKET_ERROR (-1)
+#define _TRUNCATE ((size_t)-1)
+#define _countof(a) (sizeof(a) / sizeof((a)[0]))
+#define _ASSERT(e) assert(e)
+#define strncpy_s(d, n, s, c) (snprintf((d), (n), "%s", (s)), 0)
+#define max(a, b) ((a) > (b) ? (a) : (b))
+#define FD_READ 1
+#define MAKELPARAM(l, h) 0
+#define PostMessage(h, m, w, l) 0
+/* 受信バッファ内で詰め直したバイト数を数える */
+void *CountMemmove(void *dest, const void *src, size_t n);
+#define memmove(d, s, n) CountMemmove((d), (s), (n))
+EOT
+
+cat > "$tmp/ttxssh.h" <<'EOT'
+#pragma once
+#include <windows.h>
+typedef struct _TInstVar *PTInstVar;
+#include "util.h"
+#include "pkt.h"
+#define CHAN_SES_WINDOW_DEFAULT (4*32*1024)
+#define MODE_IN 0
+#define SSH2_CIPHER_CHACHAPOLY 1
+#define WM_USER_COMMNOTIFY 0
+#define LOG_LEVEL_VERBOSE 100
+#define SSHv1(pvar) FALSE
+#define SSHv2(pvar) TRUE
+#define SSH_is_any_payload(pvar) ((pvar)->ssh_state.payload_datalen > 0)
+struct Mac { int etm; };
+struct Enc { int auth_len; };
+struct sshcipher { int id; };
+struct sshcipher_ctx { const struct sshcipher *cipher; void *cp_ctx; };
+typedef struct _TInstVar {
+	SOCKET socket;
+	HWND NotificationWindow;
+	int (PASCAL *Precv)(SOCKET s, char *buf, int len, int flags);
+	PKTState pkt_state;
+	struct {
+		unsigned char *payload;
+		int payload_datalen;
+		unsigned int receiver_sequence_number;
+	} ssh_state;
+	struct { struct Mac mac; struct Enc enc; } ssh2_keys[2];
+	struct sshcipher_ctx *cc[2];
+	BOOL fatal_error;
+	char UIMsg[256];
+} TInstVar;
+unsigned int SSH_get_min_packet_size(PTInstVar pvar);
+unsigned int SSH_get_authdata_size(PTInstVar pvar, int direction);
+BOOL SSH_handle_server_ID(PTInstVar pvar, char *ID, int ID_len);
+void SSH2_send_kexinit(PTInstVar pvar);
+void SSH_predecrypt_packet(PTInstVar pvar, char *data);
+void SSH1_handle_packet(PTInstVar pvar, char *data, unsigned int len, unsigned int padding);
+void SSH2_handle_packet(PTInstVar pvar, char *data, unsigned int len, unsigned int aadlen, unsigned int authlen);
+int SSH_extract_payload(PTInstVar pvar, unsigned char *dest, int len);
+int chachapoly_get_length(void *ctx, uint32 *plenp, unsigned int seqnr, const char *cp, unsigned int len);
+void notify_fatal_error(PTInstVar pvar, char *msg, BOOL send_disconnect);
+void logprintf(int level, const char *fmt, ...);
+EOT
+
+# ソースは CP932 なので UTF-8 に変換する
+for f in ../ttssh2/ttxssh/util.h ../ttssh2/ttxssh/pkt.h ssh-recv-loopback.c; do
+	iconv -f cp932 -t utf-8 $f | tr -d '\r' > "$tmp/$(basename $f)"
+done
+iconv -f cp932 -t utf-8 "$PKT_C" | tr -d '\r' > "$tmp/pkt.c"
+
+$CC -O2 -w -I"$tmp" -o "$tmp/ssh-recv-loopback" "$tmp/ssh-recv-loopback.c" "$tmp/pkt.c" &&
+"$tmp/ssh-recv-loopback" "$@"
@@ -0,0 +1,356 @@
+/*
+ * SSH2_MSG_CHANNEL_DATA M̃eXg
+ *
+ *   channel.c  SSH2_send_channel_data() gāA
+ *   MpPbg̒g (, TCY) mFāA
+ *   L[瑗蒼pPbg`N̋ڂŏȂȂƂmFāA
+ *   pPbg, packets/s, yC[h 1 oCg̃Rs[ʂ\
+ *   r̂߁AȑȌ (buffer_t ɋl߂ĂpPbgփRs[A
+ *   remote_window 𒴂Ƃ͊ۂƃL[ɓ) œ
+ *
+ *   T[o͎󂯎f[^ window ̔𒴂
+ *   SSH2_MSG_CHANNEL_WINDOW_ADJUST Ԃ̂ƂĈ
+ *
+ *   Linux/MinGW Ŏs
+ *     sh ssh2-channel.sh send [MB] [window] [maxpacket]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "ttxssh.h"
+#include "channel.h"
+
+/* ȑȌŎg */
+typedef struct {
+	char *buf;
+	unsigned int len, offset, maxlen;
+} buffer_t;
+
+size_t copied_bytes;
+unsigned long alloc_count;
+
+/* MpPbg̊mFp */
+static unsigned long packets;
+static unsigned long long payload_bytes;
+static unsigned long long check_pos;
+static unsigned int check_maxpacket;
+static unsigned int check_window;
+static unsigned int consumed;
+static Channel_t *check_ch;	/* L[瑗蒼ĂƂ */
+static int errors;
+static int verify;
+
+/* f[^ PATTERN_PERIOD oCg̃p^[ */
+#define PATTERN_PERIOD 4093
+
+static unsigned char Pattern(unsigned long long pos)
+{
+	unsigned int n = (unsigned int)(pos % PATTERN_PERIOD);
+	return (unsigned char)((n * 7) ^ (n >> 5));
+}
+
+void *counted_memcpy(void *dst, const void *src, size_t len)
+{
+	copied_bytes += len;
+	return (memcpy)(dst, src, len);
+}
+
+void *counted_malloc(size_t len)
+{
+	alloc_count++;
+	return (malloc)(len);
+}
+
+buffer_t *buffer_init(void)
+{
+	buffer_t *b = counted_malloc(sizeof(buffer_t));
+	b->buf = NULL;
+	b->len = b->offset = b->maxlen = 0;
+	return b;
+}
+
+void buffer_free(buffer_t *b)
+{
+	free(b->buf);
+	free(b);
+}
+
+static void buffer_reserve(buffer_t *b, unsigned int len)
+{
+	if (b->len + len > b->maxlen) {
+		b->maxlen = (b->len + len) * 2;
+		b->buf = realloc(b->buf, b->maxlen);
+		alloc_count++;
+	}
+}
+
+void buffer_put_raw(buffer_t *b, char *ptr, int size)
+{
+	buffer_reserve(b, size);
+	memcpy(b->buf + b->len, ptr, size);
+	b->len += size;
+}
+
+void buffer_put_int(buffer_t *b, int value)
+{
+	buffer_reserve(b, 4);
+	set_uint32(b->buf + b->len, value);
+	b->len += 4;
+}
+
+void buffer_put_string(buffer_t *b, char *ptr, int size)
+{
+	buffer_put_int(b, size);
+	buffer_put_raw(b, ptr, size);
+}
+
+int buffer_len(buffer_t *b) { return b->len; }
+char *buffer_ptr(buffer_t *b) { return b->buf; }
+
+/* ͂pPbgmF (T[o) */
+static void PacketSent(PTInstVar pvar, unsigned char *outbuf)
+{
+	unsigned int len = get_uint32(outbuf + 5);
+	unsigned int i;
+
+	(void)pvar;
+	packets++;
+	payload_bytes += len;
+	if (outbuf[0] != SSH2_MSG_CHANNEL_DATA || get_uint32(outbuf + 1) != 100) {
+		errors++;
+	}
+	if (len == 0 || len > check_maxpacket || len > check_window) {
+		if (errors++ < 10) {
+			printf("NG packet len %u (maxpacket %u window %u)\n", len, check_maxpacket, check_window);
+		}
+	}
+	if (check_ch != NULL) {
+		/* L[Ɏc肪΁Awindow  maxpacket ς܂ŋl߂đ */
+		unsigned int full = check_window < check_maxpacket ? check_window : check_maxpacket;
+		if (len < full && bytequeue_len(&check_ch->bufchain) > len) {
+			if (errors++ < 10) {
+				printf("NG short packet len %u (maxpacket %u window %u queued %lu)\n", len, check_maxpacket,
+					   check_window, (unsigned long)bytequeue_len(&check_ch->bufchain));
+			}
+		}
+	}
+	check_window -= len;
+	for (i = 0; verify && i < len; i++) {
+		if (outbuf[9 + i] != Pattern(check_pos + i)) {
+			if (errors++ < 10) {
+				printf("NG data at %llu\n", check_pos + i);
+			}
+			break;
+		}
+	}
+	check_pos += len;
+	consumed += len;
+}
+
+/* ȑȎȂf[^̃Xg */
+typedef struct bufchain {
+	buffer_t *msg;
+	struct bufchain *next;
+} bufchain_t;
+static bufchain_t *old_bufchain;
+
+/* ȑO ssh2_channel_add_bufchain() */
+static void old_add_bufchain(unsigned char *buf, unsigned int buflen)
+{
+	bufchain_t *p = malloc(sizeof(bufchain_t));
+	p->msg = buffer_init();
+	buffer_put_raw(p->msg, (char *)buf, buflen);
+	p->next = NULL;
+	if (old_bufchain == NULL) {
+		old_bufchain = p;
+	} else {
+		bufchain_t *old = old_bufchain;
+		while (old->next)
+			old = old->next;
+		old->next = p;
+	}
+}
+
+/* ȑO SSH2_send_channel_data() */
+static void old_send_channel_data(PTInstVar pvar, Channel_t *c, unsigned char *buf, unsigned int buflen, int retry)
+{
+	buffer_t *msg;
+	unsigned char *outmsg;
+	unsigned int len;
+	if (retry == 0 && old_bufchain) {
+		old_add_bufchain(buf, buflen);
+		return;
+	}
+	if (buflen > c->remote_window) {
+		old_add_bufchain(buf, buflen);
+		return;
+	}
+	if (buflen > 0) {
+		msg = buffer_init();
+		buffer_put_int(msg, c->remote_id);
+		buffer_put_string(msg, (char *)buf, buflen);
+		len = buffer_len(msg);
+		outmsg = begin_send_packet(pvar, SSH2_MSG_CHANNEL_DATA, len);
+		memcpy(outmsg, buffer_ptr(msg), len);
+		finish_send_packet(pvar);
+		buffer_free(msg);
+		c->remote_window -= buflen;
+	}
+}
+
+/* ȑO ssh2_channel_retry_send_bufchain() */
+static void old_retry_send_bufchain(PTInstVar pvar, Channel_t *c)
+{
+	while (old_bufchain) {
+		bufchain_t *ch = old_bufchain;
+		unsigned int size = buffer_len(ch->msg);
+		if (size >= c->remote_window)
+			break;
+		old_send_channel_data(pvar, c, buffer_ptr(ch->msg), size, TRUE);
+		old_bufchain = ch->next;
+		buffer_free(ch->msg);
+		free(ch);
+	}
+}
+
+/* ꂸɎcĂf[^邩 */
+static int Queued(int old, Channel_t *c)
+{
+	return old ? old_bufchain != NULL : bytequeue_len(&c->bufchain) > 0;
+}
+
+typedef struct {
+	const char *name;
+	unsigned int write_min;
+	unsigned int write_max;
+} Traffic;
+
+/*
+ * t ̏݃p^[ total oCg
+ * verify  0 ̂Ƃ͓͂f[^̓e𒲂ׂȂ (xvp)
+ */
+static void Run(const Traffic *t, int old, int verify_data, unsigned long long total,
+				unsigned int window, unsigned int maxpacket)
+{
+	TInstVar inst;
+	Channel_t ch;
+	unsigned char *src;
+	unsigned long long pos = 0;
+	unsigned int i;
+	clock_t start;
+	double sec;
+
+	memset(&inst, 0, sizeof(inst));
+	memset(&ch, 0, sizeof(ch));
+	ch.remote_id = 100;
+	ch.remote_window = window;
+	ch.remote_maxpacket = maxpacket;
+	check_window = window;
+	check_maxpacket = old ? 0xffffffff : maxpacket;
+	packets = 0;
+	payload_bytes = 0;
+	check_pos = 0;
+	consumed = 0;
+	copied_bytes = 0;
+	alloc_count = 0;
+	errors = 0;
+	verify = verify_data;
+	srand(1);
+
+	src = malloc(t->write_max + PATTERN_PERIOD);
+	for (i = 0; i < t->write_max + PATTERN_PERIOD; i++) {
+		src[i] = Pattern(i);
+	}
+	alloc_count = 0;
+	start = clock();
+	while (pos < total) {
+		unsigned int len = t->write_min + rand() % (t->write_max - t->write_min + 1);
+		unsigned char *p = src + pos % PATTERN_PERIOD;
+		if (len > total - pos) {
+			len = (unsigned int)(total - pos);
+		}
+		pos += len;
+		if (old) {
+			old_send_channel_data(&inst, &ch, p, len, 0);
+		} else {
+			SSH2_send_channel_data(&inst, &ch, p, len, 0);
+		}
+
+		/* T[o window ̔ WINDOW_ADJUST Ԃ */
+		while (consumed >= window / 2 || (pos >= total && Queued(old, &ch) && consumed > 0)) {
+			ch.remote_window += consumed;
+			check_window += consumed;
+			consumed = 0;
+			if (old) {
+				old_retry_send_bufchain(&inst, &ch);
+			} else {
+				check_ch = &ch;
+				ssh2_channel_retry_send_bufchain(&inst, &ch);
+				check_ch = NULL;
+			}
+		}
+		if (old && old_bufchain != NULL && consumed == 0 && ch.remote_window == window) {
+			/* 1 ݂̏ window 傫ƈȑȌł͑Ȃ */
+			if (!verify) {
+				printf("%-16s %-4s stalled: write larger than window\n", t->name, "old");
+			}
+			free(src);
+			while (old_bufchain) {
+				bufchain_t *next = old_bufchain->next;
+				buffer_free(old_bufchain->msg);
+				free(old_bufchain);
+				old_bufchain = next;
+			}
+			return;
+		}
+	}
+	sec = (double)(clock() - start) / CLOCKS_PER_SEC;
+	if (sec <= 0) {
+		sec = 1e-6;
+	}
+	free(src);
+
+	if (check_pos != total || Queued(old, &ch)) {
+		printf("NG %s: sent %llu / %llu\n", t->name, check_pos, total);
+		errors++;
+	}
+	if (errors != 0) {
+		exit(1);
+	}
+	if (verify) {
+		return;
+	}
+	printf("%-16s %-4s %8lu packets %10.0f packets/s %5.2f copy/byte %8lu allocs\n",
+		   t->name, old ? "old" : "new", packets, packets / sec,
+		   (double)copied_bytes / payload_bytes, alloc_count);
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned long long total = (unsigned long long)(argc > 1 ? atoi(argv[1]) : 64) * 1024 * 1024;
+	unsigned int window = argc > 2 ? atoi(argv[2]) : 2 * 1024 * 1024;
+	unsigned int maxpacket = argc > 3 ? atoi(argv[3]) : 32 * 1024;
+	static const Traffic traffic[] = {
+		{ "paste", 1, 512 },			/* L[, Nbv{[h̓\t */
+		{ "scp", 32 * 1024, 32 * 1024 },	/* SCP MXbh 32KB ǂ */
+		{ "port-forwarding", 1, 8192 },	/* fwd.c  CHANNEL_READ_BUF_SIZE */
+		{ "sftp/agent", 64 * 1024, 256 * 1024 },	/* maxpacket 𒴂鏑 */
+	};
+	size_t i;
+
+	packet_sent = PacketSent;
+	printf("%llu MB, window %u, maxpacket %u\n", total / 1024 / 1024, window, maxpacket);
+	for (i = 0; i < sizeof(traffic) / sizeof(traffic[0]); i++) {
+		Run(&traffic[i], 1, 1, total, window, maxpacket);
+		Run(&traffic[i], 0, 1, total, window, maxpacket);
+		/* window ăL[ɗ܂Ƃ (`N̑傫Ƃ炷) */
+		Run(&traffic[i], 0, 1, total / 16, 3 * maxpacket + 1000, maxpacket);
+		Run(&traffic[i], 1, 0, total, window, maxpacket);
+		Run(&traffic[i], 0, 0, total, window, maxpacket);
+	}
+	printf("OK\n");
+	return 0;
+}
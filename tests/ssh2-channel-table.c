@@ -0,0 +1,177 @@
+/*
+ * SSH2 `l\̃XgXeXg
+ *
+ *   channel.c  ssh2_channel_alloc(), ssh2_channel_release(), ssh2_channel_lookup(),
+ *   ssh2_local_channel_lookup() gA
+ *   SSH T[ȏ̏Ƒgݍ킹āA|[gtH[fBÕ`l
+ *   ʂɊJ肷
+ *
+ *   - JĂ`l self_id, local_num ̗ň邱
+ *   - `l͈Ȃ
+ *   - JĂ Channel_t ̃|C^ςȂ
+ *   mFȂ`T (ȑO ssh2_local_channel_lookup()) Ɣׂ
+ *
+ *   Linux/MinGW Ŏs
+ *     sh ssh2-channel.sh table [channels] [rounds]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "ttxssh.h"
+#include "channel.h"
+
+/* SSH T[ȏ: JĂ`lƂ̏ */
+typedef struct {
+	Channel_t *c;		/* ssh2_channel_new() Ԃ|C^ */
+	int self_id;
+	int local_num;		/* -1 ̂Ƃ̓VFȂ */
+	int remote_id;
+} Peer;
+
+static int errors;
+
+#define CHECK(cond) \
+	do { if (!(cond)) { if (errors++ < 10) printf("NG line %d: %s\n", __LINE__, #cond); } } while (0)
+
+/* ȑO ssh2_local_channel_lookup() Ɠ`T */
+static Channel_t *LinearLocalLookup(int local_num)
+{
+	int i;
+	Channel_t *c;
+	for (i = 0; (c = ssh2_channel_slot(i)) != NULL; i++) {
+		if (c->type != TYPE_PORTFWD)
+			continue;
+		if (c->local_num == local_num)
+			return c;
+	}
+	return NULL;
+}
+
+/* local_num  fwd.c Ɠ󂢂Ăԏԍg */
+static int AllocLocalNum(char *local_used, int max)
+{
+	int i;
+	for (i = 0; i < max; i++) {
+		if (!local_used[i]) {
+			local_used[i] = 1;
+			return i;
+		}
+	}
+	return -1;
+}
+
+static void Open(Peer *p, char *local_used, int max, int remote_id)
+{
+	if (rand() % 16 == 0) {
+		p->local_num = -1;
+		p->c = ssh2_channel_alloc(TYPE_SHELL, -1);
+	} else {
+		p->local_num = AllocLocalNum(local_used, max);
+		p->c = ssh2_channel_alloc(TYPE_PORTFWD, p->local_num);
+	}
+	CHECK(p->c != NULL);
+	if (p->c == NULL) {
+		exit(1);
+	}
+	/* SSH2_MSG_CHANNEL_OPEN_CONFIRMATION */
+	p->self_id = p->c->self_id;
+	p->remote_id = remote_id;
+	p->c->remote_id = remote_id;
+}
+
+static void Close(Peer *p, char *local_used)
+{
+	/* SSH2_MSG_CHANNEL_CLOSE */
+	Channel_t *c = ssh2_channel_lookup(p->self_id);
+	CHECK(c == p->c);
+	ssh2_channel_release(c);
+	CHECK(ssh2_channel_lookup(p->self_id) == NULL);
+	if (p->local_num >= 0) {
+		CHECK(ssh2_local_channel_lookup(p->local_num) == NULL);
+		local_used[p->local_num] = 0;
+	}
+	p->c = NULL;
+}
+
+int main(int argc, char *argv[])
+{
+	int num = argc > 1 ? atoi(argv[1]) : 10000;
+	int rounds = argc > 2 ? atoi(argv[2]) : 20;
+	Peer *peers = calloc(num, sizeof(Peer));
+	char *local_used = calloc(num, 1);
+	int remote_id = 0;
+	int round;
+	int i;
+	int allocated;
+	long lookups = 0;
+	clock_t t;
+	double table_sec;
+	double linear_sec;
+	unsigned long sum = 0;
+
+	srand(1);
+	for (round = 0; round < rounds; round++) {
+		/* SJāA΂΂̏ŔĊJAŌɑS */
+		for (i = 0; i < num; i++) {
+			Open(&peers[i], local_used, num, remote_id++);
+		}
+		for (i = 0; i < num; i++) {
+			int j = rand() % num;
+			Close(&peers[j], local_used);
+			Open(&peers[j], local_used, num, remote_id++);
+		}
+		for (i = 0; i < num * 4; i++) {
+			/* T[o SSH2_MSG_CHANNEL_DATA ƁA[J\Pbg̎M */
+			Peer *p = &peers[rand() % num];
+			Channel_t *c = ssh2_channel_lookup(p->self_id);
+			CHECK(c == p->c && c->self_id == p->self_id && c->remote_id == p->remote_id);
+			if (p->local_num >= 0) {
+				CHECK(ssh2_local_channel_lookup(p->local_num) == p->c);
+			}
+			lookups++;
+		}
+		for (i = num - 1; i >= 0; i--) {
+			Close(&peers[i], local_used);
+		}
+		if (errors != 0) {
+			break;
+		}
+	}
+	for (allocated = 0; ssh2_channel_slot(allocated) != NULL; allocated++) {
+	}
+	printf("%d rounds, %d channels, %d Channel_t allocated, %ld lookups\n",
+		   rounds, num, allocated, lookups);
+
+	/* ̑ */
+	for (i = 0; i < num; i++) {
+		Open(&peers[i], local_used, num, remote_id++);
+	}
+	t = clock();
+	for (i = 0; i < 1000000; i++) {
+		Channel_t *c = ssh2_local_channel_lookup(peers[(int)((i * 7919L) % num)].local_num);
+		sum += c != NULL ? c->self_id : 0;
+	}
+	table_sec = (double)(clock() - t) / CLOCKS_PER_SEC;
+	t = clock();
+	for (i = 0; i < 10000; i++) {
+		Channel_t *c = LinearLocalLookup(peers[(int)((i * 7919L) % num)].local_num);
+		sum -= c != NULL ? c->self_id : 0;
+	}
+	linear_sec = (double)(clock() - t) / CLOCKS_PER_SEC * 100;
+	printf("local lookup: table %.1f ns, linear %.1f ns (%lu)\n",
+		   table_sec * 1e9 / 1000000, linear_sec * 1e9 / 1000000, sum);
+
+	for (i = 0; i < num; i++) {
+		Close(&peers[i], local_used);
+	}
+	ssh2_channel_table_free();
+	CHECK(ssh2_channel_slot(0) == NULL && ssh2_channel_lookup(0) == NULL);
+	free(peers);
+	free(local_used);
+
+	printf("%s\n", errors == 0 ? "OK" : "NG");
+	return errors == 0 ? 0 : 1;
+}
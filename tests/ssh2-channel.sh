@@ -0,0 +1,164 @@
+#!/bin/sh
+# ttxssh/channel.c (SSH2 チャネル) のテストをビルドして実行する
+#   channel.c と bytequeue.c をそのままビルドし、ttxssh.h などは
+#   使う部分だけを定義したものを用意する
+#   usage: ssh2-channel.sh [send [MB] [window] [maxpacket]]
+#                          [table [channels] [rounds]]
+#                          [window [MB] [rtt ms] [bandwidth KB/ms] [MaxWindowSize]]
+#   テスト名を省略すると、すべてのテストを既定値で実行する
+
+cd "$(dirname "$0")"
+CC=${CC:-cc}
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+
+cat > "$tmp/ttxssh.h" <<'EOT'
+#pragma once
+#include <stddef.h>
+#include <string.h>
+typedef int BOOL;
+typedef unsigned int DWORD;
+#define TRUE 1
+#define FALSE 0
+#define max(a, b) ((a) > (b) ? (a) : (b))
+extern DWORD now_tick;
+#define GetTickCount() now_tick
+#define LOG_LEVEL_ERROR 10
+#define LOG_LEVEL_VERBOSE 50
+#define LOG_LEVEL_SSHDUMP 100
+#define logprintf(level, ...) ((void)0)
+#define logputs(level, msg) ((void)0)
+#define KEX_FLAG_REKEYING 0x02
+#define SSH2_MSG_CHANNEL_WINDOW_ADJUST 93
+#define SSH2_MSG_CHANNEL_DATA 94
+#define CHAN_SES_PACKET_DEFAULT (32*1024)
+#define CHAN_SES_WINDOW_DEFAULT (4*CHAN_SES_PACKET_DEFAULT)
+#define set_uint32(p, v) ((p)[0] = (unsigned char)((v) >> 24), (p)[1] = (unsigned char)((v) >> 16), \
+	(p)[2] = (unsigned char)((v) >> 8), (p)[3] = (unsigned char)(v))
+#define get_uint32(p) (((unsigned int)(p)[0] << 24) | ((p)[1] << 16) | ((p)[2] << 8) | (p)[3])
+#include "bytequeue.h"
+enum channel_type {
+	TYPE_SHELL, TYPE_PORTFWD, TYPE_SCP, TYPE_SFTP, TYPE_AGENT, TYPE_SUBSYSTEM_GEN,
+};
+typedef struct channel {
+	int used;
+	int self_id;
+	int remote_id;
+	unsigned int local_window;
+	unsigned int local_window_max;
+	unsigned int local_maxpacket;
+	unsigned int remote_window;
+	unsigned int remote_maxpacket;
+	enum channel_type type;
+	int local_num;
+	bytequeue_t bufchain;
+	BOOL bufchain_recv_suspended;
+	unsigned long long local_granted;
+	DWORD rtt;
+	DWORD rtt_tick;
+	BOOL rtt_measuring;
+	unsigned long long rtt_mark;
+	DWORD rate_tick;
+	unsigned long long rate_bytes;
+} Channel_t;
+typedef struct {
+	int kex_status;
+	struct {
+		int MaxWindowSize;
+	} settings;
+} TInstVar, *PTInstVar;
+unsigned char *begin_send_packet(PTInstVar pvar, int type, int len);
+void finish_send_packet(PTInstVar pvar);
+void FWD_suspend_resume_local_connection(PTInstVar pvar, Channel_t *c, int notify);
+void SSH2_send_channel_data(PTInstVar pvar, Channel_t *c, unsigned char *buf, unsigned int buflen, int retry);
+Channel_t *ssh2_local_channel_lookup(int local_num);
+/* テスト側で送信パケットを受け取る (pkt[0] はメッセージ番号) */
+extern void (*packet_sent)(PTInstVar pvar, unsigned char *pkt);
+EOT
+
+# ssh.c と fwd.c の代わり
+cat > "$tmp/stub.c" <<'EOT'
+#include <stdlib.h>
+#include "ttxssh.h"
+void (*packet_sent)(PTInstVar pvar, unsigned char *pkt);
+DWORD now_tick;
+static unsigned char *packet;
+static int packet_len;
+unsigned char *begin_send_packet(PTInstVar pvar, int type, int len)
+{
+	(void)pvar;
+	if (len + 1 > packet_len) {
+		packet_len = len + 1;
+		packet = realloc(packet, packet_len);
+	}
+	packet[0] = (unsigned char)type;
+	return packet + 1;
+}
+void finish_send_packet(PTInstVar pvar)
+{
+	if (packet_sent != NULL) {
+		packet_sent(pvar, packet);
+	}
+}
+void FWD_suspend_resume_local_connection(PTInstVar pvar, Channel_t *c, int notify)
+{
+	(void)pvar;
+	(void)c;
+	(void)notify;
+}
+EOT
+
+# コピー量とメモリ確保の回数を数える (send)
+cat > "$tmp/count.h" <<'EOT'
+#pragma once
+#include <stdlib.h>
+#include <string.h>
+void *counted_memcpy(void *dst, const void *src, size_t len);
+void *counted_malloc(size_t len);
+#define memcpy(d, s, n) counted_memcpy((d), (s), (n))
+#define malloc(n) counted_malloc(n)
+EOT
+
+# ソースは CP932 なので UTF-8 に変換する
+for f in ../ttssh2/ttxssh/channel.c ../ttssh2/ttxssh/channel.h \
+		../ttssh2/ttxssh/bytequeue.c ../ttssh2/ttxssh/bytequeue.h \
+		ssh2-channel-send.c ssh2-channel-table.c ssh2-window-autotune.c; do
+	iconv -f cp932 -t utf-8 $f | tr -d '\r' > "$tmp/$(basename $f)"
+done
+
+build() {
+	name=$1
+	shift
+	$CC -O2 -w -I"$tmp" "$@" -o "$tmp/$name" "$tmp/$name.c" \
+		"$tmp/channel.c" "$tmp/bytequeue.c" "$tmp/stub.c"
+}
+
+run() {
+	test=$1
+	[ $# -gt 0 ] && shift
+	case "$test" in
+	send)
+		build ssh2-channel-send -include "$tmp/count.h" && "$tmp/ssh2-channel-send" "$@"
+		;;
+	table)
+		build ssh2-channel-table && "$tmp/ssh2-channel-table" "$@"
+		;;
+	window)
+		build ssh2-window-autotune && "$tmp/ssh2-window-autotune" "$@"
+		;;
+	*)
+		echo "usage: $0 [send [MB] [window] [maxpacket]]"
+		echo "       $0 [table [channels] [rounds]]"
+		echo "       $0 [window [MB] [rtt ms] [bandwidth KB/ms] [MaxWindowSize]]"
+		return 1
+		;;
+	esac
+}
+
+if [ $# -eq 0 ]; then
+	for test in send table window; do
+		run $test || exit 1
+	done
+else
+	run "$@"
+fi
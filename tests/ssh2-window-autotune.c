@@ -0,0 +1,139 @@
+/*
+ * SSH2 MEBhE̎̃eXg
+ *
+ *   channel.c  do_SSH2_adjust_window_size() A
+ *   x̂ʐMH̐ɂT[o (window ̕Ă) 
+ *   gݍ킹āA]x window ̑傫\
+ *
+ *   ʐMH 1 ms  bandwidth KB āAГ latency ms ɓ͂
+ *   MaxWindowSize=0 (Ȃ) ƎwlŔׂ
+ *
+ *   Linux/MinGW Ŏs
+ *     sh ssh2-channel.sh window [MB] [rtt ms] [bandwidth KB/ms] [MaxWindowSize]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ttxssh.h"
+#include "channel.h"
+
+/* ʐMH (T[o -> NCAg ̃f[^ƁANCAg -> T[o WINDOW_ADJUST) */
+#define LINK_MAX 200000
+typedef struct {
+	DWORD arrive;
+	unsigned int len;
+} Segment;
+static Segment data_link[LINK_MAX];
+static int data_head, data_tail;
+static Segment adjust_link[LINK_MAX];
+static int adjust_head, adjust_tail;
+static unsigned int one_way;
+static unsigned long adjusts;
+
+static void PacketSent(PTInstVar pvar, unsigned char *outbuf)
+{
+	(void)pvar;
+	if (outbuf[0] != SSH2_MSG_CHANNEL_WINDOW_ADJUST) {
+		printf("NG packet type %d\n", outbuf[0]);
+		exit(1);
+	}
+	adjust_link[adjust_tail].arrive = now_tick + one_way;
+	adjust_link[adjust_tail].len = get_uint32(outbuf + 5);
+	adjust_tail = (adjust_tail + 1) % LINK_MAX;
+	adjusts++;
+}
+
+static void Run(unsigned long long total, unsigned int rtt, unsigned int bandwidth, int max_window)
+{
+	TInstVar inst;
+	Channel_t ch;
+	unsigned long long sent = 0;
+	unsigned long long received = 0;
+	unsigned int remote_window;
+	unsigned int window_max_seen;
+
+	memset(&inst, 0, sizeof(inst));
+	memset(&ch, 0, sizeof(ch));
+	inst.settings.MaxWindowSize = max_window;
+	one_way = rtt / 2;
+	data_head = data_tail = adjust_head = adjust_tail = 0;
+	adjusts = 0;
+	now_tick = 1000;
+
+	/* ssh2_channel_new()  SSH2_MSG_CHANNEL_OPEN_CONFIRMATION ̎M */
+	ch.local_window = ch.local_window_max = CHAN_SES_WINDOW_DEFAULT;
+	ch.local_maxpacket = CHAN_SES_PACKET_DEFAULT;
+	ch.local_granted = ch.local_window;
+	ch.rtt_tick = ch.rate_tick = now_tick;
+	now_tick += rtt;
+	ch.rtt = rtt;
+	remote_window = ch.local_window;
+	window_max_seen = ch.local_window_max;
+
+	while (received < total) {
+		unsigned int budget = bandwidth * 1024;
+
+		/* T[o: ͂ WINDOW_ADJUST 𔽉fāAwindow Ƒш̕ */
+		while (adjust_head != adjust_tail && adjust_link[adjust_head].arrive <= now_tick) {
+			remote_window += adjust_link[adjust_head].len;
+			adjust_head = (adjust_head + 1) % LINK_MAX;
+		}
+		while (budget > 0 && remote_window > 0 && sent < total) {
+			unsigned int len = CHAN_SES_PACKET_DEFAULT;
+			if (len > remote_window) len = remote_window;
+			if (len > budget) len = budget;
+			if (len > total - sent) len = (unsigned int)(total - sent);
+			data_link[data_tail].arrive = now_tick + one_way;
+			data_link[data_tail].len = len;
+			data_tail = (data_tail + 1) % LINK_MAX;
+			remote_window -= len;
+			budget -= len;
+			sent += len;
+		}
+
+		/* NCAg: handle_SSH2_channel_data() Ɠ */
+		while (data_head != data_tail && data_link[data_head].arrive <= now_tick) {
+			unsigned int len = data_link[data_head].len;
+			data_head = (data_head + 1) % LINK_MAX;
+			if (len > ch.local_window) {
+				printf("NG data larger than local_window\n");
+				exit(1);
+			}
+			ch.local_window -= len;
+			received += len;
+			do_SSH2_adjust_window_size(&inst, &ch);
+			if (ch.local_window_max > window_max_seen) {
+				window_max_seen = ch.local_window_max;
+			}
+		}
+		now_tick++;
+	}
+	if (window_max_seen > (unsigned int)max_window && window_max_seen > CHAN_SES_WINDOW_DEFAULT) {
+		printf("NG window %u exceeds MaxWindowSize %d\n", window_max_seen, max_window);
+		exit(1);
+	}
+
+	{
+		double sec = (now_tick - 1000 - rtt) / 1000.0;
+		printf("MaxWindowSize %9d: %8.2f MB/s (link %.0f MB/s), window %6u KB, rtt %u ms, %lu WINDOW_ADJUST\n",
+			   max_window, total / sec / 1024 / 1024, bandwidth * 1000.0 / 1024,
+			   window_max_seen / 1024, ch.rtt, adjusts);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned long long total = (unsigned long long)(argc > 1 ? atoi(argv[1]) : 256) * 1024 * 1024;
+	unsigned int rtt = argc > 2 ? atoi(argv[2]) : 180;
+	unsigned int bandwidth = argc > 3 ? atoi(argv[3]) : 12;	/*  100Mbps */
+	int max_window = argc > 4 ? atoi(argv[4]) : 16 * 1024 * 1024;
+
+	packet_sent = PacketSent;
+	printf("%llu MB, rtt %u ms\n", total / 1024 / 1024, rtt);
+	Run(total, rtt, bandwidth, 0);
+	Run(total, rtt, bandwidth, max_window);
+	printf("OK\n");
+	return 0;
+}
@@ -0,0 +1,307 @@
+/*
+ * ttmparse.cpp ̎̒ԃR[h (GetExpression() ̃LbV) ̃eXg
+ *
+ *   _ȎAs
+ *     - LbVȂ (\͂Ȃ])
+ *     - LbV (1ڂɕϊԃR[hs)
+ *   ŕ]āA߂lElE^EG[ELinePtrELineParsePtr ɂȂ
+ *   ƂmFBԃR[hsƂ͕ϐ̒lςāA0 Z
+ *   Y͈̔͊OȂǂ̃G[ׂB
+ *
+ *   Linux/MinGW Ŏs
+ *     sh ttl-expr-compile.sh []
+ */
+
+#include <time.h>
+#include "ttmparse.cpp"
+
+static int LineKeyStart;
+
+static BOOL GetLineKey(int *Level, BINT *Start)
+{
+	*Level = 0;
+	*Start = LineKeyStart;
+	return TRUE;
+}
+
+typedef struct {
+	BOOL Result;
+	WORD Err;
+	TVariableType ValType;
+	int Val;
+	WORD Ptr;
+	WORD ParsePtr;
+	int Commenting;
+} TEval;
+
+static void Eval(TEval *e)
+{
+	LinePtr = 0;
+	LineParsePtr = 0;
+	commenting = 0;
+	e->ValType = TypUnknown;
+	e->Val = 0;
+	e->Err = 0;
+	e->Result = GetExpression(&e->ValType, &e->Val, &e->Err);
+	e->Ptr = LinePtr;
+	e->ParsePtr = LineParsePtr;
+	e->Commenting = commenting;
+}
+
+static BOOL SameEval(const TEval *a, const TEval *b)
+{
+	if (a->Result != b->Result || a->Err != b->Err || a->Ptr != b->Ptr ||
+	    a->ParsePtr != b->ParsePtr || a->Commenting != b->Commenting) {
+		return FALSE;
+	}
+	if (a->Result && a->Err == 0) {
+		if (a->ValType != b->ValType) {
+			return FALSE;
+		}
+		if (a->ValType == TypInteger && a->Val != b->Val) {
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+static char Line[MaxLineLen];
+static size_t LinePos;
+
+static void Put(const char *s)
+{
+	size_t len = strlen(s);
+	if (LinePos + len < sizeof(Line) - 1) {
+		memcpy(Line + LinePos, s, len);
+		LinePos += len;
+		Line[LinePos] = 0;
+	}
+}
+
+static void PutSpace(void)
+{
+	static const char *sp[] = { "", "", " ", "\t", " /* c */ " };
+	Put(sp[rand() % 5]);
+}
+
+static void PutExpr(int depth);
+
+static void PutFactor(int depth)
+{
+	static const char *vars[] = { "a", "b", "c", "B", "zero" };
+	static const char *unary[] = { "-", "+", "~", "!", "not " };
+	char buf[32];
+
+	switch (depth > 4 ? rand() % 3 : rand() % 8) {
+		case 0:
+			snprintf(buf, sizeof(buf), "%d", rand() % 40);
+			Put(buf);
+			break;
+		case 1:
+			snprintf(buf, sizeof(buf), "$%x", rand() % 0x1000);
+			Put(buf);
+			break;
+		case 2:
+			Put(vars[rand() % 5]);
+			break;
+		case 3:
+		case 4:
+			Put("arr");
+			PutSpace();
+			Put("[");
+			PutExpr(depth + 1);
+			Put("]");
+			break;
+		case 5:
+			Put(unary[rand() % 5]);
+			PutFactor(depth + 1);
+			break;
+		case 6:
+			Put("(");
+			PutExpr(depth + 1);
+			Put(")");
+			break;
+		default:
+			// ϊȂl (Ez񂻂̂́Ex)
+			switch (rand() % 8) {
+				case 0: Put("s"); break;
+				case 1: Put("arr"); break;
+				case 2: Put("lab"); break;
+				default: Put("c"); break;
+			}
+			break;
+	}
+}
+
+static void PutExpr(int depth)
+{
+	static const char *ops[] = {
+		"*", "/", "%", "+", "-", ">>", "<<", ">>>", "&", "and", "^", "xor",
+		"|", "or", "<", ">", "<=", ">=", "=", "==", "<>", "!=", "&&", "||",
+	};
+	int n = (depth > 4) ? 0 : rand() % 4;
+
+	PutSpace();
+	PutFactor(depth);
+	while (n-- > 0) {
+		const char *op = ops[rand() % (sizeof(ops) / sizeof(ops[0]))];
+		PutSpace();
+		Put(op);
+		if (isalpha((unsigned char)op[0])) {
+			Put(" ");
+		}
+		PutSpace();
+		PutFactor(depth);
+	}
+	PutSpace();
+}
+
+static const char *Names[] = { "a", "b", "c", "zero" };
+
+static void SetVars(BOOL may_fail)
+{
+	TVariableType type;
+	TVarId id;
+	WORD Err;
+	int i;
+
+	for (i = 0; i < 4; i++) {
+		int v = may_fail ? rand() % 7 - 2 : rand() % 5 + 1;
+		if (rand() % 10 == 0) {
+			v = (rand() % 2) ? INT_MAX / 3 : 33;
+		}
+		CheckVar(Names[i], &type, &id);
+		SetIntVal(id, (i == 3 && may_fail) ? 0 : v);
+	}
+	CheckVar("arr", &type, &id);
+	for (i = 0; i < 4; i++) {
+		Err = 0;
+		SetIntValInArray(id, i, may_fail ? rand() % 8 - 2 : rand() % 4, &Err);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	static const char *tails[] = { "", " then", ", 1", " 5", ")", "]", " ; comment", " 'str'" };
+	int count = (argc > 1) ? atoi(argv[1]) : 100000;
+	int compiled = 0;
+	int ng = 0;
+	int i;
+
+	srand(1);
+	InitVar();
+	NewIntVar("a", 0);
+	NewIntVar("b", 0);
+	NewIntVar("c", 0);
+	NewIntVar("zero", 0);
+	NewStrVar("s", "str");
+	NewIntAryVar("arr", 4);
+	NewLabVar("lab", 0, 0);
+
+	for (i = 0; i < count; i++) {
+		TEval first, cached, plain;
+		TParseCache *c;
+
+		LinePos = 0;
+		Line[0] = 0;
+		PutExpr(0);
+		Put(tails[rand() % 8]);
+		strcpy(LineBuff, Line);
+		LineLen = (WORD)strlen(LineBuff);
+		LineKeyStart = i;
+
+		// 1 (LbVɊo)
+		SetVars(FALSE);
+		ClearParseCache();
+		Eval(&first);
+		c = ParseCacheFind(CacheExpr, 0, FALSE);
+		if (c != NULL && c->Code != NULL) {
+			compiled++;
+		}
+
+		// lς 2 (ԃR[hs)
+		SetVars(TRUE);
+		Eval(&cached);
+
+		// lŃLbVȂ
+		ClearParseCache();
+		Eval(&plain);
+
+		if (! SameEval(&cached, &plain)) {
+			printf("NG [%s]\n", Line);
+			printf("  cache: result=%d err=%d type=%d val=%d ptr=%d parseptr=%d\n",
+			       cached.Result, cached.Err, cached.ValType, cached.Val, cached.Ptr, cached.ParsePtr);
+			printf("  plain: result=%d err=%d type=%d val=%d ptr=%d parseptr=%d\n",
+			       plain.Result, plain.Err, plain.ValType, plain.Val, plain.Ptr, plain.ParsePtr);
+			if (++ng >= 10) {
+				break;
+			}
+		}
+	}
+
+	// R}h̃LbV (1ڂŊo 2ڈȍ~Ŏg)
+	ClearParseCache();
+	for (i = 0; i < 36; i++) {
+		static const char *words[] = {
+			"for i 1 10", "  While a", "\tendwhile", "/* c */ if a then", "foo = 1",
+			"sendln 'x'", "ifx", "", "; comment", "  ", "arr[1] = 2", "not",
+		};
+		WORD WId1, WId2, P1, P2;
+		BOOL r1, r2;
+
+		strcpy(LineBuff, words[i % 12]);
+		LineLen = (WORD)strlen(LineBuff);
+		LineKeyStart = i % 12;
+		commenting = 0;
+		LinePtr = 0;
+		WId1 = 0;
+		r1 = GetReservedWord(&WId1);
+		P1 = LinePtr;
+		commenting = 0;
+		LinePtr = 0;
+		WId2 = 0;
+		r2 = GetCommandWord(&WId2);
+		P2 = LinePtr;
+		if (r1 != r2 || P1 != P2 || (r1 && WId1 != WId2)) {
+			printf("NG command word [%s]\n", LineBuff);
+			ng++;
+		}
+	}
+
+	if (ng > 0) {
+		EndVar();
+		return 1;
+	}
+	printf("OK %d expressions, %d compiled\n", count, compiled);
+
+	// x ([vł悭gJԂ])
+	{
+		static const char *exprs[] = { "b + a * 3 % 7", "a % 3 = 0", "arr[a % 4] < c && b <> 0" };
+		TEval e;
+		int j, k;
+
+		SetVars(FALSE);
+		for (j = 0; j < 3; j++) {
+			double t[2];
+			strcpy(LineBuff, exprs[j]);
+			LineLen = (WORD)strlen(LineBuff);
+			LineKeyStart = -1;
+			ClearParseCache();
+			for (k = 0; k < 2; k++) {
+				clock_t start = clock();
+				int n;
+				// k=0: \͂Ȃ] (ExprNest>0 ł̓LbVȂ)
+				ExprNest = (k == 0) ? 1 : 0;
+				for (n = 0; n < 1000000; n++) {
+					Eval(&e);
+				}
+				t[k] = (double)(clock() - start) / CLOCKS_PER_SEC;
+			}
+			ExprNest = 0;
+			printf("  %-28s parse %6.0f ns, cached %6.0f ns\n", exprs[j], t[0] * 1000, t[1] * 1000);
+		}
+	}
+
+	EndVar();
+	return 0;
+}
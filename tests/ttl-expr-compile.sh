@@ -0,0 +1,53 @@
+#!/bin/sh
+# ttmparse.cpp の式の中間コードのテストをビルドして実行する
+#   ttmparse.cpp を、使う型と関数だけを定義したヘッダと合わせてビルドする
+#   usage: ttl-expr-compile.sh [回数]
+
+cd "$(dirname "$0")"
+CXX=${CXX:-c++}
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+
+cat > "$tmp/teraterm.h" <<'EOT'
+#pragma once
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <limits.h>
+typedef int BOOL;
+typedef unsigned char BYTE;
+typedef unsigned short WORD;
+typedef WORD *LPWORD;
+typedef unsigned int DWORD;
+typedef char *PCHAR;
+typedef int LONG;
+#define TRUE 1
+#define FALSE 0
+#define IDOK 1
+#define _TRUNCATE ((size_t)-1)
+#define _stricmp strcasecmp
+#define _strdup strdup
+#define __iscsymf(c) (isalpha(c) || (c) == '_')
+#define __iscsym(c) (isalnum(c) || (c) == '_')
+#define _countof(a) (sizeof(a) / sizeof((a)[0]))
+#define strncpy_s(d, n, s, c) snprintf(d, n, "%s", s)
+#define _snprintf_s(d, n, c, ...) snprintf(d, n, __VA_ARGS__)
+EOT
+: > "$tmp/crtdbg.h"
+cat > "$tmp/ttmdlg.h" <<'EOT'
+static int OpenErrDlg(const char *, const char *, int, int, int, const char *) { return 0; }
+EOT
+cat > "$tmp/ttmbuff.h" <<'EOT'
+static int GetLineNo(void) { return 1; }
+static const char *GetMacroFileName(void) { return "test.ttl"; }
+static BOOL GetLineKey(int *Level, BINT *Start);
+EOT
+for f in ttmdef.h ttmparse.h ttmparse.cpp; do
+	iconv -f cp932 -t utf-8 ../teraterm/ttpmacro/$f | tr -d '\r' > "$tmp/$f"
+done
+
+iconv -f cp932 -t utf-8 ttl-expr-compile.cpp | tr -d '\r' > "$tmp/ttl-expr-compile.cpp"
+$CXX -O2 -w -I"$tmp" -o "$tmp/ttl-expr-compile" "$tmp/ttl-expr-compile.cpp" &&
+"$tmp/ttl-expr-compile" "$@"
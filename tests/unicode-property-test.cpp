@@ -0,0 +1,176 @@
+/*
+ * unicode.cpp  Unicode e[ũeXg
+ *
+ *   - SR[h|Cg (U+0000-U+10FFFF) ɂāÃe[u
+ *     (unicode_asian_width.tbl Ȃ) ƌʂׂ
+ *   - 1 R[h|Cg̎ԂAȑO̓񕪒TƔׂ
+ *
+ *   Linux/MinGW Ŏs
+ *     sh unicode-property-test.sh
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "unicode.h"
+
+#define Mn 1
+#define Mc 2
+#define Me 1
+#define Sk 1
+
+typedef struct {
+	unsigned long code_from;
+	unsigned long code_to;
+	char property;
+} WidthTable_t;
+
+typedef struct {
+	unsigned long code_from;
+	unsigned long code_to;
+	unsigned char category;
+} CombineTable_t;
+
+typedef struct {
+	unsigned long code_from;
+	unsigned long code_to;
+} SimpleTable_t;
+
+static const WidthTable_t WidthList[] = {
+#include "unicode_asian_width.tbl"
+};
+
+static const CombineTable_t CombineList[] = {
+#include "unicode_combine.tbl"
+};
+
+static const SimpleTable_t EmojiList[] = {
+#include "unicode_emoji.tbl"
+};
+
+static const SimpleTable_t ViramaList[] = {
+#include "unicode_virama.tbl"
+};
+
+#define COUNTOF(a) (sizeof(a) / sizeof((a)[0]))
+
+/* ̃e[u̓񕪒T (ȑO unicode.cpp Ɠ) */
+template <typename T>
+static int Search(const T *table, size_t table_size, unsigned long u32)
+{
+	if (u32 < table[0].code_from || u32 > table[table_size - 1].code_to) {
+		return -1;
+	}
+	size_t low = 0;
+	size_t high = table_size - 1;
+	while (low <= high) {
+		size_t mid = (low + high) / 2;
+		if (table[mid].code_from <= u32 && u32 <= table[mid].code_to) {
+			return (int)mid;
+		} else if (table[mid].code_to < u32) {
+			low = mid + 1;
+		} else {
+			high = mid - 1;
+		}
+	}
+	return -1;
+}
+
+static char RefWidth(unsigned long u32)
+{
+	int i = Search(WidthList, COUNTOF(WidthList), u32);
+	return i == -1 ? 'H' : WidthList[i].property;
+}
+
+static int RefCombine(unsigned long u32)
+{
+	int i = Search(CombineList, COUNTOF(CombineList), u32);
+	return i == -1 ? 0 : CombineList[i].category;
+}
+
+static int RefEmoji(unsigned long u32)
+{
+	return Search(EmojiList, COUNTOF(EmojiList), u32) != -1 ? 1 : 0;
+}
+
+static int RefVirama(unsigned long u32)
+{
+	return Search(ViramaList, COUNTOF(ViramaList), u32) != -1 ? 1 : 0;
+}
+
+static double Now(void)
+{
+	return (double)clock() / CLOCKS_PER_SEC;
+}
+
+int main(void)
+{
+	const unsigned long code_max = 0x110000;
+	int errors = 0;
+	unsigned long u32;
+	unsigned long sum;
+	double t;
+	int loop;
+	const int loops = 20;
+
+	for (u32 = 0; u32 < code_max + 0x100; u32++) {
+		unsigned char prop = UnicodeGetProperty(u32);
+		char w = RefWidth(u32);
+		int c = RefCombine(u32);
+		int e = RefEmoji(u32);
+		int v = RefVirama(u32);
+		if (UnicodeGetWidthProperty(u32) != w ||
+			UnicodeWidthPropertyFromProperty(prop) != w ||
+			UnicodeIsCombiningCharacter(u32) != c ||
+			UnicodeIsEmoji(u32) != e ||
+			UnicodeIsVirama(u32) != v ||
+			((prop & UNICODE_PROP_EMOJI) != 0) != e ||
+			((prop & UNICODE_PROP_VIRAMA) != 0) != v) {
+			if (errors < 10) {
+				printf("NG U+%06lx width %c/%c combine %d/%d emoji %d/%d virama %d/%d\n",
+					   u32, UnicodeGetWidthProperty(u32), w,
+					   UnicodeIsCombiningCharacter(u32), c,
+					   UnicodeIsEmoji(u32), e, UnicodeIsVirama(u32), v);
+			}
+			errors++;
+		}
+	}
+
+	/* x (1Ƃɕ, G, , B[}𒲂ׂ) */
+	sum = 0;
+	t = Now();
+	for (loop = 0; loop < loops; loop++) {
+		for (u32 = 0; u32 < code_max; u32 += 7) {
+			sum += RefWidth(u32) + RefEmoji(u32) + RefCombine(u32) + RefVirama(u32);
+		}
+	}
+	t = Now() - t;
+	printf("binary search  %6.2f ns/code (%lu)\n", t * 1e9 / (loops * (code_max / 7)), sum);
+
+	sum = 0;
+	t = Now();
+	for (loop = 0; loop < loops; loop++) {
+		for (u32 = 0; u32 < code_max; u32 += 7) {
+			unsigned char prop = UnicodeGetProperty(u32);
+			sum += UnicodeWidthPropertyFromProperty(prop) + ((prop & UNICODE_PROP_EMOJI) != 0) +
+				((prop & UNICODE_PROP_COMBINE_MASK) >> UNICODE_PROP_COMBINE_SHIFT) +
+				((prop & UNICODE_PROP_VIRAMA) != 0);
+		}
+	}
+	t = Now() - t;
+	printf("property table %6.2f ns/code (%lu)\n", t * 1e9 / (loops * (code_max / 7)), sum);
+
+	sum = 0;
+	t = Now();
+	for (loop = 0; loop < loops * 100; loop++) {
+		for (u32 = 0x20; u32 < 0x7f; u32++) {
+			sum += UnicodeGetProperty(u32);
+		}
+	}
+	t = Now() - t;
+	printf("ASCII          %6.2f ns/code (%lu)\n", t * 1e9 / (loops * 100 * 0x5f), sum);
+
+	printf("%s\n", errors == 0 ? "OK" : "NG");
+	return errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,12 @@
+#!/bin/sh
+# unicode.cpp の Unicode 特性テーブルのテストをビルドして実行する
+#   usage: unicode-property-test.sh
+
+cd "$(dirname "$0")"
+CXX=${CXX:-c++}
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+
+$CXX -O2 -w '-D_countof(a)=(sizeof(a)/sizeof((a)[0]))' -I../teraterm/teraterm \
+	-o "$tmp/unicode-property-test" unicode-property-test.cpp ../teraterm/teraterm/unicode.cpp &&
+"$tmp/unicode-property-test"
@@ -0,0 +1,129 @@
+/*
+ * ttmparse.cpp ̕ϐ\̃eXg
+ *
+ *   - ϐ(65535)܂ōAȏ͍Ȃ
+ *   - O(啶ʂȂ)ϐ邱
+ *   - Yő̔zϐ̗vfǂݏł邱
+ *   - x폜Ăc̕ϐ邱
+ *   mFA쐬ƎQƂ̎Ԃ\
+ *
+ *   Linux/MinGW Ŏs
+ *     sh variable-table.sh
+ */
+
+#include <time.h>
+#include "ttmparse.cpp"
+
+static BOOL GetLineKey(int *Level, BINT *Start)
+{
+	(void)Level;
+	(void)Start;
+	return FALSE;
+}
+
+static int ng;
+
+static void Check(BOOL ok, const char *msg, int i)
+{
+	if (! ok) {
+		printf("NG %s (%d)\n", msg, i);
+		ng++;
+	}
+}
+
+// i Ԗڂ̕ϐ̖OA31̓x(lXgx1)ɂ
+static void VarName(char *name, size_t len, int i, BOOL upper)
+{
+	snprintf(name, len, upper ? "VAR_%d" : "var_%d", i);
+}
+
+static BOOL IsLabel(int i)
+{
+	return (i % 3) == 2;
+}
+
+int main()
+{
+	char name[MaxNameLen];
+	TVariableType type;
+	TVarId id, elem;
+	WORD Err;
+	clock_t start, mid, end;
+	int i, n;
+
+	InitVar();
+
+	// 1O܂ō
+	start = clock();
+	n = MaxVariableCount - 1;
+	for (i = 0; i < n; i++) {
+		VarName(name, sizeof(name), i, FALSE);
+		if (IsLabel(i))
+			Check(NewLabVar(name, (BINT)i, 1), "NewLabVar", i);
+		else
+			Check(NewIntVar(name, i), "NewIntVar", i);
+	}
+	// Ō1͔zϐ (Y 0xfffe)
+	Check(NewIntAryVar("ary", 4) == 0, "NewIntAryVar", n);
+	mid = clock();
+
+	// 𒴂ƍȂ
+	Check(! NewIntVar("over", 0), "NewIntVar over the limit", 0);
+	Check(! NewStrVar("over", ""), "NewStrVar over the limit", 0);
+	Check(NewIntAryVar("over", 1) == ErrTooManyVar, "NewIntAryVar over the limit", 0);
+	Check(NewStrAryVar("over", 1) == ErrTooManyVar, "NewStrAryVar over the limit", 0);
+	Check(! NewLabVar("over", 0, 0), "NewLabVar over the limit", 0);
+	Check(! CheckVar("over", &type, &id), "CheckVar over the limit", 0);
+
+	// O
+	for (i = 0; i < n; i++) {
+		VarName(name, sizeof(name), i, (i & 1) != 0);
+		Check(CheckVar(name, &type, &id) && id == (TVarId)i, "CheckVar", i);
+		Check(type == (IsLabel(i) ? TypLabel : TypInteger), "CheckVar type", i);
+		if (type == TypInteger)
+			Check(CopyIntVal(id) == i, "CopyIntVal", i);
+	}
+	end = clock();
+
+	// Yő̔zϐ̗vf
+	Check(CheckVar("ARY", &type, &id) && id == MaxVariableCount - 1 && type == TypIntArray, "CheckVar ary", 0);
+	for (i = 0; i < 4; i++) {
+		Err = 0;
+		elem = GetIntVarFromArray(id, i, &Err);
+		Check(Err == 0, "GetIntVarFromArray", i);
+		SetIntVal(elem, 100 + i);
+	}
+	for (i = 0; i < 4; i++) {
+		Err = 0;
+		elem = GetIntVarFromArray(id, i, &Err);
+		Check(CopyIntVal(elem) == 100 + i, "array element", i);
+	}
+
+	// x폜ƓY邪AO
+	DelLabVar(1);
+	for (i = 0; i < n; i++) {
+		VarName(name, sizeof(name), i, FALSE);
+		if (IsLabel(i)) {
+			Check(! CheckVar(name, &type, &id), "deleted label", i);
+		}
+		else {
+			Check(CheckVar(name, &type, &id) && type == TypInteger && CopyIntVal(id) == i,
+			      "CheckVar after DelLabVar", i);
+		}
+	}
+	Check(CheckVar("ary", &type, &id) && type == TypIntArray && GetIntAryVarSize(id) == 4,
+	      "CheckVar ary after DelLabVar", 0);
+
+	// 폜͂܂
+	Check(NewIntVar("after", 1), "NewIntVar after DelLabVar", 0);
+
+	EndVar();
+
+	if (ng > 0) {
+		return 1;
+	}
+	printf("OK %d variables, create %.0f ms, lookup %.0f ms\n", n + 1,
+	       (double)(mid - start) * 1000 / CLOCKS_PER_SEC,
+	       (double)(end - mid) * 1000 / CLOCKS_PER_SEC);
+	return 0;
+}
@@ -0,0 +1,387 @@
+/*
+ * ZMODEM M̃[vobNeXg
+ *
+ *   zmodem.c ̑MƎMłȂŃt@C]A
+ *   ëvƑx\
+ *   t@C̓ TFileIO ĝŁAfBXN̑x͊܂܂Ȃ
+ *
+ *   ʐMH 1 tick  BANDWIDTH oCgāAlatency tick 
+ *   ͂̂ƂĈBcorrupt w肷ƑM̃f[^
+ *   悻 corrupt oCg 1 
+ *   "link" ͒ʐMH̎gp (]oCg / (tick * BANDWIDTH))
+ *
+ *   Linux/MinGW Ŏs
+ *     sh zmodem-loopback.sh [MB] [latency] [corrupt] [datalen] [winsize]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <time.h>
+#include <windows.h>
+
+#include "tttypes.h"
+#include "ttcommon.h"
+#include "filesys_proto.h"
+#include "protolog.h"
+#include "zmodem.h"
+
+#define BANDWIDTH	4096	/* bytes / tick */
+
+static DWORD now;	/* tick */
+
+/* ʐMH (Е) */
+typedef struct LoopBuf {
+	BYTE *buf;
+	DWORD *when;		/* ǂ߂悤ɂȂ tick */
+	size_t size;
+	size_t head, tail;	/* tail ǂ, head ɏ (O) */
+	size_t count;
+	int budget;			/*  tick ɑcoCg */
+	int corrupt;		/* 0 ȊÔƂ, 悻 corrupt oCg 1  */
+	int corrupted;
+} TLoopBuf;
+
+struct LoopCom {
+	TLoopBuf *in;
+	TLoopBuf *out;
+	DWORD latency;
+};
+
+static void LoopInit(TLoopBuf *lb, size_t size, int corrupt)
+{
+	memset(lb, 0, sizeof(*lb));
+	lb->size = size;
+	lb->buf = (BYTE *)malloc(size);
+	lb->when = (DWORD *)malloc(size * sizeof(DWORD));
+	lb->corrupt = corrupt;
+}
+
+int CommBinaryOut(PComVar cv, PCHAR B, int C)
+{
+	struct LoopCom *com = (struct LoopCom *)cv->loop;
+	TLoopBuf *lb = com->out;
+	int i;
+	for (i = 0; i < C && lb->count < lb->size && lb->budget > 0; i++) {
+		BYTE b = (BYTE)B[i];
+		if (lb->corrupt != 0 && rand() % lb->corrupt == 0) {
+			b ^= 0x10;
+			lb->corrupted++;
+		}
+		lb->buf[lb->head] = b;
+		lb->when[lb->head] = now + com->latency;
+		lb->head = (lb->head + 1) % lb->size;
+		lb->count++;
+		lb->budget--;
+	}
+	return i;
+}
+
+int CommRead1Byte(PComVar cv, LPBYTE b)
+{
+	TLoopBuf *lb = ((struct LoopCom *)cv->loop)->in;
+	if (lb->count == 0 || lb->when[lb->tail] > now) {
+		return 0;
+	}
+	*b = lb->buf[lb->tail];
+	lb->tail = (lb->tail + 1) % lb->size;
+	lb->count--;
+	return 1;
+}
+
+void CommInsert1Byte(PComVar cv, BYTE b)
+{
+	TLoopBuf *lb = ((struct LoopCom *)cv->loop)->in;
+	if (lb->count < lb->size) {
+		lb->tail = (lb->tail + lb->size - 1) % lb->size;
+		lb->buf[lb->tail] = b;
+		lb->when[lb->tail] = now;
+		lb->count++;
+	}
+}
+
+TProtoLog *ProtoLogCreate(void)
+{
+	return NULL;
+}
+
+/* ̃t@C */
+typedef struct {
+	BYTE *data;
+	size_t size;
+	size_t cap;
+	size_t pos;
+	int read_calls;
+	int write_calls;
+} TMemFile;
+
+static TMemFile src_file;
+static TMemFile dst_file;
+
+static BOOL MemOpenRead(TFileIO *fv, const char *filename)
+{
+	fv->data = &src_file;
+	src_file.pos = 0;
+	return TRUE;
+}
+
+static BOOL MemOpenWrite(TFileIO *fv, const char *filename)
+{
+	fv->data = &dst_file;
+	dst_file.size = 0;
+	dst_file.pos = 0;
+	return TRUE;
+}
+
+static size_t MemReadFile(TFileIO *fv, void *buf, size_t bytes)
+{
+	TMemFile *f = (TMemFile *)fv->data;
+	size_t len = f->size - f->pos;
+	if (len > bytes) {
+		len = bytes;
+	}
+	memcpy(buf, f->data + f->pos, len);
+	f->pos += len;
+	f->read_calls++;
+	return len;
+}
+
+static size_t MemWriteFile(TFileIO *fv, const void *buf, size_t bytes)
+{
+	TMemFile *f = (TMemFile *)fv->data;
+	if (f->pos + bytes > f->cap) {
+		f->cap = (f->pos + bytes) * 2;
+		f->data = (BYTE *)realloc(f->data, f->cap);
+	}
+	memcpy(f->data + f->pos, buf, bytes);
+	f->pos += bytes;
+	if (f->size < f->pos) {
+		f->size = f->pos;
+	}
+	f->write_calls++;
+	return bytes;
+}
+
+static void MemClose(TFileIO *fv)
+{
+}
+
+static int MemSeek(TFileIO *fv, size_t offset)
+{
+	TMemFile *f = (TMemFile *)fv->data;
+	f->pos = offset;
+	return 0;
+}
+
+static size_t MemGetFSize(TFileIO *fv, const char *filename)
+{
+	return src_file.size;
+}
+
+static BOOL MemSetFMtime(TFileIO *fv, const char *FName, DWORD mtime)
+{
+	return TRUE;
+}
+
+static char *MemGetSendFilename(TFileIO *fv, const char *fullname, BOOL utf8, BOOL space, BOOL upper)
+{
+	return strdup(fullname);
+}
+
+static char *MemGetRecieveFilename(TFileIO *fv, const char* filename, BOOL utf8, const char *path, BOOL unique)
+{
+	return strdup(filename);
+}
+
+static long MemGetFMtime(TFileIO *fv, const char *fullname)
+{
+	return 0;
+}
+
+static void MemInit(TFileIO *file)
+{
+	memset(file, 0, sizeof(*file));
+	file->OpenRead = MemOpenRead;
+	file->OpenWrite = MemOpenWrite;
+	file->ReadFile = MemReadFile;
+	file->WriteFile = MemWriteFile;
+	file->Close = MemClose;
+	file->Seek = MemSeek;
+	file->GetFSize = MemGetFSize;
+	file->SetFMtime = MemSetFMtime;
+	file->GetSendFilename = MemGetSendFilename;
+	file->GetRecieveFilename = MemGetRecieveFilename;
+	file->GetFMtime = MemGetFMtime;
+}
+
+/* vgRĂ΂T[rX */
+static int send_count;
+
+static char *GetNextFname(PFileVarProto fv)
+{
+	if (send_count++ > 0) {
+		return NULL;
+	}
+	return strdup("test.bin");
+}
+
+static char *GetRecievePath(PFileVarProto fv)
+{
+	return strdup("");
+}
+
+static void FTSetTimeOut(PFileVarProto fv, int T)
+{
+}
+
+static void InitDlgProgress(PFileVarProto fv, int *CurProgStat)
+{
+}
+
+static void SetDlgTime(PFileVarProto fv, DWORD elapsed, int bytes)
+{
+}
+
+static void SetDlgNum(PFileVarProto fv, LONG Num)
+{
+}
+
+static void SetDlgPercent(PFileVarProto fv, LONG a, LONG b, int *p)
+{
+}
+
+static void SetDlgText(PFileVarProto fv, const char *text)
+{
+}
+
+static const TInfoOp InfoOp = {
+	InitDlgProgress,
+	SetDlgTime,
+	SetDlgNum,
+	SetDlgNum,
+	SetDlgPercent,
+	SetDlgText,
+	SetDlgText,
+};
+
+static int SetOpt(PFileVarProto fv, int request, ...)
+{
+	int r;
+	va_list ap;
+	va_start(ap, request);
+	r = fv->ProtoOp->SetOptV(fv, request, ap);
+	va_end(ap);
+	return r;
+}
+
+static void SetupSide(PFileVarProto fv, TFileIO *file, int mode)
+{
+	memset(fv, 0, sizeof(*fv));
+	MemInit(file);
+	fv->file = file;
+	fv->InfoOp = &InfoOp;
+	fv->GetNextFname = GetNextFname;
+	fv->GetRecievePath = GetRecievePath;
+	fv->FTSetTimeOut = FTSetTimeOut;
+	fv->OverWrite = TRUE;
+	ZCreate(fv);
+	SetOpt(fv, ZMODEM_MODE, mode);
+	SetOpt(fv, ZMODEM_BINFLAG, TRUE);
+}
+
+int main(int argc, char *argv[])
+{
+	size_t mb = argc > 1 ? (size_t)atoi(argv[1]) : 16;
+	DWORD latency = argc > 2 ? (DWORD)atoi(argv[2]) : 0;
+	int corrupt = argc > 3 ? atoi(argv[3]) : 0;
+	TLoopBuf s2r, r2s;
+	struct LoopCom scom, rcom;
+	TComVar scv, rcv;
+	TTTSet ts;
+	TFileVarProto sfv, rfv;
+	TFileIO sfile, rfile;
+	BOOL srun = TRUE, rrun = TRUE;
+	size_t i;
+	size_t pipe_size;
+	DWORD idle = 0;
+	clock_t t;
+	double sec;
+	int ok;
+
+	src_file.size = mb * 1024 * 1024 + 777;	/* [̂钷 */
+	src_file.data = (BYTE *)malloc(src_file.size);
+	for (i = 0; i < src_file.size; i++) {
+		/* GXP[vΏۂ܂ނ悤ɑSoCgg */
+		src_file.data[i] = (BYTE)(rand() >> 3);
+	}
+
+	/* ш * x ̃oCgʐMHɏ */
+	pipe_size = (size_t)BANDWIDTH * (latency + 2);
+	LoopInit(&s2r, pipe_size, corrupt);
+	LoopInit(&r2s, pipe_size, 0);
+	scom.in = &r2s;
+	scom.out = &s2r;
+	rcom.in = &s2r;
+	rcom.out = &r2s;
+	scom.latency = rcom.latency = latency;
+	memset(&scv, 0, sizeof(scv));
+	memset(&rcv, 0, sizeof(rcv));
+	scv.loop = &scom;
+	rcv.loop = &rcom;
+	scv.PortType = rcv.PortType = IdTCPIP;
+
+	memset(&ts, 0, sizeof(ts));
+	ts.ZmodemDataLen = argc > 4 ? atoi(argv[4]) : 1024;
+	ts.ZmodemWinSize = argc > 5 ? atoi(argv[5]) : 32767;
+	ts.ZmodemTimeOutNormal = 10;
+	ts.ZmodemTimeOutTCPIP = 0;
+	ts.ZmodemTimeOutInit = 10;
+	ts.ZmodemTimeOutFin = 3;
+
+	SetupSide(&sfv, &sfile, IdZSend);
+	SetupSide(&rfv, &rfile, IdZReceive);
+
+	t = clock();
+	s2r.budget = r2s.budget = BANDWIDTH;
+	sfv.ProtoOp->Init(&sfv, &scv, &ts);
+	rfv.ProtoOp->Init(&rfv, &rcv, &ts);
+	while (srun || rrun) {
+		s2r.budget = r2s.budget = BANDWIDTH;
+		if (srun) {
+			srun = sfv.ProtoOp->Parse(&sfv, &scv);
+		}
+		if (rrun) {
+			rrun = rfv.ProtoOp->Parse(&rfv, &rcv);
+		}
+		/* ʐMĤ܂ܐi܂ȂƂ͎M̃^CAEg */
+		if (s2r.count == 0 && r2s.count == 0 && s2r.budget == BANDWIDTH) {
+			if (++idle > latency + 10) {
+				rfv.ProtoOp->TimeOutProc(&rfv, &rcv);
+				idle = 0;
+			}
+		}
+		else {
+			idle = 0;
+		}
+		now++;
+		if (now > 100000000) {
+			break;
+		}
+	}
+	sec = (double)(clock() - t) / CLOCKS_PER_SEC;
+
+	ok = rfv.Success && dst_file.size == src_file.size &&
+		memcmp(dst_file.data, src_file.data, src_file.size) == 0;
+	printf("%zu bytes, %.2f s, %.1f MB/s\n", src_file.size, sec,
+		   src_file.size / 1024.0 / 1024.0 / sec);
+	printf("%lu ticks, link %.1f%%, %d bytes corrupted\n", (unsigned long)now,
+		   100.0 * src_file.size / ((double)now * BANDWIDTH), s2r.corrupted);
+	printf("ReadFile %d calls, WriteFile %d calls\n",
+		   src_file.read_calls, dst_file.write_calls);
+	printf("%s\n", ok ? "OK" : "NG");
+
+	sfv.ProtoOp->Destroy(&sfv);
+	rfv.ProtoOp->Destroy(&rfv);
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,79 @@
+#!/bin/sh
+# zmodem.c のループバックテストをビルドして実行する
+#   usage: zmodem-loopback.sh [MB] [latency] [corrupt] [datalen] [winsize]
+#   tttypes.h などは zmodem.c が使う部分だけを定義したものを用意してビルドする
+
+cd "$(dirname "$0")"
+CC=${CC:-cc}
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+mkdir -p "$tmp/sys"
+
+cat > "$tmp/windows.h" <<'EOT'
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <wchar.h>
+typedef uint8_t BYTE;
+typedef BYTE *LPBYTE;
+typedef uint16_t WORD;
+typedef uint32_t DWORD;
+typedef int32_t LONG;
+typedef int BOOL;
+typedef unsigned int UINT;
+typedef char *PCHAR;
+typedef void *HWND;
+#define TRUE 1
+#define FALSE 0
+#define LOBYTE(w) ((BYTE)((w) & 0xff))
+#define HIBYTE(w) ((BYTE)(((w) >> 8) & 0xff))
+#define LOWORD(l) ((WORD)((l) & 0xffff))
+#define HIWORD(l) ((WORD)(((l) >> 16) & 0xffff))
+#define _countof(a) (sizeof(a) / sizeof((a)[0]))
+#define _TRUNCATE ((size_t)-1)
+#define _S_IFREG 0100000
+#define MB_ICONEXCLAMATION 0
+#define MessageBox(h, t, c, f) 0
+#define strncpy_s(d, n, s, c) (snprintf((char *)(d), (n), "%s", (s)), 0)
+#define strncat_s(d, n, s, c) (snprintf((char *)(d) + strlen(d), (n) - strlen(d), "%s", (s)), 0)
+#define _snprintf_s(d, n, c, ...) snprintf((char *)(d), (n), __VA_ARGS__)
+#define sscanf_s sscanf
+static inline DWORD GetTickCount(void) { return (DWORD)(clock() * 1000 / CLOCKS_PER_SEC); }
+EOT
+: > "$tmp/sys/utime.h"
+
+cat > "$tmp/tttypes.h" <<'EOT'
+#pragma once
+#include <windows.h>
+#define XON 0x11
+#define IdTCPIP 1
+#define FT_ZESCCTL 1
+#define LOG_Z 1
+typedef struct {
+	int PortType;
+	void *loop;
+} TComVar, *PComVar;
+typedef struct {
+	int Baud;
+	int FTFlag;
+	int LogFlag;
+	wchar_t *LogDirW;
+	char ZModemRcvCommand[32];
+	int ZmodemDataLen, ZmodemWinSize;
+	int ZmodemTimeOutNormal, ZmodemTimeOutTCPIP, ZmodemTimeOutInit, ZmodemTimeOutFin;
+} TTTSet, *PTTSet;
+EOT
+
+cat > "$tmp/ttcommon.h" <<'EOT'
+#pragma once
+int CommBinaryOut(PComVar cv, PCHAR B, int C);
+int CommRead1Byte(PComVar cv, LPBYTE b);
+void CommInsert1Byte(PComVar cv, BYTE b);
+EOT
+
+$CC -O2 -w -I"$tmp" -I../teraterm/ttpfile -I../teraterm/teraterm -o "$tmp/zmodem-loopback" \
+	zmodem-loopback.c ../teraterm/ttpfile/zmodem.c ../teraterm/ttpfile/ftlib.c &&
+"$tmp/zmodem-loopback" "$@"
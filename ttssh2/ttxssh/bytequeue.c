@@ -0,0 +1,189 @@
+/*
+ * Copyright (C) 2026- TeraTerm Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "bytequeue.h"
+
+struct bytequeue_chunk {
+	bytequeue_chunk_t *next;
+	size_t start;   // ǂݏoʒu
+	size_t end;     // ݈ʒu
+	unsigned char data[BYTEQUEUE_CHUNK_SIZE];
+};
+
+void bytequeue_init(bytequeue_t *q)
+{
+	memset(q, 0, sizeof(*q));
+}
+
+// L[ɂă
+void bytequeue_free(bytequeue_t *q)
+{
+	bytequeue_chunk_t *p = q->head;
+
+	while (p != NULL) {
+		bytequeue_chunk_t *next = p->next;
+		free(p);
+		p = next;
+	}
+	free(q->spare);
+	q->head = NULL;
+	q->tail = NULL;
+	q->spare = NULL;
+	q->len = 0;
+}
+
+static bytequeue_chunk_t *bytequeue_new_chunk(bytequeue_t *q)
+{
+	bytequeue_chunk_t *p = q->spare;
+
+	if (p != NULL) {
+		q->spare = NULL;
+	} else {
+		p = malloc(sizeof(bytequeue_chunk_t));
+		if (p == NULL) {
+			return NULL;
+		}
+		q->allocs++;
+	}
+	p->next = NULL;
+	p->start = 0;
+	p->end = 0;
+	return p;
+}
+
+/*
+ * ɒǉ
+ *
+ * @return	ǉoCg
+ *			mۂłȂƂ len 菬Ȃ
+ */
+size_t bytequeue_append(bytequeue_t *q, const void *data, size_t len)
+{
+	const unsigned char *src = (const unsigned char *)data;
+	size_t appended = 0;
+
+	while (appended < len) {
+		bytequeue_chunk_t *p = q->tail;
+		size_t n;
+
+		if (p == NULL || p->end == BYTEQUEUE_CHUNK_SIZE) {
+			p = bytequeue_new_chunk(q);
+			if (p == NULL) {
+				break;
+			}
+			if (q->tail == NULL) {
+				q->head = p;
+			} else {
+				q->tail->next = p;
+			}
+			q->tail = p;
+		}
+
+		n = BYTEQUEUE_CHUNK_SIZE - p->end;
+		if (n > len - appended) {
+			n = len - appended;
+		}
+		memcpy(p->data + p->end, src + appended, n);
+		p->end += n;
+		appended += n;
+	}
+
+	q->len += appended;
+	q->total += appended;
+	if (q->len > q->peak) {
+		q->peak = q->len;
+	}
+	return appended;
+}
+
+/*
+ * 擪 len oCgRs[
+ *   `N܂ŘÄɃRs[BL[͎菜Ȃ
+ *
+ * @param[out]	data	Rs[
+ * @return		Rs[oCg
+ *				L[ɓĂ̂ len 菭ȂƂ́ÃoCg
+ */
+size_t bytequeue_copy(const bytequeue_t *q, void *data, size_t len)
+{
+	unsigned char *dst = (unsigned char *)data;
+	bytequeue_chunk_t *p = q->head;
+	size_t copied = 0;
+
+	while (p != NULL && copied < len) {
+		size_t n = p->end - p->start;
+
+		if (n > len - copied) {
+			n = len - copied;
+		}
+		memcpy(dst + copied, p->data + p->start, n);
+		copied += n;
+		p = p->next;
+	}
+	return copied;
+}
+
+// 擪 len oCg菜
+void bytequeue_consume(bytequeue_t *q, size_t len)
+{
+	if (len > q->len) {
+		len = q->len;
+	}
+	q->len -= len;
+
+	while (len > 0) {
+		bytequeue_chunk_t *p = q->head;
+		size_t n = p->end - p->start;
+
+		if (n > len) {
+			p->start += len;
+			break;
+		}
+
+		// `Ng؂
+		len -= n;
+		q->head = p->next;
+		if (q->head == NULL) {
+			q->tail = NULL;
+		}
+		if (q->spare == NULL) {
+			q->spare = p;
+		} else {
+			free(p);
+		}
+	}
+
+	// ɂȂ珑݈ʒu擪ɖ߂āA`Ng
+	if (q->len == 0 && q->head != NULL) {
+		q->head->start = 0;
+		q->head->end = 0;
+	}
+}
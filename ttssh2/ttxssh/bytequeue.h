@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2026- TeraTerm Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * oCgL[
+ *
+ * ŒTCỸ`NȂ FIFOB
+ * ǉ͖̃`N̋󂫂ɋl߂̂ŁAxǉĂ`N
+ * (oCg / BYTEQUEUE_CHUNK_SIZE) xɂȂȂB
+ * 擪Cӂ̃oCgA`N܂ŃRs[/ołB
+ */
+
+#define BYTEQUEUE_CHUNK_SIZE (16 * 1024)
+
+typedef struct bytequeue_chunk bytequeue_chunk_t;
+
+typedef struct bytequeue {
+	bytequeue_chunk_t *head;    // ǂݏo
+	bytequeue_chunk_t *tail;    // ݑ
+	bytequeue_chunk_t *spare;   // ɂȂ`N1ĂA̒ǉŎg
+	size_t len;                 // L[ɓĂoCg
+
+	// v
+	size_t peak;                // len ̍ől
+	unsigned long long total;   // ǉoCg̍v
+	unsigned long allocs;       // `Nmۂ
+} bytequeue_t;
+
+void bytequeue_init(bytequeue_t *q);
+void bytequeue_free(bytequeue_t *q);
+size_t bytequeue_append(bytequeue_t *q, const void *data, size_t len);
+size_t bytequeue_copy(const bytequeue_t *q, void *data, size_t len);
+void bytequeue_consume(bytequeue_t *q, size_t len);
+
+#define bytequeue_len(q) ((q)->len)
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,456 @@
+/*
+ * Copyright (C) 2026- TeraTerm Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ttxssh.h"
+#include "channel.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+//
+// `l\
+//
+
+// Channel_t  CHANNEL_BLOCK_SIZE ܂Ƃ߂ĊmۂAȂȂǉB
+// mۂ Channel_t ͐ڑ(ssh2_channel_free())܂ŉȂ̂ŁA
+// SCP XbhȂǂĂ Channel_t ̃|C^͕ςȂB
+#define CHANNEL_BLOCK_SIZE 64
+#define CHANNEL_MAX (64*1024)
+
+static struct {
+	Channel_t **list;       // self_id -> Channel_t
+	int num;                // mۂ Channel_t ̐
+	int *free_next;         // 󂢂Ă self_id ̃Xg(FIFO)
+	int free_head;
+	int free_tail;
+	Channel_t **local;      // local_num(fwd.c ̃`lԍ) -> Channel_t (TYPE_PORTFWD ̂)
+	int local_num;          // local[] ̑傫
+} channels = { NULL, 0, NULL, -1, -1, NULL, 0 };
+
+// 󂢂Ă self_id Xg̖ɒǉ
+// ΂̃`lԍɎg񂳂Ȃ悤ɁAÂ̂gB
+static void ssh2_channel_push_free(int id)
+{
+	channels.free_next[id] = -1;
+	if (channels.free_tail == -1) {
+		channels.free_head = id;
+	} else {
+		channels.free_next[channels.free_tail] = id;
+	}
+	channels.free_tail = id;
+}
+
+// Channel_t  CHANNEL_BLOCK_SIZE ǉ
+static BOOL ssh2_channel_grow(void)
+{
+	int num = channels.num + CHANNEL_BLOCK_SIZE;
+	Channel_t **list;
+	int *free_next;
+	Channel_t *block;
+	int i;
+
+	if (num > CHANNEL_MAX) {
+		return FALSE;
+	}
+	list = realloc(channels.list, sizeof(Channel_t *) * num);
+	if (list == NULL) {
+		return FALSE;
+	}
+	channels.list = list;
+	free_next = realloc(channels.free_next, sizeof(int) * num);
+	if (free_next == NULL) {
+		return FALSE;
+	}
+	channels.free_next = free_next;
+	block = calloc(CHANNEL_BLOCK_SIZE, sizeof(Channel_t));
+	if (block == NULL) {
+		return FALSE;
+	}
+
+	// ubN̐擪 list[CHANNEL_BLOCK_SIZE ̔{] ɂȂ(Ɏg)
+	for (i = 0; i < CHANNEL_BLOCK_SIZE; i++) {
+		channels.list[channels.num + i] = &block[i];
+		ssh2_channel_push_free(channels.num + i);
+	}
+	channels.num = num;
+	return TRUE;
+}
+
+// local_num  Channel_t 悤ɓo^
+static void ssh2_local_channel_register(int local_num, Channel_t *c)
+{
+	if (local_num < 0) {
+		return;
+	}
+	if (local_num >= channels.local_num) {
+		int num = channels.local_num == 0 ? CHANNEL_BLOCK_SIZE : channels.local_num;
+		Channel_t **local;
+		while (num <= local_num) {
+			num *= 2;
+		}
+		local = realloc(channels.local, sizeof(Channel_t *) * num);
+		if (local == NULL) {
+			return;
+		}
+		memset(local + channels.local_num, 0, sizeof(Channel_t *) * (num - channels.local_num));
+		channels.local = local;
+		channels.local_num = num;
+	}
+	channels.local[local_num] = c;
+}
+
+// 󂢂Ă Channel_t o
+// 0 NA self_id, type, local_num ݒ肷B󂫂Ȃ NULL ԂB
+Channel_t *ssh2_channel_alloc(enum channel_type type, int local_num)
+{
+	int id;
+	Channel_t *c;
+
+	if (channels.free_head == -1 && !ssh2_channel_grow()) { // not free channel
+		return (NULL);
+	}
+	id = channels.free_head;
+	channels.free_head = channels.free_next[id];
+	if (channels.free_head == -1) {
+		channels.free_tail = -1;
+	}
+
+	c = channels.list[id];
+	memset(c, 0, sizeof(Channel_t));
+	c->used = 1;
+	c->self_id = id;
+	c->type = type;
+	c->local_num = local_num;  // alloc_channel()̕ԒlۑĂ
+	if (type == TYPE_PORTFWD) {
+		ssh2_local_channel_register(local_num, c);
+	}
+
+	return (c);
+}
+
+// Channel_t 󂫃Xg֕ԋp
+// ނƂ̌n ssh2_channel_delete() ōς܂ĂĂԁB
+void ssh2_channel_release(Channel_t *c)
+{
+	int used = c->used;
+	int id = c->self_id;
+
+	if (c->type == TYPE_PORTFWD &&
+	    c->local_num >= 0 && c->local_num < channels.local_num &&
+	    channels.local[c->local_num] == c) {
+		channels.local[c->local_num] = NULL;
+	}
+
+	memset(c, 0, sizeof(Channel_t));
+	c->used = 0;
+
+	// 󂫃Xg֕ԋp
+	if (used) {
+		ssh2_channel_push_free(id);
+	}
+}
+
+// self_id  Channel_t ԂBgĂȂ̂ԂB
+// id mۂ𒴂Ă NULL ԂB(S`lɌƂɎg)
+Channel_t *ssh2_channel_slot(int id)
+{
+	if (id < 0 || id >= channels.num) {
+		return (NULL);
+	}
+	return (channels.list[id]);
+}
+
+// ׂẴ`l ssh2_channel_delete() ɁA\
+void ssh2_channel_table_free(void)
+{
+	int i;
+
+	// Channel_t ̓ubNPʂŊmۂĂ
+	for (i = 0 ; i < channels.num ; i += CHANNEL_BLOCK_SIZE) {
+		free(channels.list[i]);
+	}
+	free(channels.list);
+	free(channels.free_next);
+	free(channels.local);
+	channels.list = NULL;
+	channels.num = 0;
+	channels.free_next = NULL;
+	channels.free_head = -1;
+	channels.free_tail = -1;
+	channels.local = NULL;
+	channels.local_num = 0;
+}
+
+Channel_t *ssh2_channel_lookup(int id)
+{
+	Channel_t *c;
+
+	if (id < 0 || id >= channels.num) {
+		logprintf(LOG_LEVEL_VERBOSE, "%s: invalid channel id. (%d)", __FUNCTION__, id);
+		return (NULL);
+	}
+	c = channels.list[id];
+	if (c->used == 0) { // already freed
+		logprintf(LOG_LEVEL_VERBOSE, "%s: channel was already freed. id:%d", __FUNCTION__, id);
+		return (NULL);
+	}
+	return (c);
+}
+
+// SSH1ŊǗĂchannel\̂ASSH2Channel_t֕ϊB
+// TODO: Iɂ̓`l\̂1ɓB
+// (2005.6.12 yutaka)
+Channel_t *ssh2_local_channel_lookup(int local_num)
+{
+	Channel_t *c;
+
+	if (local_num < 0 || local_num >= channels.local_num)
+		return (NULL);
+	c = channels.local[local_num];
+	if (c == NULL || c->type != TYPE_PORTFWD || c->local_num != local_num)
+		return (NULL);
+	return (c);
+}
+
+//
+// f[^M
+//
+
+// remote_window̋󂫂ȂꍇɁAȂf[^L[i͏j֒ǉĂB
+// ssh2_channel_retry_send_bufchain() ő菜B
+static void ssh2_channel_add_bufchain(PTInstVar pvar, Channel_t *c, unsigned char *buf, unsigned int buflen)
+{
+	if (bytequeue_append(&c->bufchain, buf, buflen) != buflen) {
+		logprintf(LOG_LEVEL_ERROR, "%s: can not allocate memory. channel:%d queued:%lu",
+		          __FUNCTION__, c->self_id, (unsigned long)bytequeue_len(&c->bufchain));
+	}
+
+	// remote_window̋󂫂Ȃ̂ŁAlocal connectioñpPbgM
+	// ~woBɒʒm~܂킯ł͂ȂB
+	FWD_suspend_resume_local_connection(pvar, c, FALSE);
+}
+
+// len oCĝAremote_window  remote_maxpacket Ɏ܂ 1 pPbg̃oCg
+static unsigned int ssh2_channel_fragment_len(Channel_t *c, unsigned int len)
+{
+	unsigned int maxpacket = c->remote_maxpacket;
+
+	if (maxpacket == 0) {
+		// 肪 0 ʒmĂꍇ́AȂƂlŕ
+		maxpacket = CHAN_SES_PACKET_DEFAULT;
+	}
+	if (len > c->remote_window)
+		len = c->remote_window;
+	if (len > maxpacket)
+		len = maxpacket;
+	return len;
+}
+
+/*
+ * SSH2_MSG_CHANNEL_DATA  1 
+ *
+ * f[^͑MpPbg̃obt@֒ڏށB
+ * buf  NULL ̂Ƃ̓L[̐擪 len oCgRs[ (L[͎菜Ȃ)B
+ */
+static void ssh2_channel_send_fragment(PTInstVar pvar, Channel_t *c, const unsigned char *buf, unsigned int len)
+{
+	unsigned char *outmsg;
+
+	// uint32 recipient channel, string data
+	outmsg = begin_send_packet(pvar, SSH2_MSG_CHANNEL_DATA, 4 + 4 + len);
+	set_uint32(outmsg, c->remote_id);
+	set_uint32(outmsg + 4, len);
+	if (buf != NULL) {
+		memcpy(outmsg + 8, buf, len);
+	} else {
+		bytequeue_copy(&c->bufchain, outmsg + 8, len);
+	}
+	finish_send_packet(pvar);
+
+	logprintf(LOG_LEVEL_SSHDUMP, "%s: sending SSH2_MSG_CHANNEL_DATA. "
+			  "local:%d remote:%d len:%d", __FUNCTION__, c->self_id, c->remote_id, len);
+
+	// remote window size̒
+	c->remote_window -= len;
+}
+
+/*
+ * SSH2_MSG_CHANNEL_DATA 𑗂
+ *
+ * remote_window  remote_maxpacket Ɏ܂悤ɕāA
+ * 邾B
+ *
+ * @return	oCg
+ */
+static unsigned int ssh2_channel_send_fragments(PTInstVar pvar, Channel_t *c, unsigned char *buf, unsigned int buflen)
+{
+	unsigned int sent = 0;
+
+	while (sent < buflen) {
+		unsigned int len = ssh2_channel_fragment_len(c, buflen - sent);
+
+		if (len == 0)
+			break;
+		ssh2_channel_send_fragment(pvar, c, buf + sent, len);
+		sent += len;
+	}
+
+	return sent;
+}
+
+// remote_window̋󂫂łAL[ɎcĂf[^ԂɑB
+// L[̃`N̋ڂł͋؂炸A1 pPbg remote_window 
+// remote_maxpacket ̑傫܂ŋl߂B܂Ȃc̓L[ɎcB
+void ssh2_channel_retry_send_bufchain(PTInstVar pvar, Channel_t *c)
+{
+	size_t queued;
+	unsigned int len;
+
+	while ((queued = bytequeue_len(&c->bufchain)) > 0) {
+		// ͑Ȃ
+		if (pvar->kex_status & KEX_FLAG_REKEYING)
+			break;
+
+		// 擪ɑ
+		len = ssh2_channel_fragment_len(c, queued > c->remote_window ? c->remote_window : (unsigned int)queued);
+		if (len == 0) {
+			// remote_window ȂBc͎ SSH2_MSG_CHANNEL_WINDOW_ADJUST ő
+			break;
+		}
+		ssh2_channel_send_fragment(pvar, c, NULL, len);
+		bytequeue_consume(&c->bufchain, len);
+	}
+
+	// L[Alocal connectioñpPbgʒm̍ĊJ𔻒fB
+	if (c->bufchain_recv_suspended) {
+		FWD_suspend_resume_local_connection(pvar, c, TRUE);
+	}
+}
+
+void SSH2_send_channel_data(PTInstVar pvar, Channel_t *c, unsigned char *buf, unsigned int buflen, int retry)
+{
+	unsigned int sent;
+
+	if (c == NULL)
+		return;
+
+	// SSH2̏ꍇ́ApPbg𑗂Ȃ̂łۑĂ
+	if (pvar->kex_status & KEX_FLAG_REKEYING) {
+		ssh2_channel_add_bufchain(pvar, c, buf, buflen);
+		return;
+	}
+
+	// gCł͂ȂAʏ̃pPbgM̍ہAȑOȂf[^
+	// L[ɎcĂ悤ł΁AL[̖ɌqB
+	// ɂpPbgꂽ悤Ɍ錻ۂPB
+	// (2012.10.14 yutaka)
+	if (retry == 0 && bytequeue_len(&c->bufchain) > 0) {
+		ssh2_channel_add_bufchain(pvar, c, buf, buflen);
+		return;
+	}
+
+	// remote_window Ɏ܂镪͂ɑ
+	sent = ssh2_channel_send_fragments(pvar, c, buf, buflen);
+	if (sent < buflen) {
+		// Ȃf[^͂ۑĂ
+		ssh2_channel_add_bufchain(pvar, c, buf + sent, buflen - sent);
+	}
+}
+
+//
+// MEBhE
+//
+
+// NCAgwindow sizeT[o֒m点
+//
+// MEBhE̎
+//   window  RTT ̎Mʂ菬ƁAĂ
+//   window / RTT ȏ̑xoȂB
+//   RTT ̊Ԃ window ̔ȏMĂA
+//   window ̑傫œłɂȂĂƂ݂Ȃ local_window_max 
+//   2 {ɂ( MaxWindowSize)B
+//   RTT ́AT[oM҂ĂƂ(local_window  maxpacket )
+//    WINDOW_ADJUST Ã̕f[^͂܂ł̎Ԃ̍ŏlB
+void do_SSH2_adjust_window_size(PTInstVar pvar, Channel_t *c)
+{
+	// window size32KB֕ύXAlocal window̔ʂCB
+	// ɂSSH2̃X[vbgシB(2006.3.6 yutaka)
+	unsigned char *outmsg;
+	unsigned long long received = c->local_granted - c->local_window;
+	unsigned int window_limit = (unsigned int)pvar->settings.MaxWindowSize;
+	DWORD now = GetTickCount();
+
+	// O WINDOW_ADJUST ő₵̃f[^͂ RTT ܂
+	if (c->rtt_measuring && received > c->rtt_mark) {
+		DWORD rtt = max(now - c->rtt_tick, 1);
+		if (c->rtt == 0 || rtt < c->rtt) {
+			c->rtt = rtt;
+		}
+		c->rtt_measuring = FALSE;
+	}
+
+	// [Jwindow sizeɂ܂]TȂAȂB
+	// added /2 (2006.3.6 yutaka)
+	if (c->local_window > c->local_window_max/2)
+		return;
+
+	// RTT ̎Mʂ window 傫
+	if (c->rtt != 0 && c->local_window_max < window_limit &&
+	    now - c->rate_tick >= c->rtt) {
+		unsigned long long per_rtt = (received - c->rate_bytes) * c->rtt / (now - c->rate_tick);
+		if (per_rtt >= c->local_window_max / 2) {
+			unsigned int window_max = c->local_window_max * 2;
+			if (window_max > window_limit || window_max < c->local_window_max) {
+				window_max = window_limit;
+			}
+			logprintf(LOG_LEVEL_VERBOSE, "%s: channel %d window %u -> %u (rtt %u ms)",
+			          __FUNCTION__, c->self_id, c->local_window_max, window_max, c->rtt);
+			c->local_window_max = window_max;
+		}
+		c->rate_tick = now;
+		c->rate_bytes = received;
+	}
+
+	// T[o window g؂đ҂ĂȂARTT v
+	if (!c->rtt_measuring && c->local_window < c->local_maxpacket) {
+		c->rtt_measuring = TRUE;
+		c->rtt_tick = now;
+		c->rtt_mark = c->local_granted;
+	}
+
+	// uint32 recipient channel, uint32 bytes to add
+	outmsg = begin_send_packet(pvar, SSH2_MSG_CHANNEL_WINDOW_ADJUST, 8);
+	set_uint32(outmsg, c->remote_id);
+	set_uint32(outmsg + 4, c->local_window_max - c->local_window);
+	finish_send_packet(pvar);
+
+	logputs(LOG_LEVEL_SSHDUMP, "SSH2_MSG_CHANNEL_WINDOW_ADJUST was sent at do_SSH2_adjust_window_size().");
+	// NCAgwindow size𑝂₷
+	c->local_granted += c->local_window_max - c->local_window;
+	c->local_window = c->local_window_max;
+}
@@ -74,29 +74,107 @@ ssh_ctr_inc(unsigned char *ctr, unsigned int len)
 			return;
 }
 
+static unsigned int
+ssh_ctr_get_u32(const unsigned char *p)
+{
+	return ((unsigned int)p[0] << 24) | ((unsigned int)p[1] << 16) |
+		((unsigned int)p[2] << 8) | (unsigned int)p[3];
+}
+
+static void
+ssh_ctr_put_u32(unsigned char *p, unsigned int v)
+{
+	p[0] = (unsigned char)(v >> 24);
+	p[1] = (unsigned char)(v >> 16);
+	p[2] = (unsigned char)(v >> 8);
+	p[3] = (unsigned char)v;
+}
+
+/*
+ * ܂Ƃ߂ĐL[Xg[̃TCY
+ * ubNTCY(8 or 16)̔{ł邱
+ */
+#define SSH_CTR_KEYSTREAM_SIZE 512
+
+/*
+ * nblocks ubÑL[Xg[ ks ɐAJE^i߂
+ */
+typedef void (*ssh_ctr_keystream_func)(void *c, unsigned char *ks, size_t nblocks);
+
+/*
+ * dest = src ^ ks
+ * [hPʂ XOR A[̓oCgPʂŏ
+ * (e|C^̃ACg͖Ȃ)
+ */
+static void
+ssh_ctr_xor(unsigned char *dest, const unsigned char *src, const unsigned char *ks, size_t len)
+{
+	while (len >= sizeof(size_t)) {
+		size_t s, k;
+		memcpy(&s, src, sizeof(s));
+		memcpy(&k, ks, sizeof(k));
+		s ^= k;
+		memcpy(dest, &s, sizeof(s));
+		dest += sizeof(size_t);
+		src += sizeof(size_t);
+		ks += sizeof(size_t);
+		len -= sizeof(size_t);
+	}
+	while (len-- > 0) {
+		*(dest++) = *(src++) ^ *(ks++);
+	}
+}
+
+/*
+ * CTR [ḧÍ/(ʕ)
+ *
+ * SSH_CTR_KEYSTREAM_SIZE ̃L[Xg[܂Ƃ߂ĐĂ XOR 
+ * ĂяoƂɃubN擪n߂(]ǂAŌ̒[ubN̎ĉ͎Ă)
+ */
+static void
+ssh_ctr_crypt(ssh_ctr_keystream_func keystream, void *c, unsigned int block_size,
+              unsigned char *dest, const unsigned char *src, size_t len)
+{
+	unsigned char ks[SSH_CTR_KEYSTREAM_SIZE];
+
+	while (len > 0) {
+		size_t n = len < sizeof(ks) ? len : sizeof(ks);
+
+		keystream(c, ks, (n + block_size - 1) / block_size);
+		ssh_ctr_xor(dest, src, ks, n);
+		dest += n;
+		src += n;
+		len -= n;
+	}
+	SecureZeroMemory(ks, sizeof(ks));
+}
+
 //============================================================================
 // AES
 //============================================================================
+static void
+ssh_aes_ctr_keystream(void *ctx, unsigned char *ks, size_t nblocks)
+{
+	struct ssh_aes_ctr_ctx *c = ctx;
+
+	while (nblocks-- > 0) {
+		AES_encrypt(c->aes_counter, ks, &c->aes_ctx);
+		ssh_ctr_inc(c->aes_counter, AES_BLOCK_SIZE);
+		ks += AES_BLOCK_SIZE;
+	}
+}
+
 static int
 ssh_aes_ctr(EVP_CIPHER_CTX *ctx, unsigned char *dest, const unsigned char *src, size_t len)
 {
 	struct ssh_aes_ctr_ctx *c;
-	unsigned int n = 0;
-	unsigned char buf[AES_BLOCK_SIZE];
 
 	if (len == 0)
 		return (1);
 	if ((c = EVP_CIPHER_CTX_get_app_data(ctx)) == NULL)
 		return (0);
 
-	while ((len--) > 0) {
-		if (n == 0) {
-			AES_encrypt(c->aes_counter, buf, &c->aes_ctx);
-			ssh_ctr_inc(c->aes_counter, AES_BLOCK_SIZE);
-		}
-		*(dest++) = *(src++) ^ buf[n];
-		n = (n + 1) % AES_BLOCK_SIZE;
-	}
+	ssh_ctr_crypt(ssh_aes_ctr_keystream, c, AES_BLOCK_SIZE, dest, src, len);
 	return (1);
 }
 
@@ -170,27 +248,32 @@ evp_aes_128_ctr(void)
 //============================================================================
 // Triple-DES
 //============================================================================
+static void
+ssh_des3_ctr_keystream(void *ctx, unsigned char *ks, size_t nblocks)
+{
+	struct ssh_des3_ctr_ctx *c = ctx;
+	DES_LONG tmp[2];
+
+	while (nblocks-- > 0) {
+		memcpy(tmp, c->des3_counter, DES_BLOCK_SIZE);
+		DES_encrypt3(tmp, &c->des3_ctx[0], &c->des3_ctx[1], &c->des3_ctx[2]);
+		memcpy(ks, tmp, DES_BLOCK_SIZE);
+		ssh_ctr_inc(c->des3_counter, DES_BLOCK_SIZE);
+		ks += DES_BLOCK_SIZE;
+	}
+}
+
 static int
 ssh_des3_ctr(EVP_CIPHER_CTX *ctx, unsigned char *dest, const unsigned char *src, size_t len)
 {
 	struct ssh_des3_ctr_ctx *c;
-	unsigned int n = 0;
-	unsigned char buf[DES_BLOCK_SIZE];
 
 	if (len == 0)
 		return (1);
 	if ((c = EVP_CIPHER_CTX_get_app_data(ctx)) == NULL)
 		return (0);
 
-	while ((len--) > 0) {
-		if (n == 0) {
-			memcpy(buf, (unsigned char *)(c->des3_counter), DES_BLOCK_SIZE);
-			DES_encrypt3((DES_LONG *)buf, &c->des3_ctx[0], &c->des3_ctx[1], &c->des3_ctx[2]);
-			ssh_ctr_inc(c->des3_counter, DES_BLOCK_SIZE);
-		}
-		*(dest++) = *(src++) ^ buf[n];
-		n = (n + 1) % DES_BLOCK_SIZE;
-	}
+	ssh_ctr_crypt(ssh_des3_ctr_keystream, c, DES_BLOCK_SIZE, dest, src, len);
 	return (1);
 }
 
@@ -268,44 +351,44 @@ evp_des3_ctr(void)
 //============================================================================
 // Blowfish
 //============================================================================
+/*
+ * JE^ 64bit ̃rbOGfBA
+ * / 32bit  BF_LONG ŕێ܂ܐi߁AubNƂ̃oCgϊȂ
+ */
+static void
+ssh_bf_ctr_keystream(void *ctx, unsigned char *ks, size_t nblocks)
+{
+	struct ssh_blowfish_ctr_ctx *c = ctx;
+	BF_LONG hi = ssh_ctr_get_u32(c->blowfish_counter);
+	BF_LONG lo = ssh_ctr_get_u32(c->blowfish_counter + 4);
+	BF_LONG tmp[2];
+
+	while (nblocks-- > 0) {
+		tmp[0] = hi;
+		tmp[1] = lo;
+		BF_encrypt(tmp, &c->blowfish_ctx);
+		ssh_ctr_put_u32(ks, (unsigned int)tmp[0]);
+		ssh_ctr_put_u32(ks + 4, (unsigned int)tmp[1]);
+		lo = (lo + 1) & 0xffffffff;
+		if (lo == 0)
+			hi = (hi + 1) & 0xffffffff;
+		ks += BF_BLOCK;
+	}
+	ssh_ctr_put_u32(c->blowfish_counter, (unsigned int)hi);
+	ssh_ctr_put_u32(c->blowfish_counter + 4, (unsigned int)lo);
+}
+
 static int
 ssh_bf_ctr(EVP_CIPHER_CTX *ctx, unsigned char *dest, const unsigned char *src, size_t len)
 {
 	struct ssh_blowfish_ctr_ctx *c;
-	unsigned int n = 0;
-	unsigned char buf[BF_BLOCK];
-	int i, j;
-	BF_LONG tmp[(BF_BLOCK + 3) / 4];
-	unsigned char *p;
 
 	if (len == 0)
 		return (1);
 	if ((c = EVP_CIPHER_CTX_get_app_data(ctx)) == NULL)
 		return (0);
 
-	while ((len--) > 0) {
-		if (n == 0) {
-			for (i = j = 0, p = c->blowfish_counter; i < BF_BLOCK; i += 4, j++) {
-				tmp[j]  = ((BF_LONG)*p++) << 24;
-				tmp[j] |= ((BF_LONG)*p++) << 16;
-				tmp[j] |= ((BF_LONG)*p++) << 8;
-				tmp[j] |= ((BF_LONG)*p++);
-			}
-
-			BF_encrypt(tmp, &c->blowfish_ctx);
-
-			for (i = j = 0, p = buf; i < BF_BLOCK; i += 4, j++) {
-				*p++ = (unsigned char)(tmp[j] >> 24);
-				*p++ = (unsigned char)(tmp[j] >> 16);
-				*p++ = (unsigned char)(tmp[j] >> 8);
-				*p++ = (unsigned char)tmp[j];
-			}
-
-			ssh_ctr_inc(c->blowfish_counter, BF_BLOCK);
-		}
-		*(dest++) = *(src++) ^ buf[n];
-		n = (n + 1) % BF_BLOCK;
-	}
+	ssh_ctr_crypt(ssh_bf_ctr_keystream, c, BF_BLOCK, dest, src, len);
 	return (1);
 }
 
@@ -381,44 +464,44 @@ evp_bf_ctr(void)
 //============================================================================
 // CAST-128
 //============================================================================
+/*
+ * JE^ 64bit ̃rbOGfBA
+ * / 32bit  CAST_LONG ŕێ܂ܐi߁AubNƂ̃oCgϊȂ
+ */
+static void
+ssh_cast5_ctr_keystream(void *ctx, unsigned char *ks, size_t nblocks)
+{
+	struct ssh_cast5_ctr_ctx *c = ctx;
+	CAST_LONG hi = ssh_ctr_get_u32(c->cast5_counter);
+	CAST_LONG lo = ssh_ctr_get_u32(c->cast5_counter + 4);
+	CAST_LONG tmp[2];
+
+	while (nblocks-- > 0) {
+		tmp[0] = hi;
+		tmp[1] = lo;
+		CAST_encrypt(tmp, &c->cast5_ctx);
+		ssh_ctr_put_u32(ks, (unsigned int)tmp[0]);
+		ssh_ctr_put_u32(ks + 4, (unsigned int)tmp[1]);
+		lo = (lo + 1) & 0xffffffff;
+		if (lo == 0)
+			hi = (hi + 1) & 0xffffffff;
+		ks += CAST_BLOCK;
+	}
+	ssh_ctr_put_u32(c->cast5_counter, (unsigned int)hi);
+	ssh_ctr_put_u32(c->cast5_counter + 4, (unsigned int)lo);
+}
+
 static int
 ssh_cast5_ctr(EVP_CIPHER_CTX *ctx, unsigned char *dest, const unsigned char *src, size_t len)
 {
 	struct ssh_cast5_ctr_ctx *c;
-	unsigned int n = 0;
-	unsigned char buf[CAST_BLOCK];
-	int i, j;
-	CAST_LONG tmp[(CAST_BLOCK + 3) / 4];
-	unsigned char *p;
 
 	if (len == 0)
 		return (1);
 	if ((c = EVP_CIPHER_CTX_get_app_data(ctx)) == NULL)
 		return (0);
 
-	while ((len--) > 0) {
-		if (n == 0) {
-			for (i = j = 0, p = c->cast5_counter; i < CAST_BLOCK; i += 4, j++) {
-				tmp[j]  = ((CAST_LONG)*p++) << 24;
-				tmp[j] |= ((CAST_LONG)*p++) << 16;
-				tmp[j] |= ((CAST_LONG)*p++) << 8;
-				tmp[j] |= ((CAST_LONG)*p++);
-			}
-
-			CAST_encrypt(tmp, &c->cast5_ctx);
-
-			for (i = j = 0, p = buf; i < CAST_BLOCK; i += 4, j++) {
-				*p++ = (unsigned char)(tmp[j] >> 24);
-				*p++ = (unsigned char)(tmp[j] >> 16);
-				*p++ = (unsigned char)(tmp[j] >> 8);
-				*p++ = (unsigned char)tmp[j];
-			}
-
-			ssh_ctr_inc(c->cast5_counter, CAST_BLOCK);
-		}
-		*(dest++) = *(src++) ^ buf[n];
-		n = (n + 1) % CAST_BLOCK;
-	}
+	ssh_ctr_crypt(ssh_cast5_ctr_keystream, c, CAST_BLOCK, dest, src, len);
 	return (1);
 }
 
@@ -494,26 +577,29 @@ evp_cast5_ctr(void)
 //============================================================================
 // Camellia
 //============================================================================
+static void
+ssh_camellia_ctr_keystream(void *ctx, unsigned char *ks, size_t nblocks)
+{
+	struct ssh_camellia_ctr_ctx *c = ctx;
+
+	while (nblocks-- > 0) {
+		Camellia_encrypt(c->camellia_counter, ks, &c->camellia_ctx);
+		ssh_ctr_inc(c->camellia_counter, CAMELLIA_BLOCK_SIZE);
+		ks += CAMELLIA_BLOCK_SIZE;
+	}
+}
+
 static int
 ssh_camellia_ctr(EVP_CIPHER_CTX *ctx, unsigned char *dest, const unsigned char *src, size_t len)
 {
 	struct ssh_camellia_ctr_ctx *c;
-	unsigned int n = 0;
-	unsigned char buf[CAMELLIA_BLOCK_SIZE];
 
 	if (len == 0)
 		return (1);
 	if ((c = EVP_CIPHER_CTX_get_app_data(ctx)) == NULL)
 		return (0);
 
-	while ((len--) > 0) {
-		if (n == 0) {
-			Camellia_encrypt(c->camellia_counter, buf, &c->camellia_ctx);
-			ssh_ctr_inc(c->camellia_counter, CAMELLIA_BLOCK_SIZE);
-		}
-		*(dest++) = *(src++) ^ buf[n];
-		n = (n + 1) % CAMELLIA_BLOCK_SIZE;
-	}
+	ssh_ctr_crypt(ssh_camellia_ctr_keystream, c, CAMELLIA_BLOCK_SIZE, dest, src, len);
 	return (1);
 }
 
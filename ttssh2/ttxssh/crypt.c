@@ -649,6 +649,38 @@ unsigned int CRYPT_get_encryption_block_size(PTInstVar pvar)
 	}
 }
 
+/*
+ * MAC ̌ݒ肵 HMAC_CTX 쐬
+ * NEWKEYS ňxĂсApPbgƂɂ HMAC_Init_ex(ctx, NULL, 0, NULL, NULL) 
+ * ݒ蒼 (ipad/opad vZς) ̏Ԃɖ߂Ďg񂷁B
+ * AEAD Í̏ꍇ (EVP_md_null) ͍쐬ȂB
+ */
+BOOL CRYPT_init_MAC(struct Mac *mac)
+{
+	CRYPT_free_MAC(mac);
+
+	if (mac->key == NULL || mac->md == NULL || EVP_MD_size(mac->md) <= 0)
+		return FALSE;
+
+	mac->ctx = HMAC_CTX_new();
+	if (mac->ctx == NULL)
+		return FALSE;
+
+	if (!HMAC_Init_ex(mac->ctx, mac->key, mac->key_len, mac->md, NULL)) {
+		CRYPT_free_MAC(mac);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+void CRYPT_free_MAC(struct Mac *mac)
+{
+	if (mac->ctx != NULL) {
+		HMAC_CTX_free(mac->ctx);
+		mac->ctx = NULL;
+	}
+}
+
 unsigned int CRYPT_get_receiver_MAC_size(PTInstVar pvar)
 {
 	struct Mac *mac;
@@ -672,7 +704,7 @@ unsigned int CRYPT_get_receiver_MAC_size(PTInstVar pvar)
 BOOL CRYPT_verify_receiver_MAC(PTInstVar pvar, uint32 sequence_number,
                                char *data, int len, char *MAC)
 {
-	HMAC_CTX *c = NULL;
+	HMAC_CTX *c;
 	unsigned char m[EVP_MAX_MD_SIZE];
 	unsigned char b[4];
 	struct Mac *mac;
@@ -694,16 +726,19 @@ BOOL CRYPT_verify_receiver_MAC(PTInstVar pvar, uint32 sequence_number,
 		goto error;
 	}
 
-	c = HMAC_CTX_new();
-	if (c == NULL)
+	c = mac->ctx;
+	if (c == NULL) {
+		logprintf(LOG_LEVEL_VERBOSE, "HMAC context is NULL(seq %lu len %d)", sequence_number, len);
 		goto error;
+	}
 
-	HMAC_Init_ex(c, mac->key, mac->key_len, mac->md, NULL);
+	// NEWKEYS Őݒ肵̂܂܏Ԃɖ߂
+	if (!HMAC_Init_ex(c, NULL, 0, NULL, NULL))
+		goto error;
 	set_uint32_MSBfirst(b, sequence_number);
 	HMAC_Update(c, b, sizeof(b));
 	HMAC_Update(c, data, len);
 	HMAC_Final(c, m, NULL);
-	// HMAC_cleanup()OpenSSL 1.1.0ō폜AHMAC_CTX_free()ɏW񂳂ꂽB
 
 	if (memcmp(m, MAC, mac->mac_len)) {
 		logprintf(LOG_LEVEL_VERBOSE, "HMAC key is not matched(seq %lu len %d)", sequence_number, len);
@@ -712,14 +747,9 @@ BOOL CRYPT_verify_receiver_MAC(PTInstVar pvar, uint32 sequence_number,
 		goto error;
 	}
 
-	HMAC_CTX_free(c);
-
 	return TRUE;
 
 error:
-	if (c)
-		HMAC_CTX_free(c);
-
 	return FALSE;
 }
 
@@ -742,7 +772,7 @@ unsigned int CRYPT_get_sender_MAC_size(PTInstVar pvar)
 BOOL CRYPT_build_sender_MAC(PTInstVar pvar, uint32 sequence_number,
                             char *data, int len, char *MAC)
 {
-	HMAC_CTX *c = NULL;
+	HMAC_CTX *c;
 	static u_char m[EVP_MAX_MD_SIZE];
 	u_char b[4];
 	struct Mac *mac;
@@ -752,23 +782,22 @@ BOOL CRYPT_build_sender_MAC(PTInstVar pvar, uint32 sequence_number,
 		if (mac == NULL || mac->enabled == 0)
 			return FALSE;
 
-		c = HMAC_CTX_new();
+		c = mac->ctx;
 		if (c == NULL)
 			return FALSE;
 
-		HMAC_Init_ex(c, mac->key, mac->key_len, mac->md, NULL);
+		// NEWKEYS Őݒ肵̂܂܏Ԃɖ߂
+		if (!HMAC_Init_ex(c, NULL, 0, NULL, NULL))
+			return FALSE;
 		set_uint32_MSBfirst(b, sequence_number);
 		HMAC_Update(c, b, sizeof(b));
 		HMAC_Update(c, data, len);
 		HMAC_Final(c, m, NULL);
-		// HMAC_cleanup()OpenSSL 1.1.0ō폜AHMAC_CTX_free()ɏW񂳂ꂽB
 
 		// 20oCgRs[
 		memcpy(MAC, m, pvar->ssh2_keys[MODE_OUT].mac.mac_len);
 	//	memcpy(MAC, m, sizeof(m));
 
-		HMAC_CTX_free(c);
-
 		return TRUE;
 	}
 
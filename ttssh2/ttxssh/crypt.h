@@ -131,6 +131,9 @@ BOOL CRYPT_start_encryption(PTInstVar pvar, int sender_flag, int receiver_flag);
 int CRYPT_generate_RSA_challenge_response(PTInstVar pvar, unsigned char *challenge,
                                            int challenge_len, unsigned char *response);
 
+struct Mac;
+BOOL CRYPT_init_MAC(struct Mac *mac);
+void CRYPT_free_MAC(struct Mac *mac);
 unsigned int CRYPT_get_receiver_MAC_size(PTInstVar pvar);
 BOOL CRYPT_verify_receiver_MAC(PTInstVar pvar, uint32 sequence_number,
   char *data, int len, char *MAC);
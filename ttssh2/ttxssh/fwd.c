@@ -811,6 +811,7 @@ void FWD_suspend_resume_local_connection(PTInstVar pvar, Channel_t* c, int notif
 	int channel_num;
 	FWDChannel* channel;
 	int changed = 0;
+	size_t high_water_mark;
 
 	// |[g]̖gp͈ȉ̃t[sȂB
 	if (c->type != TYPE_PORTFWD) {
@@ -819,10 +820,14 @@ void FWD_suspend_resume_local_connection(PTInstVar pvar, Channel_t* c, int notif
 
 	channel_num = c->local_num;
 	channel = pvar->fwd_state.channels + channel_num;
+	high_water_mark = pvar->settings.ChannelBufferSize;
+	if (high_water_mark == 0) {
+		high_water_mark = FWD_HIGH_WATER_MARK;
+	}
 
 	if (notify) {
 		// recvĊJ邩f
-		if (c->bufchain_amount <= FWD_LOW_WATER_MARK) {
+		if (bytequeue_len(&c->bufchain) <= high_water_mark / FWD_LOW_WATER_MARK_RATIO) {
 			// ̂ōĊJ
 			c->bufchain_recv_suspended = FALSE;
 
@@ -837,7 +842,7 @@ void FWD_suspend_resume_local_connection(PTInstVar pvar, Channel_t* c, int notif
 
 	} else {
 		// recv~邩f
-		if (c->bufchain_amount >= FWD_HIGH_WATER_MARK) {
+		if (bytequeue_len(&c->bufchain) >= high_water_mark) {
 			// 𒴂̂Œ~
 			c->bufchain_recv_suspended = TRUE;
 			changed = 1;
@@ -848,7 +853,7 @@ void FWD_suspend_resume_local_connection(PTInstVar pvar, Channel_t* c, int notif
 		"%s: Local channel#%d recv has been `%s' for flow control(buffer size %lu, recv %s).",
 		__FUNCTION__, channel_num,
 		c->bufchain_recv_suspended ? "disabled" : "enabled",
-		c->bufchain_amount,
+		(unsigned long)bytequeue_len(&c->bufchain),
 		changed ? "changed" : ""
 		);
 
@@ -36,9 +36,11 @@ See LICENSE.TXT for the license.
 #define __FWD_H
 
 // |[g]ɂt[臒l
-// Kp Channel_t.bufchain_amount
+// Kp Channel_t.bufchain ̃oCg
+//    TS_SSH.ChannelBufferSize ( FWD_HIGH_WATER_MARK)
+//    FWD_LOW_WATER_MARK_RATIO  1 ܂ŌMĊJ
 #define FWD_HIGH_WATER_MARK (1 * 1024 * 1024)  // 1MB
-#define FWD_LOW_WATER_MARK (0)  // 0MB
+#define FWD_LOW_WATER_MARK_RATIO 2
 
 #define FWD_REMOTE_CONNECTED  0x01
 #define FWD_LOCAL_CONNECTED   0x02
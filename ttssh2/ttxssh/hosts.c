@@ -38,6 +38,7 @@ See LICENSE.TXT for the license.
 #include "ssh.h"
 #include "key.h"
 #include "hosts.h"
+#include "hostsindex.h"
 #include "dns.h"
 #include "dlglib.h"
 #include "compat_win.h"
@@ -69,6 +70,90 @@ See LICENSE.TXT for the license.
 // BASE64\ił'='͊܂܂ĂȂj
 static char base64[] ="ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
 
+//
+// known_hostst@C̓eƍ̃LbV
+// ڑ̂тɃt@Cǂݍŉ͂ȂĂނ悤ɁAvZX̊ԕێB
+// t@C̍XVTCYςĂǂݒB
+//
+typedef struct hosts_cache {
+	wchar_t *filename;
+	__time64_t mtime;
+	__int64 size;
+	char *data;
+	hostsindex_t *index;
+	struct hosts_cache *next;
+} hosts_cache_t;
+
+static hosts_cache_t *hosts_cache = NULL;
+
+static void hosts_cache_free_entry(hosts_cache_t *p)
+{
+	free(p->filename);
+	free(p->data);
+	hostsindex_free(p->index);
+	free(p);
+}
+
+static hosts_cache_t *hosts_cache_find(const wchar_t *filename)
+{
+	hosts_cache_t **pp, *p;
+	struct __stat64 st;
+
+	for (pp = &hosts_cache; (p = *pp) != NULL; pp = &p->next) {
+		if (_wcsicmp(p->filename, filename) == 0) {
+			break;
+		}
+	}
+	if (p == NULL) {
+		return NULL;
+	}
+
+	if (_wstat64(filename, &st) == 0 && st.st_mtime == p->mtime && st.st_size == p->size) {
+		return p;
+	}
+
+	// t@CύXĂ̂Ŏ̂Ă
+	*pp = p->next;
+	hosts_cache_free_entry(p);
+	return NULL;
+}
+
+// ǂݍ񂾃t@C̍ăLbVɓB
+//  data ̓LbV̂̂ɂȂB
+static hostsindex_t *hosts_cache_add(const wchar_t *filename, const struct __stat64 *st, char *data)
+{
+	hosts_cache_t *p;
+
+	p = calloc(1, sizeof(hosts_cache_t));
+	if (p == NULL) {
+		return NULL;
+	}
+	p->filename = _wcsdup(filename);
+	p->index = hostsindex_build(data);
+	if (p->filename == NULL || p->index == NULL) {
+		free(p->filename);
+		hostsindex_free(p->index);
+		free(p);
+		return NULL;
+	}
+	p->mtime = st->st_mtime;
+	p->size = st->st_size;
+	p->data = data;
+	p->next = hosts_cache;
+	hosts_cache = p;
+	return p->index;
+}
+
+// known_hostst@CĂ
+static void hosts_cache_clear(void)
+{
+	while (hosts_cache != NULL) {
+		hosts_cache_t *next = hosts_cache->next;
+		hosts_cache_free_entry(hosts_cache);
+		hosts_cache = next;
+	}
+}
+
 
 static wchar_t **parse_multi_path(wchar_t *buf)
 {
@@ -129,6 +214,7 @@ void HOSTS_open(PTInstVar pvar)
 
 //
 // known_hostst@C̓eׂ pvar->hosts_state.file_data ֓ǂݍ
+// LbVɂ΂gAȂΓǂݍōB
 //
 static int begin_read_file(PTInstVar pvar, wchar_t *name,
                            int suppress_errors)
@@ -137,11 +223,23 @@ static int begin_read_file(PTInstVar pvar, wchar_t *name,
 	int length;
 	int amount_read;
 	wchar_t *bufW;
+	hosts_cache_t *cache;
+	struct __stat64 st;
+
+	pvar->hosts_state.file_index = NULL;
 
 	bufW = get_home_dir_relative_nameW(name);
+	cache = hosts_cache_find(bufW);
+	if (cache != NULL) {
+		free(bufW);
+		pvar->hosts_state.file_data = cache->data;
+		pvar->hosts_state.file_index = cache->index;
+		return 1;
+	}
+
 	fd = _wopen(bufW, _O_RDONLY | _O_SEQUENTIAL | _O_BINARY);
-	free(bufW);
 	if (fd == -1) {
+		free(bufW);
 		if (!suppress_errors) {
 			if (errno == ENOENT) {
 				UTIL_get_lang_msg("MSG_HOSTS_READ_ENOENT_ERROR", pvar,
@@ -157,6 +255,9 @@ static int begin_read_file(PTInstVar pvar, wchar_t *name,
 		return 0;
 	}
 
+	if (_fstat64(fd, &st) != 0) {
+		st.st_size = -1;
+	}
 	length = (int) _lseek(fd, 0, SEEK_END);
 	_lseek(fd, 0, SEEK_SET);
 
@@ -169,6 +270,7 @@ static int begin_read_file(PTInstVar pvar, wchar_t *name,
 				notify_nonfatal_error(pvar, pvar->UIMsg);
 			}
 			_close(fd);
+			free(bufW);
 			return 0;
 		}
 	} else {
@@ -178,6 +280,7 @@ static int begin_read_file(PTInstVar pvar, wchar_t *name,
 			notify_nonfatal_error(pvar, pvar->UIMsg);
 		}
 		_close(fd);
+		free(bufW);
 		return 0;
 	}
 
@@ -194,16 +297,27 @@ static int begin_read_file(PTInstVar pvar, wchar_t *name,
 		}
 		free(pvar->hosts_state.file_data);
 		pvar->hosts_state.file_data = NULL;
+		free(bufW);
 		return 0;
-	} else {
-		return 1;
 	}
+
+	// ăLbVɓBȂƂ́A܂łǂSsǂށB
+	if (st.st_size == length) {
+		pvar->hosts_state.file_index =
+			hosts_cache_add(bufW, &st, pvar->hosts_state.file_data);
+	}
+	free(bufW);
+	return 1;
 }
 
 static int end_read_file(PTInstVar pvar, int suppress_errors)
 {
-	free(pvar->hosts_state.file_data);
+	// Ƃ́Ae̓LbVĂ
+	if (pvar->hosts_state.file_index == NULL) {
+		free(pvar->hosts_state.file_data);
+	}
 	pvar->hosts_state.file_data = NULL;
+	pvar->hosts_state.file_index = NULL;
 	return 1;
 }
 
@@ -211,6 +325,8 @@ static int begin_read_host_files(PTInstVar pvar, int suppress_errors)
 {
 	pvar->hosts_state.file_num = 0;
 	pvar->hosts_state.file_data = NULL;
+	pvar->hosts_state.file_index = NULL;
+	pvar->hosts_state.file_line_num = -1;
 	return 1;
 }
 
@@ -413,6 +529,11 @@ static int check_host_key(PTInstVar pvar, char *hostname,
 			if (host_matched && keyfile_port == tcpport) {
 				return index + eat_to_end_of_line(data + index);
 			}
+		} else if (data[index] == '|') {
+			// nbVꂽzXg̓|[gԍ܂߂ďƍ
+			if (hostsindex_match_hashed(data + index, hostname, tcpport)) {
+				matched = 1;
+			}
 		} else {
 			bracketed = data[index] == '[';
 			if (bracketed) {
@@ -581,17 +702,43 @@ static int read_host_key(PTInstVar pvar,
 						if (begin_read_file(pvar, filename, suppress_errors)) {
 							pvar->hosts_state.file_data_index = 0;
 							keep_going = 0;
+
+							// ΁A̍s𒲂ׂ
+							pvar->hosts_state.file_line_num = -1;
+							if (!return_always && pvar->hosts_state.file_index != NULL) {
+								pvar->hosts_state.file_line_num =
+									hostsindex_lookup(pvar->hosts_state.file_index, hostname, tcpport,
+									                  &pvar->hosts_state.file_lines);
+								pvar->hosts_state.file_line_pos = 0;
+							}
 						}
 					}
 				}
 			} while (keep_going);
 		}
 
-		pvar->hosts_state.file_data_index +=
-			check_host_key(pvar, hostname, tcpport,
-			               pvar->hosts_state.file_data +
-			               pvar->hosts_state.file_data_index,
-			               key);
+		if (pvar->hosts_state.file_line_num >= 0) {
+			if (pvar->hosts_state.file_line_pos < pvar->hosts_state.file_line_num) {
+				int line = pvar->hosts_state.file_lines[pvar->hosts_state.file_line_pos++];
+
+				pvar->hosts_state.file_data_index = line +
+					check_host_key(pvar, hostname, tcpport,
+					               pvar->hosts_state.file_data + line,
+					               key);
+			}
+			else {
+				// ₪Ȃ̂ŁÃt@C͍Ō܂œǂ񂾂Ƃɂ
+				pvar->hosts_state.file_data_index +=
+					strlen(pvar->hosts_state.file_data + pvar->hosts_state.file_data_index);
+			}
+		}
+		else {
+			pvar->hosts_state.file_data_index +=
+				check_host_key(pvar, hostname, tcpport,
+				               pvar->hosts_state.file_data +
+				               pvar->hosts_state.file_data_index,
+				               key);
+		}
 
 		if (!return_always) {
 			// LȃL[܂
@@ -688,6 +835,12 @@ static int parse_hostkey_file(PTInstVar pvar, char *hostname,
 				return index + eat_to_end_of_line(data + index);
 			}
 		}
+		else if (data[index] == '|') {
+			// nbVꂽzXg̓|[gԍ܂߂ďƍ
+			if (hostsindex_match_hashed(data + index, hostname, tcpport)) {
+				matched = 1;
+			}
+		}
 		else {
 			bracketed = data[index] == '[';
 			if (bracketed) {
@@ -801,6 +954,8 @@ int HOSTS_hostkey_foreach(PTInstVar pvar, hostkeys_foreach_fn *callback, void *c
 	wchar_t *filename;
 	char *hostname;
 	Key *key;
+	const int *lines;
+	int i, num = -1;
 
 	if (!begin_read_host_files(pvar, 1)) {
 		goto error;
@@ -824,9 +979,26 @@ int HOSTS_hostkey_foreach(PTInstVar pvar, hostkeys_foreach_fn *callback, void *c
 	hostname = pvar->ssh_state.hostname;
 	tcpport = pvar->ssh_state.tcpport;
 
+	// ΁A̍s𒲂ׂ
+	if (pvar->hosts_state.file_index != NULL) {
+		num = hostsindex_lookup(pvar->hosts_state.file_index, hostname, tcpport, &lines);
+	}
+	for (i = 0; i < num; i++) {
+		key = NULL;
+
+		parse_hostkey_file(pvar, hostname, tcpport,
+			pvar->hosts_state.file_data + lines[i],
+			&key);
+
+		if (key != NULL) {
+			if (callback(key, ctx) == 0)
+				key_free(key);
+		}
+	}
+
 	// known_hostst@C̓eׂ pvar->hosts_state.file_data ɓǂݍ܂ĂB
 	//  \0 B
-	while (pvar->hosts_state.file_data[pvar->hosts_state.file_data_index] != 0) {
+	while (num < 0 && pvar->hosts_state.file_data[pvar->hosts_state.file_data_index] != 0) {
 		key = NULL;
 
 		pvar->hosts_state.file_data_index +=
@@ -1280,6 +1452,7 @@ static void add_host_key(PTInstVar pvar)
 		amount_written = _write(fd, keydata, length);
 		free(keydata);
 		close_result = _close(fd);
+		hosts_cache_clear();
 
 		if (amount_written != length || close_result == -1) {
 			UTIL_get_lang_msg("MSG_HOSTS_WRITE_ERROR", pvar,
@@ -1341,6 +1514,7 @@ void HOSTS_add_host_key(PTInstVar pvar, Key *key)
 		amount_written = _write(fd, keydata, length);
 		free(keydata);
 		close_result = _close(fd);
+		hosts_cache_clear();
 
 		if (amount_written != length || close_result == -1) {
 			UTIL_get_lang_msg("MSG_HOSTS_WRITE_ERROR", pvar,
@@ -1459,6 +1633,11 @@ static void delete_different_key(PTInstVar pvar)
 							break;
 						}
 					}
+					else if (data[host_index] == '|') {
+						if (hostsindex_match_hashed(data + host_index, pvar->ssh_state.hostname, pvar->ssh_state.tcpport)) {
+							matched = 1;
+						}
+					}
 					else {
 						bracketed = data[host_index] == '[';
 						if (bracketed) {
@@ -1543,6 +1722,7 @@ static void delete_different_key(PTInstVar pvar)
 
 		amount_written = _write(fd, newfiledata, newFilePos);
 		close_result = _close(fd);
+		hosts_cache_clear();
 		if (amount_written != newFilePos || close_result == -1) {
 			UTIL_get_lang_msg("MSG_HOSTS_WRITE_ERROR", pvar,
 				"An error occurred while trying to write the host key.\n"
@@ -1670,6 +1850,11 @@ void HOSTS_delete_all_hostkeys(PTInstVar pvar)
 							break;
 						}
 					}
+					else if (data[host_index] == '|') {
+						if (hostsindex_match_hashed(data + host_index, pvar->ssh_state.hostname, pvar->ssh_state.tcpport)) {
+							matched = 1;
+						}
+					}
 					else {
 						bracketed = data[host_index] == '[';
 						if (bracketed) {
@@ -1751,6 +1936,7 @@ void HOSTS_delete_all_hostkeys(PTInstVar pvar)
 
 		amount_written = _write(fd, newfiledata, newFilePos);
 		close_result = _close(fd);
+		hosts_cache_clear();
 		if (amount_written != newFilePos || close_result == -1) {
 			UTIL_get_lang_msg("MSG_HOSTS_WRITE_ERROR", pvar,
 				"An error occurred while trying to write the host key.\n"
@@ -2411,6 +2597,12 @@ void HOSTS_notify_closing_on_exit(PTInstVar pvar)
 	}
 }
 
+// LbVĂ known_hosts t@C̓e
+void HOSTS_free_cache(void)
+{
+	hosts_cache_clear();
+}
+
 void HOSTS_end(PTInstVar pvar)
 {
 	int i;
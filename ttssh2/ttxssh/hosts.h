@@ -52,6 +52,10 @@ typedef struct {
   wchar_t **file_names;
   int file_data_index;
   char *file_data;  // known_hostst@C̓eׂĊi[
+  struct hostsindex *file_index;  // file_data ̍ (NULL ̂Ƃ file_data ŉ)
+  const int *file_lines;  // Ō̍s
+  int file_line_num;      // -1 ̂Ƃ͍g킸ɑSsǂ
+  int file_line_pos;
 
   HWND hosts_dialog;
 } HOSTSState;
@@ -73,6 +77,7 @@ void HOSTS_do_different_type_key_dialog(HWND wnd, PTInstVar pvar);
 void HOSTS_notify_disconnecting(PTInstVar pvar);
 void HOSTS_notify_closing_on_exit(PTInstVar pvar);
 void HOSTS_end(PTInstVar pvar);
+void HOSTS_free_cache(void);
 
 int HOSTS_compare_public_key(Key *src, Key *key);
 int HOSTS_hostkey_foreach(PTInstVar pvar, hostkeys_foreach_fn *callback, void *ctx);
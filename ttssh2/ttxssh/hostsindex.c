@@ -0,0 +1,535 @@
+/*
+ * Copyright (C) 2026- TeraTerm Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ttxssh.h"
+#include "matcher.h"
+#include "hostsindex.h"
+
+#include <string.h>
+
+#include <openssl/sha.h>
+
+#define HOSTSINDEX_HASH_LEN 20      // SHA1
+#define HOSTSINDEX_HASH_B64_LEN 28  // HOSTSINDEX_HASH_LEN oCg BASE64 ɂ
+#define HOSTSINDEX_MEMO_NUM 8       // oĂʂ̐
+
+// ChJ[h܂܂ȂzXg
+typedef struct {
+	unsigned int hash;
+	int name;               // data ̃zXg̈ʒu
+	int name_len;
+	unsigned short port;
+	int line;               // data ̍s̈ʒu
+	int next;               // oPbg̎̃Gg (-1 ŏI)
+} hostsindex_name_t;
+
+// nbVꂽzXg
+// zXg HMAC-SHA1(salt, zXg) ɂȂĂB
+// salt Ō܂镔 (ipad, opad  SHA1 ɒʂ) ɌvZĂA
+//  SHA1 ̃ubN 2 񕪂ŏƍB
+typedef struct {
+	SHA_LONG ipad[5];
+	SHA_LONG opad[5];
+	unsigned char hash[HOSTSINDEX_HASH_LEN];
+	int line;
+} hostsindex_hashed_t;
+
+// 
+typedef struct {
+	char *hostname;
+	unsigned short tcpport;
+	int *lines;
+	int num;
+} hostsindex_memo_t;
+
+struct hostsindex {
+	const char *data;
+
+	hostsindex_name_t *names;
+	int name_num, name_max;
+	int *buckets;
+	unsigned int bucket_mask;
+
+	hostsindex_hashed_t *hashed;
+	int hashed_num, hashed_max;
+
+	int *others;            // ɂłȂGg̍s
+	int other_num, other_max;
+
+	hostsindex_memo_t memo[HOSTSINDEX_MEMO_NUM];
+	int memo_next;
+};
+
+static unsigned int hash_name(const char *name, int len, unsigned short port)
+{
+	unsigned int h = 2166136261U;  // FNV-1a
+	int i;
+
+	for (i = 0; i < len; i++) {
+		h = (h ^ (unsigned char)name[i]) * 16777619U;
+	}
+	h = (h ^ port) * 16777619U;
+	return h;
+}
+
+// z *p ̗vf1₹悤ɂ
+static int grow_array(void **p, int *max, int num, size_t size)
+{
+	void *n;
+	int new_max;
+
+	if (num < *max) {
+		return 1;
+	}
+	new_max = *max == 0 ? 64 : *max * 2;
+	n = realloc(*p, new_max * size);
+	if (n == NULL) {
+		return 0;
+	}
+	*p = n;
+	*max = new_max;
+	return 1;
+}
+
+// BASE64  HOSTSINDEX_HASH_LEN oCgɂȂ镶fR[h
+static int decode_hash(const char *src, int len, unsigned char *dst)
+{
+	char buf[HOSTSINDEX_HASH_B64_LEN + 1];
+	char bin[HOSTSINDEX_HASH_LEN + 1];  // b64decode() ͖ \0 ̂1oCg
+
+	if (len != HOSTSINDEX_HASH_B64_LEN) {
+		return 0;
+	}
+	memcpy(buf, src, len);
+	buf[len] = '\0';
+	if (b64decode(bin, sizeof(bin), buf) != HOSTSINDEX_HASH_LEN) {
+		return 0;
+	}
+	memcpy(dst, bin, HOSTSINDEX_HASH_LEN);
+	return 1;
+}
+
+// salt ^ pad  1 ubN SHA1 ɒʂ
+static void sha1_midstate(const unsigned char *salt, unsigned char pad, SHA_LONG *h)
+{
+	unsigned char k[SHA_CBLOCK];
+	SHA_CTX ctx;
+	int i;
+
+	memset(k, pad, sizeof(k));
+	for (i = 0; i < HOSTSINDEX_HASH_LEN; i++) {
+		k[i] ^= salt[i];
+	}
+	SHA1_Init(&ctx);
+	SHA1_Update(&ctx, k, sizeof(k));
+	h[0] = ctx.h0;
+	h[1] = ctx.h1;
+	h[2] = ctx.h2;
+	h[3] = ctx.h3;
+	h[4] = ctx.h4;
+}
+
+// sha1_midstate() ̏Ԃ SHA1 𑱂
+static void sha1_resume(SHA_CTX *ctx, const SHA_LONG *h)
+{
+	SHA1_Init(ctx);
+	ctx->h0 = h[0];
+	ctx->h1 = h[1];
+	ctx->h2 = h[2];
+	ctx->h3 = h[3];
+	ctx->h4 = h[4];
+	ctx->Nl = SHA_CBLOCK * 8;
+}
+
+// HMAC-SHA1(salt, name)
+static void hash_host(const hostsindex_hashed_t *e, const char *name, size_t len, unsigned char *out)
+{
+	unsigned char inner[SHA_DIGEST_LENGTH];
+	SHA_CTX ctx;
+
+	sha1_resume(&ctx, e->ipad);
+	SHA1_Update(&ctx, name, len);
+	SHA1_Final(inner, &ctx);
+	sha1_resume(&ctx, e->opad);
+	SHA1_Update(&ctx, inner, sizeof(inner));
+	SHA1_Final(out, &ctx);
+}
+
+// "|1|salt|hash" ͂
+static int parse_hashed(const char *p, int len, hostsindex_hashed_t *e)
+{
+	unsigned char salt[HOSTSINDEX_HASH_LEN];
+	const char *sep;
+
+	if (len < 3 || strncmp(p, "|1|", 3) != 0) {
+		return 0;
+	}
+	p += 3;
+	len -= 3;
+	sep = memchr(p, '|', len);
+	if (sep == NULL) {
+		return 0;
+	}
+	if (!decode_hash(p, (int)(sep - p), salt) ||
+	    !decode_hash(sep + 1, len - (int)(sep - p) - 1, e->hash)) {
+		return 0;
+	}
+	sha1_midstate(salt, 0x36, e->ipad);
+	sha1_midstate(salt, 0x5c, e->opad);
+	return 1;
+}
+
+// nbVÕzXgB|[g22ȊO "[host]:port" ̌`ɂȂB
+static char *hashed_host_name(const char *hostname, unsigned short tcpport)
+{
+	char *name;
+	size_t len = strlen(hostname) + 10;
+
+	name = malloc(len);
+	if (name == NULL) {
+		return NULL;
+	}
+	if (tcpport == 22) {
+		_snprintf_s(name, len, _TRUNCATE, "%s", hostname);
+	} else {
+		_snprintf_s(name, len, _TRUNCATE, "[%s]:%u", hostname, tcpport);
+	}
+	return name;
+}
+
+static int add_other(hostsindex_t *idx, int line)
+{
+	if (idx->other_num > 0 && idx->others[idx->other_num - 1] == line) {
+		return 1;
+	}
+	if (!grow_array((void **)&idx->others, &idx->other_max, idx->other_num, sizeof(int))) {
+		return 0;
+	}
+	idx->others[idx->other_num++] = line;
+	return 1;
+}
+
+// 1̃zXgp^[ɉ
+static int add_pattern(hostsindex_t *idx, int line, int start, int len)
+{
+	const char *p = idx->data + start;
+	hostsindex_name_t *n;
+	unsigned short port = 22;
+	int i;
+
+	if (p[0] == '|') {
+		hostsindex_hashed_t *h;
+
+		if (!grow_array((void **)&idx->hashed, &idx->hashed_max, idx->hashed_num, sizeof(hostsindex_hashed_t))) {
+			return 0;
+		}
+		h = &idx->hashed[idx->hashed_num];
+		if (!parse_hashed(p, len, h)) {
+			return add_other(idx, line);
+		}
+		h->line = line;
+		idx->hashed_num++;
+		return 1;
+	}
+
+	for (i = 0; i < len; i++) {
+		if (p[i] == '*' || p[i] == '?') {
+			return add_other(idx, line);
+		}
+	}
+
+	if (p[0] == '[') {
+		// [host]:port
+		for (i = 1; i + 1 < len; i++) {
+			if (p[i] == ']' && p[i + 1] == ':') {
+				break;
+			}
+		}
+		if (i + 1 >= len || i == 1) {
+			return add_other(idx, line);
+		}
+		port = (unsigned short)atoi(p + i + 2);
+		start++;
+		len = i - 1;
+	}
+
+	if (!grow_array((void **)&idx->names, &idx->name_max, idx->name_num, sizeof(hostsindex_name_t))) {
+		return 0;
+	}
+	n = &idx->names[idx->name_num++];
+	n->hash = hash_name(idx->data + start, len, port);
+	n->name = start;
+	n->name_len = len;
+	n->port = port;
+	n->line = line;
+	n->next = -1;
+	return 1;
+}
+
+static int build_buckets(hostsindex_t *idx)
+{
+	unsigned int size = 64;
+	int i;
+
+	while (size < (unsigned int)idx->name_num * 2) {
+		size *= 2;
+	}
+	idx->buckets = malloc(size * sizeof(int));
+	if (idx->buckets == NULL) {
+		return 0;
+	}
+	memset(idx->buckets, 0xff, size * sizeof(int));
+	idx->bucket_mask = size - 1;
+
+	// 납āA`FCt@C̏ɂȂ悤ɂ
+	for (i = idx->name_num - 1; i >= 0; i--) {
+		hostsindex_name_t *n = &idx->names[i];
+		unsigned int b = n->hash & idx->bucket_mask;
+		n->next = idx->buckets[b];
+		idx->buckets[b] = i;
+	}
+	return 1;
+}
+
+//
+// known_hosts t@C̓e data B
+// data ͍܂ŕێĂƁB
+//
+hostsindex_t *hostsindex_build(const char *data)
+{
+	hostsindex_t *idx;
+	int index = 0;
+
+	idx = calloc(1, sizeof(hostsindex_t));
+	if (idx == NULL) {
+		return NULL;
+	}
+	idx->data = data;
+
+	while (data[index] != 0) {
+		int line = index;
+		int ch;
+
+		while ((ch = data[index]) == ' ' || ch == '\t') {
+			index++;
+		}
+
+		if (data[index] != '#') {
+			for (;;) {
+				int start = index;
+
+				while (is_pattern_char(data[index])) {
+					index++;
+				}
+				// ےp^[ł͈vȂ̂ōɓȂ
+				if (index > start && data[start] != '!') {
+					if (!add_pattern(idx, line, start, index - start)) {
+						hostsindex_free(idx);
+						return NULL;
+					}
+				}
+				if (data[index] != ',') {
+					break;
+				}
+				index++;
+			}
+		}
+
+		while ((ch = data[index]) != '\n' && ch != '\r' && ch != 0) {
+			index++;
+		}
+		while ((ch = data[index]) == '\n' || ch == '\r') {
+			index++;
+		}
+	}
+
+	if (!build_buckets(idx)) {
+		hostsindex_free(idx);
+		return NULL;
+	}
+
+	return idx;
+}
+
+void hostsindex_free(hostsindex_t *idx)
+{
+	int i;
+
+	if (idx == NULL) {
+		return;
+	}
+	for (i = 0; i < HOSTSINDEX_MEMO_NUM; i++) {
+		free(idx->memo[i].hostname);
+		free(idx->memo[i].lines);
+	}
+	free(idx->names);
+	free(idx->buckets);
+	free(idx->hashed);
+	free(idx->others);
+	free(idx);
+}
+
+static int compare_line(const void *a, const void *b)
+{
+	int x = *(const int *)a, y = *(const int *)b;
+	return x < y ? -1 : x > y;
+}
+
+static int add_line(int **lines, int *num, int *max, int line)
+{
+	if (!grow_array((void **)lines, max, *num, sizeof(int))) {
+		return 0;
+	}
+	(*lines)[(*num)++] = line;
+	return 1;
+}
+
+//
+// hostname:tcpport ̃GǧɂȂsAt@C̏ɕԂB
+// *lines ͎ hostsindex_lookup() ܂ł͗LB
+//
+// return: ̍s (G[̂Ƃ -1)
+//
+int hostsindex_lookup(hostsindex_t *idx, const char *hostname, unsigned short tcpport, const int **lines)
+{
+	hostsindex_memo_t *memo;
+	int *result = NULL;
+	int num = 0, max = 0;
+	int len = (int)strlen(hostname);
+	int i;
+
+	for (i = 0; i < HOSTSINDEX_MEMO_NUM; i++) {
+		memo = &idx->memo[i];
+		if (memo->hostname != NULL && memo->tcpport == tcpport && strcmp(memo->hostname, hostname) == 0) {
+			*lines = memo->lines;
+			return memo->num;
+		}
+	}
+
+	{
+		unsigned int h = hash_name(hostname, len, tcpport);
+
+		for (i = idx->buckets[h & idx->bucket_mask]; i >= 0; i = idx->names[i].next) {
+			hostsindex_name_t *n = &idx->names[i];
+
+			if (n->hash == h && n->port == tcpport && n->name_len == len &&
+			    memcmp(idx->data + n->name, hostname, len) == 0) {
+				if (!add_line(&result, &num, &max, n->line)) {
+					goto error;
+				}
+			}
+		}
+	}
+
+	if (idx->hashed_num > 0) {
+		char *name = hashed_host_name(hostname, tcpport);
+		size_t name_len;
+		unsigned char out[HOSTSINDEX_HASH_LEN];
+		int ok = (name != NULL);
+
+		name_len = ok ? strlen(name) : 0;
+		for (i = 0; ok && i < idx->hashed_num; i++) {
+			hostsindex_hashed_t *e = &idx->hashed[i];
+
+			hash_host(e, name, name_len, out);
+			if (memcmp(out, e->hash, HOSTSINDEX_HASH_LEN) == 0) {
+				ok = add_line(&result, &num, &max, e->line);
+			}
+		}
+		free(name);
+		if (!ok) {
+			goto error;
+		}
+	}
+
+	for (i = 0; i < idx->other_num; i++) {
+		if (!add_line(&result, &num, &max, idx->others[i])) {
+			goto error;
+		}
+	}
+
+	// t@C̏ɕׁAs1ɂ
+	if (num > 1) {
+		int j = 0;
+
+		qsort(result, num, sizeof(int), compare_line);
+		for (i = 1; i < num; i++) {
+			if (result[i] != result[j]) {
+				result[++j] = result[i];
+			}
+		}
+		num = j + 1;
+	}
+
+	memo = &idx->memo[idx->memo_next];
+	idx->memo_next = (idx->memo_next + 1) % HOSTSINDEX_MEMO_NUM;
+	free(memo->hostname);
+	free(memo->lines);
+	memo->hostname = _strdup(hostname);
+	memo->tcpport = tcpport;
+	memo->lines = result;
+	memo->num = num;
+	if (memo->hostname == NULL) {
+		memo->lines = NULL;
+		goto error;
+	}
+
+	*lines = result;
+	return num;
+
+error:
+	free(result);
+	return -1;
+}
+
+//
+// nbVꂽzXg̃p^[ (|1|salt|hash)  hostname:tcpport ƈv邩
+//
+int hostsindex_match_hashed(const char *pattern, const char *hostname, unsigned short tcpport)
+{
+	hostsindex_hashed_t e;
+	unsigned char out[HOSTSINDEX_HASH_LEN];
+	char *name;
+	int len = 0;
+	int matched = 0;
+
+	while (is_pattern_char(pattern[len])) {
+		len++;
+	}
+	if (!parse_hashed(pattern, len, &e)) {
+		return 0;
+	}
+
+	name = hashed_host_name(hostname, tcpport);
+	if (name != NULL) {
+		hash_host(&e, name, strlen(name), out);
+		matched = memcmp(out, e.hash, HOSTSINDEX_HASH_LEN) == 0;
+	}
+	free(name);
+	return matched;
+}
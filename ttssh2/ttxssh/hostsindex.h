@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2026- TeraTerm Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * known_hosts ̍
+ *
+ * known_hosts t@C̓eAzXgƃ|[gԍŃGg̍s
+ * 悤ɂB
+ *   - ChJ[h܂܂ȂzXg̓nbV\ɓ
+ *   - nbVꂽzXg (|1|salt|hash) ́Asalt 猈܂ HMAC 
+ *     ȑԂ hash zɓA͎čvZŏƍ
+ *   - ChJ[h܂ނ̂ȂǁAɂłȂGg̍s
+ *     ̂тɌƂĕԂ
+ * ʂ͌̍sŁAŏIIȏƍ(ےp^[⌮̓ǂݍ)
+ * ]ǂs̉͂ōsB
+ * zXǧʂ͍̒ɊoĂA͌vZȂB
+ */
+
+typedef struct hostsindex hostsindex_t;
+
+hostsindex_t *hostsindex_build(const char *data);
+void hostsindex_free(hostsindex_t *idx);
+int hostsindex_lookup(hostsindex_t *idx, const char *hostname, unsigned short tcpport, const int **lines);
+int hostsindex_match_hashed(const char *pattern, const char *hostname, unsigned short tcpport);
+
+#ifdef __cplusplus
+}
+#endif
@@ -46,6 +46,8 @@ void PKT_init(PTInstVar pvar)
 	pvar->pkt_state.seen_server_ID = FALSE;
 	pvar->pkt_state.seen_newline = FALSE;
 	pvar->pkt_state.predecrypted_packet = FALSE;
+	pvar->pkt_state.recv_bytes = 0;
+	pvar->pkt_state.moved_bytes = 0;
 }
 
 /* Read some data, leave no more than up_to_amount bytes in the buffer,
@@ -53,21 +55,34 @@ void PKT_init(PTInstVar pvar)
 static int recv_data(PTInstVar pvar, unsigned long up_to_amount)
 {
 	int amount_read;
-
-	/* Shuffle data to the start of the buffer */
-	if (pvar->pkt_state.datastart != 0) {
-		memmove(pvar->pkt_state.buf,
-		        pvar->pkt_state.buf + pvar->pkt_state.datastart,
-		        pvar->pkt_state.datalen);
+	char *dest;
+
+	/*
+	 * M̂тɐ擪֋l߂̂߁Aɋ󂫂ȂƂl߂B
+	 * l߂͖̂̃f[^(pPbg̓r܂)ŁAobt@ɂ
+	 * READAMOUNT  3 {̗]TĂ̂ŁAl߂px͒ႢB
+	 * ς݂ payload ͂̃obt@wĂ邪AĂ΂̂
+	 * payload ׂĎoȂ̂ŖȂB
+	 */
+	if (pvar->pkt_state.datalen == 0) {
 		pvar->pkt_state.datastart = 0;
 	}
-
-	buf_ensure_size(&pvar->pkt_state.buf, &pvar->pkt_state.buflen, up_to_amount);
+	if (pvar->pkt_state.datastart + up_to_amount > pvar->pkt_state.buflen) {
+		if (pvar->pkt_state.datastart != 0) {
+			memmove(pvar->pkt_state.buf,
+			        pvar->pkt_state.buf + pvar->pkt_state.datastart,
+			        pvar->pkt_state.datalen);
+			pvar->pkt_state.datastart = 0;
+			pvar->pkt_state.moved_bytes += pvar->pkt_state.datalen;
+		}
+		buf_ensure_size(&pvar->pkt_state.buf, &pvar->pkt_state.buflen, up_to_amount + READAMOUNT * 3);
+	}
 
 	_ASSERT(pvar->pkt_state.buf != NULL);
 
+	dest = pvar->pkt_state.buf + pvar->pkt_state.datastart + pvar->pkt_state.datalen;
 	amount_read = (pvar->Precv) (pvar->socket,
-	                             pvar->pkt_state.buf + pvar->pkt_state.datalen,
+	                             dest,
 	                             up_to_amount - pvar->pkt_state.datalen,
 	                             0);
 
@@ -77,12 +92,13 @@ static int recv_data(PTInstVar pvar, unsigned long up_to_amount)
 			int i;
 
 			for (i = 0; i < amount_read; i++) {
-				if (pvar->pkt_state.buf[pvar->pkt_state.datalen + i] == '\n') {
+				if (dest[i] == '\n') {
 					pvar->pkt_state.seen_newline = 1;
 				}
 			}
 		}
 		pvar->pkt_state.datalen += amount_read;
+		pvar->pkt_state.recv_bytes += amount_read;
 	}
 
 	return amount_read;
@@ -150,16 +166,17 @@ int PKT_recv(PTInstVar pvar, char *buf, int buflen)
 			 * We're looking for the initial ID string and either we've seen the
 			 * terminating newline, or we've exceeded the limit at which we should see a newline.
 			 */
+			char *id = pvar->pkt_state.buf + pvar->pkt_state.datastart;
 			unsigned int i;
 
-			for (i = 0; pvar->pkt_state.buf[i] != '\n' && i < pvar->pkt_state.datalen; i++) {
+			for (i = 0; id[i] != '\n' && i < pvar->pkt_state.datalen; i++) {
 			}
-			if (pvar->pkt_state.buf[i] == '\n') {
+			if (id[i] == '\n') {
 				i++;
 			}
 
 			// SSHT[õo[W`FbNs
-			if (SSH_handle_server_ID(pvar, pvar->pkt_state.buf, i)) {
+			if (SSH_handle_server_ID(pvar, id, i)) {
 				pvar->pkt_state.seen_server_ID = 1;
 
 				if (SSHv2(pvar)) {
@@ -345,5 +362,10 @@ int PKT_recv(PTInstVar pvar, char *buf, int buflen)
 
 void PKT_end(PTInstVar pvar)
 {
+	if (pvar->pkt_state.recv_bytes > 0) {
+		logprintf(LOG_LEVEL_VERBOSE, "%s: received %llu bytes, moved %llu bytes (%.4f copies/byte)",
+		          __FUNCTION__, pvar->pkt_state.recv_bytes, pvar->pkt_state.moved_bytes,
+		          (double)pvar->pkt_state.moved_bytes / pvar->pkt_state.recv_bytes);
+	}
 	buf_destroy(&pvar->pkt_state.buf, &pvar->pkt_state.buflen);
 }
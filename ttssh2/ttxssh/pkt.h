@@ -47,6 +47,8 @@ typedef struct {
   BOOL seen_server_ID;
   BOOL seen_newline;
   BOOL predecrypted_packet;
+  unsigned long long recv_bytes;	// MoCg
+  unsigned long long moved_bytes;	// obt@ŋlߒoCg
 } PKTState;
 
 void PKT_init(PTInstVar pvar);
@@ -62,6 +62,7 @@
 
 
 #include "ssh.h"
+#include "channel.h"
 #include "crypt.h"
 #include "fwd.h"
 #include "sftp.h"
@@ -89,9 +90,6 @@
 // SSH2 data structure
 //
 
-// channel data structure
-#define CHANNEL_MAX 100
-
 //
 // msg  NULL ł͖̕ۏ؁BNULL ̏ꍇ "(null)" ԂB
 //
@@ -105,8 +103,6 @@ typedef enum {
 
 static struct global_confirm global_confirms;
 
-static Channel_t channels[CHANNEL_MAX];
-
 static char ssh_ttymodes[] = "\x01\x03\x02\x1c\x03\x08\x04\x15\x05\x04";
 
 static CRITICAL_SECTION g_ssh_scp_lock;   /* SCPMpbN */
@@ -200,29 +196,19 @@ static int client_global_request_reply(PTInstVar pvar, int type, unsigned int se
 //
 // channel function
 //
+
 static Channel_t *ssh2_channel_new(unsigned int window, unsigned int maxpack,
                                    enum channel_type type, int local_num)
 {
-	int i, found;
 	Channel_t *c;
 	logprintf(LOG_LEVEL_VERBOSE, "%s: local_num %d", __FUNCTION__, local_num);
 
-	found = -1;
-	for (i = 0 ; i < CHANNEL_MAX ; i++) {
-		if (channels[i].used == 0) { // free channel
-			found = i;
-			break;
-		}
-	}
-	if (found == -1) { // not free channel
+	c = ssh2_channel_alloc(type, local_num);
+	if (c == NULL) { // not free channel
 		return (NULL);
 	}
 
 	// setup
-	c = &channels[found];
-	memset(c, 0, sizeof(Channel_t));
-	c->used = 1;
-	c->self_id = i;
 	c->remote_id = SSH_CHANNEL_INVALID;
 	c->local_window = window;
 	c->local_window_max = window;
@@ -230,11 +216,14 @@ static Channel_t *ssh2_channel_new(unsigned int window, unsigned int maxpack,
 	c->local_maxpacket = maxpack;
 	c->remote_window = 0;
 	c->remote_maxpacket = 0;
-	c->type = type;
-	c->local_num = local_num;  // alloc_channel()̕ԒlۑĂ
-	c->bufchain = NULL;
-	c->bufchain_amount = 0;
+	bytequeue_init(&c->bufchain);
 	c->bufchain_recv_suspended = FALSE;
+	c->local_granted = window;
+	c->rtt = 0;
+	c->rtt_tick = GetTickCount();  // SSH2_MSG_CHANNEL_OPEN_CONFIRMATION ܂ł̎Ԃ𑪂
+	c->rtt_measuring = FALSE;
+	c->rate_tick = c->rtt_tick;
+	c->rate_bytes = 0;
 	if (type == TYPE_SCP) {
 		c->scp.state = SCP_INIT;
 		c->scp.progress_window = NULL;
@@ -253,93 +242,20 @@ static Channel_t *ssh2_channel_new(unsigned int window, unsigned int maxpack,
 	return (c);
 }
 
-// remote_window̋󂫂ȂꍇɁAȂobt@Xgi͏jւȂłB
-// Ŋmۂ ssh2_channel_retry_send_bufchain() ŉB
-static void ssh2_channel_add_bufchain(PTInstVar pvar, Channel_t *c, unsigned char *buf, unsigned int buflen)
-{
-	bufchain_t *p, *old;
-
-	// allocate new buffer
-	p = malloc(sizeof(bufchain_t));
-	if (p == NULL)
-		return;
-	p->msg = buffer_init();
-	if (p == NULL) {
-		free(p);
-		return;
-	}
-	buffer_put_raw(p->msg, buf, buflen);
-	p->next = NULL;
-
-	if (c->bufchain == NULL) {
-		c->bufchain = p;
-	} else {
-		old = c->bufchain;
-		while (old->next)
-			old = old->next;
-		old->next = p;
-	}
-
-	// obt@TCY̍vXV(L^p)
-	c->bufchain_amount += buflen;
-
-	// remote_window̋󂫂Ȃ̂ŁAlocal connectioñpPbgM
-	// ~woBɒʒm~܂킯ł͂ȂB
-	FWD_suspend_resume_local_connection(pvar, c, FALSE);
-}
-
-// remote_window̋󂫂łAXgɎcĂf[^ԂɑB
-// Mł烁B
-static void ssh2_channel_retry_send_bufchain(PTInstVar pvar, Channel_t *c)
-{
-	bufchain_t *ch;
-	unsigned int size;
-	bufchain_t* ch_origin = c->bufchain;
-
-	while (c->bufchain) {
-		// 擪ɑ
-		ch = c->bufchain;
-		size = buffer_len(ch->msg);
-		if (size >= c->remote_window)
-			break;
-
-		if (c->local_num == -1) { // shell or SCP
-			SSH2_send_channel_data(pvar, c, buffer_ptr(ch->msg), size, TRUE);
-		} else { // port-forwarding
-			SSH_channel_send(pvar, c->local_num, -1, buffer_ptr(ch->msg), size, TRUE);
-		}
-
-		c->bufchain = ch->next;
-
-		buffer_free(ch->msg);
-		free(ch);
-
-		// obt@TCY̍vXV(L^p)
-		c->bufchain_amount -= size;
-	}
-
-	// XXgɂȂA
-	// local connectioñpPbgʒmĊJB
-	if (ch_origin && c->bufchain == NULL) {
-		FWD_suspend_resume_local_connection(pvar, c, TRUE);
-	}
-}
-
 // channel closeɃ`l\̂Xg֕ԋp
 // (2007.4.26 yutaka)
 static void ssh2_channel_delete(Channel_t *c)
 {
-	bufchain_t *ch, *ptr;
 	enum scp_state prev_state;
+	int id = c->self_id;
 
-	ch = c->bufchain;
-	while (ch) {
-		if (ch->msg)
-			buffer_free(ch->msg);
-		ptr = ch;
-		ch = ch->next;
-		free(ptr);
+	if (c->bufchain.total > 0) {
+		logprintf(LOG_LEVEL_VERBOSE, "%s: channel %d send queue: total %llu bytes, peak %lu bytes, "
+		          "%lu chunks allocated, %lu bytes left",
+		          __FUNCTION__, id, c->bufchain.total, (unsigned long)c->bufchain.peak,
+		          c->bufchain.allocs, (unsigned long)bytequeue_len(&c->bufchain));
 	}
+	bytequeue_free(&c->bufchain);
 
 	if (c->type == TYPE_SCP) {
 		// SCP̍Ō̏ԂۑB
@@ -385,8 +301,7 @@ static void ssh2_channel_delete(Channel_t *c)
 		buffer_free(c->agent_msg);
 	}
 
-	memset(c, 0, sizeof(Channel_t));
-	c->used = 0;
+	ssh2_channel_release(c);
 }
 
 // connection closeɌĂ΂
@@ -395,44 +310,11 @@ void ssh2_channel_free(void)
 	int i;
 	Channel_t *c;
 
-	for (i = 0 ; i < CHANNEL_MAX ; i++) {
-		c = &channels[i];
+	for (i = 0 ; (c = ssh2_channel_slot(i)) != NULL ; i++) {
 		ssh2_channel_delete(c);
 	}
-}
 
-static Channel_t *ssh2_channel_lookup(int id)
-{
-	Channel_t *c;
-
-	if (id < 0 || id >= CHANNEL_MAX) {
-		logprintf(LOG_LEVEL_VERBOSE, "%s: invalid channel id. (%d)", __FUNCTION__, id);
-		return (NULL);
-	}
-	c = &channels[id];
-	if (c->used == 0) { // already freed
-		logprintf(LOG_LEVEL_VERBOSE, "%s: channel was already freed. id:%d", __FUNCTION__, id);
-		return (NULL);
-	}
-	return (c);
-}
-
-// SSH1ŊǗĂchannel\̂ASSH2Channel_t֕ϊB
-// TODO: Iɂ̓`l\̂1ɓB
-// (2005.6.12 yutaka)
-Channel_t *ssh2_local_channel_lookup(int local_num)
-{
-	int i;
-	Channel_t *c;
-
-	for (i = 0 ; i < CHANNEL_MAX ; i++) {
-		c = &channels[i];
-		if (c->type != TYPE_PORTFWD)
-			continue;
-		if (c->local_num == local_num)
-			return (c);
-	}
-	return (NULL);
+	ssh2_channel_table_free();
 }
 
 //
@@ -3474,6 +3356,23 @@ void SSH_get_mac_info(PTInstVar pvar, char *dest, int len)
 	            get_ssh2_mac_name(pvar->macs[MODE_IN]));
 }
 
+// VF`l̎MEBhE RTT
+void SSH_get_window_info(PTInstVar pvar, char *dest, int len)
+{
+	Channel_t *c = ssh2_channel_lookup(pvar->shell_id);
+
+	if (c == NULL) {
+		strncpy_s(dest, len, "-", _TRUNCATE);
+		return;
+	}
+	UTIL_get_lang_msgU8("DLG_ABOUT_WINDOW_INFO", pvar,
+	                    "%u KB (max %u KB), RTT %u ms");
+	_snprintf_s(dest, len, _TRUNCATE, pvar->UIMsg,
+	            c->local_window_max / 1024,
+	            max(c->local_window_max, (unsigned int)pvar->settings.MaxWindowSize) / 1024,
+	            c->rtt);
+}
+
 void SSH_end(PTInstVar pvar)
 {
 	int i;
@@ -3595,66 +3494,7 @@ void SSH_end(PTInstVar pvar)
 				free(pvar->ssh2_keys[mode].mac.key);
 				pvar->ssh2_keys[mode].mac.key = NULL;
 			}
-		}
-	}
-}
-
-void SSH2_send_channel_data(PTInstVar pvar, Channel_t *c, unsigned char *buf, unsigned int buflen, int retry)
-{
-	buffer_t *msg;
-	unsigned char *outmsg;
-	unsigned int len;
-
-	// SSH2̏ꍇ́ApPbg𑗂Ȃ̂łۑĂ
-	if (pvar->kex_status & KEX_FLAG_REKEYING) {
-		ssh2_channel_add_bufchain(pvar, c, buf, buflen);
-		return;
-	}
-
-	if (c == NULL)
-		return;
-
-	// gCł͂ȂAʏ̃pPbgM̍ہAȑOȂf[^
-	// NhXgɎcĂ悤ł΁AXg̖ɌqB
-	// ɂpPbgꂽ悤Ɍ錻ۂPB
-	// (2012.10.14 yutaka)
-	if (retry == 0 && c->bufchain) {
-		ssh2_channel_add_bufchain(pvar, c, buf, buflen);
-		return;
-	}
-
-	if ((unsigned int)buflen > c->remote_window) {
-		unsigned int offset = 0;
-		// Ȃf[^͂ۑĂ
-		ssh2_channel_add_bufchain(pvar, c, buf + offset, buflen - offset);
-		buflen = offset;
-		return;
-	}
-	if (buflen > 0) {
-		msg = buffer_init();
-		if (msg == NULL) {
-			logprintf(LOG_LEVEL_ERROR, "%s: buffer_init returns NULL.", __FUNCTION__);
-			return;
-		}
-		buffer_put_int(msg, c->remote_id);
-		buffer_put_string(msg, (char *)buf, buflen);
-
-		len = buffer_len(msg);
-		outmsg = begin_send_packet(pvar, SSH2_MSG_CHANNEL_DATA, len);
-		//if (len + 12 >= pvar->ssh_state.outbuflen) *(int *)0 = 0;
-		memcpy(outmsg, buffer_ptr(msg), len);
-		finish_send_packet(pvar);
-		buffer_free(msg);
-
-		logprintf(LOG_LEVEL_SSHDUMP, "%s: sending SSH2_MSG_CHANNEL_DATA. "
-				  "local:%d remote:%d len:%d", __FUNCTION__, c->self_id, c->remote_id, buflen);
-
-		// remote window size̒
-		if (buflen <= c->remote_window) {
-			c->remote_window -= buflen;
-		}
-		else {
-			c->remote_window = 0;
+			CRYPT_free_MAC(&pvar->ssh2_keys[mode].mac);
 		}
 	}
 }
@@ -5571,8 +5411,12 @@ static void ssh2_set_newkeys(PTInstVar pvar, int mode)
 	if (pvar->ssh2_keys[mode].mac.key != NULL) {
 		free(pvar->ssh2_keys[mode].mac.key);
 	}
+	CRYPT_free_MAC(&pvar->ssh2_keys[mode].mac);
 
 	pvar->ssh2_keys[mode] = current_keys[mode];
+
+	// MAC ̌͂ňxݒ肵ApPbgƂɂ͎g
+	CRYPT_init_MAC(&pvar->ssh2_keys[mode].mac);
 }
 
 static BOOL ssh2_kex_finish(PTInstVar pvar, char *hash, int hashlen, BIGNUM *share_key, Key *hostkey, char *signature, int siglen)
@@ -6224,11 +6068,22 @@ static BOOL handle_SSH2_dh_common_reply(PTInstVar pvar)
 
 static void do_SSH2_dispatch_setup_for_transfer(PTInstVar pvar)
 {
+	int i;
+	Channel_t *c;
+
 	pvar->kex_status = KEX_FLAG_KEXDONE;
 
 	SSH2_dispatch_init(pvar, 6);
 	SSH2_dispatch_add_range_message(SSH2_MSG_GLOBAL_REQUEST, SSH2_MSG_CHANNEL_FAILURE);
 	SSH2_dispatch_add_message(SSH2_MSG_KEXINIT);
+
+	// ɑ炸obt@ɕۑĂf[^𑗂
+	// SSH2_MSG_NEWKEYS ̑Mǂ炪ɂȂĂAőo
+	for (i = 0 ; (c = ssh2_channel_slot(i)) != NULL ; i++) {
+		if (c->used) {
+			ssh2_channel_retry_send_bufchain(pvar, c);
+		}
+	}
 }
 
 
@@ -6266,18 +6121,7 @@ static BOOL handle_SSH2_newkeys(PTInstVar pvar)
 	// SSH2_MSG_NEWKEYS ɑĂKEX͊B̏ɈڂB
 	if (pvar->kex_status & KEX_FLAG_NEWKEYS_SENT) {
 		if (pvar->kex_status & KEX_FLAG_REKEYING) {
-			int i;
-			Channel_t *c;
-
 			do_SSH2_dispatch_setup_for_transfer(pvar);
-
-			// 炸obt@ɕۑĂf[^𑗂
-			for (i = 0 ; i < CHANNEL_MAX ; i++) {
-				c = &channels[i];
-				if (c->used) {
-					ssh2_channel_retry_send_bufchain(pvar, c);
-				}
-			}
 		}
 		else {
 			//  SSH2_MSG_NEWKEYS ̑MAȍ~̒ʐM͈ÍꂽԂɂȂ
@@ -7752,6 +7596,10 @@ static BOOL handle_SSH2_open_confirm(PTInstVar pvar)
 		pvar->session_nego_status = 1;
 	}
 
+	// SSH2_MSG_CHANNEL_OPEN 𑗂Ă̎Ԃŏ RTT Ƃ
+	// port-forwarding ł̓T[o̐ڑԂ܂ނ̂ŁAMEBhE̒ŏȂ
+	c->rtt = max(GetTickCount() - c->rtt_tick, 1);
+
 	// remote window size
 	c->remote_window = get_uint32_MSBfirst(data);
 	data += 4;
@@ -8084,44 +7932,6 @@ static BOOL handle_SSH2_channel_failure(PTInstVar pvar)
 
 
 
-// NCAgwindow sizeT[o֒m点
-static void do_SSH2_adjust_window_size(PTInstVar pvar, Channel_t *c)
-{
-	// window size32KB֕ύXAlocal window̔ʂCB
-	// ɂSSH2̃X[vbgシB(2006.3.6 yutaka)
-	buffer_t *msg;
-	unsigned char *outmsg;
-	int len;
-
-	// [Jwindow sizeɂ܂]TȂAȂB
-	// added /2 (2006.3.6 yutaka)
-	if (c->local_window > c->local_window_max/2)
-		return;
-
-	{
-		// pty open
-		msg = buffer_init();
-		if (msg == NULL) {
-			logprintf(LOG_LEVEL_ERROR, "%s: buffer_init returns NULL.", __FUNCTION__);
-			return;
-		}
-		buffer_put_int(msg, c->remote_id);
-		buffer_put_int(msg, c->local_window_max - c->local_window);
-
-		len = buffer_len(msg);
-		outmsg = begin_send_packet(pvar, SSH2_MSG_CHANNEL_WINDOW_ADJUST, len);
-		memcpy(outmsg, buffer_ptr(msg), len);
-		finish_send_packet(pvar);
-		buffer_free(msg);
-
-		logputs(LOG_LEVEL_SSHDUMP, "SSH2_MSG_CHANNEL_WINDOW_ADJUST was sent at do_SSH2_adjust_window_size().");
-		// NCAgwindow size𑝂₷
-		c->local_window = c->local_window_max;
-	}
-
-}
-
-
 void ssh2_channel_send_close(PTInstVar pvar, Channel_t *c)
 {
 	if (SSHv2(pvar)) {
@@ -39,6 +39,7 @@ See LICENSE.TXT for the license.
 #include <openssl/evp.h>
 
 #include "buffer.h"
+#include "bytequeue.h"
 #include "config.h"
 #include "cipher.h"
 #include "hostkey.h"
@@ -309,6 +310,7 @@ struct Mac {
 	u_char          *key;
 	unsigned int    key_len;
 	int             etm;
+	HMAC_CTX        *ctx;	// ݒς݂̃ReLXg (NEWKEYS ɍ쐬)
 };
 
 struct Comp {
@@ -459,6 +461,7 @@ void SSH_get_server_ID_info(PTInstVar pvar, char *dest, int len);
 void SSH_get_protocol_version_info(PTInstVar pvar, char *dest, int len);
 void SSH_get_compression_info(PTInstVar pvar, char *dest, int len);
 void SSH_get_mac_info(PTInstVar pvar, char *dest, int len);
+void SSH_get_window_info(PTInstVar pvar, char *dest, int len);
 
 /* len must be <= SSH_MAX_SEND_PACKET_SIZE */
 void SSH_channel_send(PTInstVar pvar, int channel_num,
@@ -516,11 +519,6 @@ enum scp_state {
 	SCP_INIT, SCP_TIMESTAMP, SCP_FILEINFO, SCP_DATA, SCP_CLOSING,
 };
 
-typedef struct bufchain {
-	buffer_t *msg;
-	struct bufchain *next;
-} bufchain_t;
-
 typedef struct PacketList {
 	char *buf;
 	unsigned int buflen;
@@ -590,9 +588,16 @@ typedef struct channel {
 	unsigned int remote_maxpacket;
 	enum channel_type type;
 	int local_num;
-	bufchain_t *bufchain;
-	unsigned long bufchain_amount;
+	bytequeue_t bufchain;           // remote_window 肸Ȃf[^
 	BOOL bufchain_recv_suspended;
+	// MEBhE̎ (do_SSH2_adjust_window_size())
+	unsigned long long local_granted;  // T[o֒ʒmEBhE̍v
+	DWORD rtt;                         // (ms)̍ŏl, 0 ͖v
+	DWORD rtt_tick;                    // RTT ̌vn߂
+	BOOL rtt_measuring;
+	unsigned long long rtt_mark;       // Mʂ𒴂 RTT ܂
+	DWORD rate_tick;                   // Mʂ̌vn߂
+	unsigned long long rate_bytes;     // rate_tick ̎_̎M
 	scp_t scp;
 	buffer_t *agent_msg;
 	int agent_request_len;
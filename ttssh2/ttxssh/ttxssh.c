@@ -371,6 +371,18 @@ static void read_ssh_options(PTInstVar pvar, const wchar_t *fileName)
 	// SSH heartbeat time(second) (2004.12.11 yutaka)
 	settings->ssh_heartbeat_overtime = GetPrivateProfileInt("TTSSH", "HeartBeat", 300, fileName);
 
+	// SSH2 `l̎MEBhȄ
+	settings->MaxWindowSize = GetPrivateProfileInt("TTSSH", "MaxWindowSize", 16 * 1024 * 1024, fileName);
+	if (settings->MaxWindowSize < 0 || settings->MaxWindowSize > 1024 * 1024 * 1024) {
+		settings->MaxWindowSize = 1024 * 1024 * 1024;
+	}
+
+	// SSH2 `l̑M҂f[^̏
+	settings->ChannelBufferSize = GetPrivateProfileInt("TTSSH", "ChannelBufferSize", FWD_HIGH_WATER_MARK, fileName);
+	if (settings->ChannelBufferSize <= 0) {
+		settings->ChannelBufferSize = FWD_HIGH_WATER_MARK;
+	}
+
 	// pX[hF؂ьJF؂ɎgpX[hɕێĂǂ
 	// \B(2006.8.5 yutaka)
 	settings->remember_password = GetPrivateProfileInt("TTSSH", "RememberPassword", 1, fileName);
@@ -513,6 +525,16 @@ static void write_ssh_options(PTInstVar pvar, const wchar_t *fileName,
 	            "%d", settings->ssh_heartbeat_overtime);
 	WritePrivateProfileString("TTSSH", "HeartBeat", buf, fileName);
 
+	// SSH2 `l̎MEBhȄ
+	_snprintf_s(buf, sizeof(buf), _TRUNCATE,
+	            "%d", settings->MaxWindowSize);
+	WritePrivateProfileString("TTSSH", "MaxWindowSize", buf, fileName);
+
+	// SSH2 `l̑M҂f[^̏
+	_snprintf_s(buf, sizeof(buf), _TRUNCATE,
+	            "%d", settings->ChannelBufferSize);
+	WritePrivateProfileString("TTSSH", "ChannelBufferSize", buf, fileName);
+
 	// Remember password (2006.8.5 yutaka)
 	WritePrivateProfileString("TTSSH", "RememberPassword",
 	                          settings->remember_password ? "1" : "0",
@@ -2082,6 +2104,13 @@ static void about_dlg_set_abouttext(PTInstVar pvar, HWND dlg, digest_algorithm d
 			AUTH_get_auth_info(pvar, buf, sizeof(buf));
 			strncat_s(buf2, sizeof(buf2), buf, _TRUNCATE);
 			strncat_s(buf2, sizeof(buf2), "\r\n", _TRUNCATE);
+
+			UTIL_get_lang_msgU8("DLG_ABOUT_WINDOW", pvar, "Receive window:");
+			strncat_s(buf2, sizeof(buf2), pvar->UIMsg, _TRUNCATE);
+			strncat_s(buf2, sizeof(buf2), " ", _TRUNCATE);
+			SSH_get_window_info(pvar, buf, sizeof(buf));
+			strncat_s(buf2, sizeof(buf2), buf, _TRUNCATE);
+			strncat_s(buf2, sizeof(buf2), "\r\n", _TRUNCATE);
 		}
 
 		// zXgJfingerprint\B
@@ -5106,6 +5135,7 @@ BOOL WINAPI DllMain(HANDLE hInstance,
 		break;
 	case DLL_PROCESS_DETACH:
 		/* do process cleanup */
+		HOSTS_free_cache();
 		if (__mem_mapping == NULL) {
 			free(pvar->ts_SSH);
 		} else {
@@ -217,6 +217,13 @@ typedef struct _TS_SSH {
 	//   for publickey authentication (not for server hostkey)
 	//   for RSA key only
 	char RSAPubkeySignAlgorithmOrder[RSA_PUBKEY_SIGN_ALGO_MAX+1];
+
+	// SSH2 `l̎MEBhEƂ̏(byte), 0 ͒Ȃ
+	int MaxWindowSize;
+
+	// remote_window 肸Ȃf[^`lƂɗ߂Ă(byte)
+	// 𒴂ƃ|[g]̃[J̎M~߂
+	int ChannelBufferSize;
 } TS_SSH;
 
 typedef struct _TInstVar {